@@ -10,12 +10,34 @@
  * des dés, et calcule les points à chaque tour.
  */
 
+#define _GNU_SOURCE     // accept4
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <time.h>
 #include <ctype.h>
+#include <math.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <signal.h>
+#include <errno.h>
+#include "yams.h"
 
 /** 
  * \def TAILLE_FEUILLE 
@@ -79,6 +101,134 @@
 #define I_YAMS 11
 #define I_CHANCE 12
 
+/**
+ * \def NB_MAINS
+ * \brief Nombre de mains distinctes une fois les dés triés (5 dés parmi 6 faces, avec répétition)
+ */
+/**
+ * \def NB_TIRAGES
+ * \brief Nombre de tirages ordonnés de 5 dés (6 puissance 5)
+ */
+/**
+ * \def BITS_DE
+ * \brief Nombre de bits d'un dé dans un mot de journal : face de 1 à 6, 0 pour un lancer qui n'a pas eu lieu
+ */
+/**
+ * \def NB_PAQUETS
+ * \brief Nombre de valeurs d'un lancer de 5 dés dans un mot de journal
+ */
+/**
+ * \def MAIN_INCORRECTE
+ * \brief Indice de main d'un lancer dont une face n'est pas entre 1 et 6
+ */
+#define NB_MAINS 252
+#define NB_TIRAGES 7776
+#define BITS_DE 3
+#define NB_PAQUETS (1 << (NB_DES * BITS_DE))
+#define MAIN_INCORRECTE 255
+
+/**
+ * \def NB_LANCERS
+ * \brief Nombre maximum de lancers de dés par tour
+ */
+/**
+ * \def GARDER_TOUT
+ * \brief Masque des dés à garder quand tous les dés sont gardés (fin des lancers)
+ */
+/**
+ * \def NB_JOUEURS
+ * \brief Nombre de joueurs d'une partie, sauf choix contraire
+ */
+/**
+ * \def MAX_JOUEURS
+ * \brief Nombre maximum de joueurs autour d'une table
+ */
+#define NB_LANCERS 3
+#define GARDER_TOUT ((1 << NB_DES) - 1)
+#define NB_JOUEURS 2
+#define MAX_JOUEURS 8
+
+/**
+ * \def BONUS
+ * \brief Points du bonus de la partie supérieure
+ */
+/**
+ * \def BORNE_BONUS
+ * \brief Le bonus est accordé quand le total supérieur dépasse cette borne
+ */
+/**
+ * \def POINTS_CASE_MAX
+ * \brief Le plus grand nombre de points d'une case (yams)
+ */
+#define BONUS 35
+#define BORNE_BONUS 62
+#define POINTS_CASE_MAX 50
+
+/**
+ * \def NB_GARDES
+ * \brief Nombre d'ensembles de dés gardés distincts à l'ordre près, de 0 à 5 dés
+ */
+/**
+ * \def NB_TRANSITIONS
+ * \brief Nombre total de couples (dés gardés, main obtenue après relance)
+ */
+/**
+ * \def NB_CODES_COMPTES
+ * \brief Nombre de codes d'un ensemble de dés décrit par le nombre de dés de chaque face (6 puissance 6)
+ */
+/**
+ * \def NB_MASQUES
+ * \brief Nombre d'ensembles de cases remplies d'une feuille de marque
+ */
+/**
+ * \def NB_SOUS_TOTAUX
+ * \brief Nombre de sous-totaux supérieurs distingués par le solveur, de 0 à BORNE_BONUS + 1
+ */
+#define NB_GARDES 462
+#define NB_TRANSITIONS 4368
+#define NB_CODES_COMPTES 46656
+#define NB_MASQUES (1 << TAILLE_FEUILLE)
+#define NB_SOUS_TOTAUX (BORNE_BONUS + 2)
+
+/**
+ * \def FEUILLE_REMPLIE
+ * \brief Masque des cases remplies d'une feuille complète
+ */
+#define FEUILLE_REMPLIE ((1 << TAILLE_FEUILLE) - 1)
+
+/**
+ * \def MAGIE_TABLE
+ * \brief Signature d'un fichier de table optimale
+ */
+/**
+ * \def VERSION_TABLE
+ * \brief Version du format des fichiers de table optimale
+ */
+#define MAGIE_TABLE "YAMSOPT"
+#define VERSION_TABLE 1
+
+/**
+ * \def MAGIE_FINALE
+ * \brief Signature d'un fichier de table de fin de partie
+ */
+/**
+ * \def VERSION_FINALE
+ * \brief Version du format des fichiers de table de fin de partie
+ */
+#define MAGIE_FINALE "YAMSFIN"
+#define VERSION_FINALE 1
+
+/**
+ * \def MAGIE_JOURNAL
+ * \brief Signature d'un journal de parties
+ */
+/**
+ * \def VERSION_JOURNAL
+ * \brief Version du format des journaux de parties
+ */
+#define MAGIE_JOURNAL "YAMSLOG"
+#define VERSION_JOURNAL 1
+
 
 /** 
  * \typedef int t_feuille[TAILLE_FEUILLE]
@@ -101,6 +251,252 @@ typedef int t_des[NB_DES];
 typedef char nom[TAILLE_NOM];
 typedef char combi[TAILLE_COMBI];
 
+/**
+ * \var mains_triees
+ * \brief Les dés de chaque main triée, rangées par ordre croissant
+ */
+/**
+ * \var points_mains
+ * \brief Les points de chaque combinaison pour chaque main triée
+ */
+/**
+ * \var points_max
+ * \brief Les points maximum que peut rapporter chaque case, déduits de points_mains
+ */
+/**
+ * \var indice_tirages
+ * \brief L'indice de la main triée de chaque tirage ordonné, repéré par son code en base 6
+ */
+/**
+ * \var indice_paquets
+ * \brief L'indice de la main triée de chaque lancer d'un mot de journal (BITS_DE bits par dé),
+ * MAIN_INCORRECTE si une face n'est pas entre 1 et 6
+ */
+t_des mains_triees[NB_MAINS];
+unsigned char points_mains[NB_MAINS][TAILLE_FEUILLE];
+unsigned char points_max[TAILLE_FEUILLE];
+unsigned char indice_tirages[NB_TIRAGES];
+unsigned char indice_paquets[NB_PAQUETS];
+
+/**
+ * \var indice_gardes
+ * \brief L'indice de chaque ensemble de dés gardés, repéré par le code du nombre de dés de chaque face
+ */
+/**
+ * \var taille_gardes
+ * \brief Le nombre de dés de chaque ensemble de dés gardés
+ */
+/**
+ * \var debut_taille_gardes
+ * \brief L'indice du premier ensemble de dés gardés de chaque taille, les ensembles étant rangés par taille
+ */
+/**
+ * \var proba_tirages
+ * \brief La probabilité d'obtenir chaque ensemble en lançant autant de dés qu'il en contient
+ */
+/**
+ * \var proba_exacte_tirages
+ * \brief Les mêmes probabilités en double, pour les calculs de lois qui s'additionnent sur toute une partie
+ */
+/**
+ * \var debut_transitions
+ * \brief L'indice de la première transition des ensembles de dés gardés de chaque taille
+ */
+/**
+ * \var cible_transitions
+ * \brief La main obtenue par chaque transition, rangée par issue de la relance puis par ensemble gardé
+ */
+/**
+ * \var gardes_main
+ * \brief Les ensembles de dés gardés distincts possibles depuis chaque main triée
+ */
+/**
+ * \var nb_gardes_main
+ * \brief Le nombre d'ensembles de dés gardés distincts de chaque main triée
+ */
+/**
+ * \var sous_totaux_possibles
+ * \brief Les sous-totaux supérieurs atteignables (bit à 1) pour chaque ensemble de cases supérieures remplies
+ */
+unsigned short indice_gardes[NB_CODES_COMPTES];
+unsigned char taille_gardes[NB_GARDES];
+int debut_taille_gardes[NB_DES + 2];
+float proba_tirages[NB_GARDES];
+double proba_exacte_tirages[NB_GARDES];
+int debut_transitions[NB_DES + 1];
+unsigned char cible_transitions[NB_TRANSITIONS];
+unsigned short gardes_main[NB_MAINS][1 << NB_DES];
+unsigned char nb_gardes_main[NB_MAINS];
+uint64_t sous_totaux_possibles[1 << 6];
+
+/**
+ * \enum t_phase
+ * \brief Phases d'une partie mesurées par l'instrumentation
+ */
+typedef enum {
+    PHASE_LANCER,       /**< Lancer des dés */
+    PHASE_COMBINAISONS, /**< Points d'une main dans une case (points_case, rechercher_combinaisons) */
+    PHASE_TOTAUX,       /**< Inscription des points et totaux (inscrire_table, totaux_table, calculer_totaux) */
+    PHASE_AFFICHAGE,    /**< Affichage d'une feuille de marque, calcul de ses totaux compris */
+    NB_PHASES
+} t_phase;
+
+#ifdef YAMS_INSTRUMENTATION
+/**
+ * \struct t_compteurs
+ * \brief Compteurs d'un fil d'exécution, que lui seul incrémente
+ *
+ * Chaque fil a les siens, sans verrou ni ligne de cache partagée : la
+ * fusion les additionne à la demande. Ils ne sont jamais libérés, pour que
+ * les totaux gardent le travail des fils terminés.
+ */
+typedef struct t_compteurs {
+    uint64_t appels[NB_PHASES];             /**< Nombre de passages dans chaque phase */
+    uint64_t tops[NB_PHASES];               /**< Tops d'horloge passés dans chaque phase */
+    uint64_t remplies[TAILLE_FEUILLE];      /**< Nombre de fois où chaque case est remplie */
+    uint64_t marquees[TAILLE_FEUILLE];      /**< Nombre de fois où elle est remplie avec des points */
+    uint64_t lancers_tour[NB_LANCERS];      /**< Nombre de tours finis après 1, 2 ou 3 lancers */
+    struct t_compteurs *suivant;            /**< Compteurs du fil suivant */
+} t_compteurs;
+
+/**
+ * \var compteurs_fil
+ * \brief Compteurs du fil courant, NULL avant sa première mesure
+ */
+/**
+ * \var liste_compteurs
+ * \brief Compteurs de tous les fils qui ont mesuré quelque chose
+ */
+/**
+ * \var verrou_compteurs
+ * \brief Protège liste_compteurs, pris seulement à la première mesure d'un fil et à la fusion
+ */
+_Thread_local t_compteurs *compteurs_fil = NULL;
+t_compteurs *liste_compteurs = NULL;
+pthread_mutex_t verrou_compteurs = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * \fn uint64_t lire_tops()
+ * \brief Lit le compteur de cycles du processeur, ou une horloge en nanosecondes hors x86
+ * \return Le nombre de tops depuis une origine fixe
+ */
+uint64_t lire_tops() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec instant;
+
+    clock_gettime(CLOCK_MONOTONIC, &instant);
+    return instant.tv_sec * 1000000000ULL + instant.tv_nsec;
+#endif
+}
+
+/**
+ * \fn t_compteurs *compteurs_courants()
+ * \brief Donne les compteurs du fil courant, en les créant à sa première mesure
+ * \return Les compteurs du fil
+ */
+t_compteurs *compteurs_courants() {
+    t_compteurs *compteurs = compteurs_fil;
+
+    if (compteurs == NULL) {
+        compteurs = calloc(1, sizeof(t_compteurs));
+        pthread_mutex_lock(&verrou_compteurs);
+        compteurs->suivant = liste_compteurs;
+        liste_compteurs = compteurs;
+        pthread_mutex_unlock(&verrou_compteurs);
+        compteurs_fil = compteurs;
+    }
+
+    return compteurs;
+}
+
+/**
+ * \fn void incrementer(uint64_t *compteur, uint64_t valeur)
+ * \brief Ajoute une valeur à un compteur du fil courant
+ *
+ * Seul le fil propriétaire écrit : une lecture suivie d'une écriture
+ * atomique suffit (un simple mov en x86), la fusion lisant toujours une
+ * valeur entière.
+ * \param compteur Le compteur
+ * \param valeur La valeur à ajouter
+ */
+void incrementer(uint64_t *compteur, uint64_t valeur) {
+    __atomic_store_n(compteur, *compteur + valeur, __ATOMIC_RELAXED);
+}
+
+/**
+ * \fn void compter_phase(int phase, uint64_t debut)
+ * \brief Compte un passage dans une phase et le temps qu'il a pris
+ * \param phase Un t_phase
+ * \param debut Les tops lus au début de la phase
+ */
+void compter_phase(int phase, uint64_t debut) {
+    t_compteurs *compteurs = compteurs_courants();
+
+    incrementer(&compteurs->appels[phase], 1);
+    incrementer(&compteurs->tops[phase], lire_tops() - debut);
+}
+
+/**
+ * \fn void compter_tour(int indice, int points, int nb_lancers)
+ * \brief Compte la case remplie à la fin d'un tour et les lancers qu'il a pris
+ * \param indice La case remplie
+ * \param points Les points inscrits
+ * \param nb_lancers Le nombre de lancers du tour, de 1 à NB_LANCERS
+ */
+void compter_tour(int indice, int points, int nb_lancers) {
+    t_compteurs *compteurs = compteurs_courants();
+
+    incrementer(&compteurs->remplies[indice], 1);
+    incrementer(&compteurs->marquees[indice], points > 0);
+    incrementer(&compteurs->lancers_tour[nb_lancers - 1], 1);
+}
+
+/**
+ * \fn void fusionner_compteurs(t_compteurs *total)
+ * \brief Additionne les compteurs de tous les fils, pendant qu'ils continuent de compter
+ * \param total La somme des compteurs, sans suivant
+ */
+void fusionner_compteurs(t_compteurs *total) {
+    // les compteurs sont tous des uint64_t rangés avant le suivant
+    const int NB_VALEURS = offsetof(t_compteurs, suivant) / sizeof(uint64_t);
+    uint64_t *somme = (uint64_t *)total;
+    const uint64_t *valeurs;
+
+    memset(total, 0, sizeof(t_compteurs));
+    pthread_mutex_lock(&verrou_compteurs);
+    for (const t_compteurs *compteurs = liste_compteurs; compteurs != NULL; compteurs = compteurs->suivant) {
+        valeurs = (const uint64_t *)compteurs;
+        for (int i = 0; i < NB_VALEURS; i++)
+            somme[i] += __atomic_load_n(&valeurs[i], __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&verrou_compteurs);
+}
+
+/**
+ * \def DEBUT_MESURE()
+ * \brief Lit les tops au début d'une phase, une seule fois par bloc
+ */
+/**
+ * \def FIN_MESURE(phase)
+ * \brief Compte la phase commencée par DEBUT_MESURE dans le même bloc
+ */
+/**
+ * \def COMPTER_TOUR(indice, points, nb_lancers)
+ * \brief Compte la case remplie et les lancers d'un tour
+ *
+ * Sans YAMS_INSTRUMENTATION, ces trois macros ne laissent aucune instruction.
+ */
+#define DEBUT_MESURE() uint64_t debut_mesure = lire_tops()
+#define FIN_MESURE(phase) compter_phase(phase, debut_mesure)
+#define COMPTER_TOUR(indice, points, nb_lancers) compter_tour(indice, points, nb_lancers)
+#else
+#define DEBUT_MESURE()
+#define FIN_MESURE(phase)
+#define COMPTER_TOUR(indice, points, nb_lancers)
+#endif
+
 /**
  * \fn void lire_clavier(char entree[])
  * \brief Lit une entrée au clavier, espaces compris. Retourne une chaine vide si rien est entré
@@ -112,19 +508,6 @@ void lire_clavier(char entree[]) {
     getchar();
 }
 
-/**
- * \fn initialiser_feuilles(t_feuille t1, t_feuille t2)
- * \brief Met toutes les cases des deux feuilles à CASE_VIDE
- * \param t1 La première feuille
- * \param t2 La seconde feuille
- */
-void initialiser_feuilles(t_feuille t1, t_feuille t2) {
-    for (int i = 0; i < TAILLE_FEUILLE; i++) {
-        t1[i] = CASE_VIDE;
-        t2[i] = CASE_VIDE;
-    }
-}
-
 /**
  * \fn nom_est_valide(const char nom_joueur[100])
  * \brief Vérifie qu'un nom de joueur est valide
@@ -167,58 +550,278 @@ void recuperer_nom_joueur(int numero_joueur, nom nom_joueur) {
 }
 
 /**
- * \fn void formater_nom_joueur(const nom nom_joueur, char resultat[])
- * \brief Centre et rajoute les bordures au nom du joueur
- * \param nom_joueur Le nom du joueur à formater
- * \param resultat Le texte une fois formaté
+ * \def LARGEUR_FEUILLE
+ * \brief Nombre de colonnes d'une feuille de marque dessinée
  */
-void formater_nom_joueur(const nom nom_joueur, char resultat[]) {
-    const int TAILLE_COL = TAILLE_NOM + 1;  // taille de la colonne
-    const int MARGE = 1;                    // taille d'une marge
-    const char C_BORD[] = "─";
-    const char C_MARGE[] = " ";
+/**
+ * \def HAUTEUR_FEUILLE
+ * \brief Nombre de lignes d'une feuille de marque dessinée
+ */
+/**
+ * \def LIGNES_ECRAN
+ * \brief Nombre de lignes d'une image, assez pour les feuilles de MAX_JOUEURS joueurs, deux par deux, et les totaux
+ */
+/**
+ * \def COLONNES_ECRAN
+ * \brief Nombre de colonnes d'une image : une feuille de marque, puis la colonne des dés et des questions
+ */
+/**
+ * \def TAILLE_SORTIE_ECRAN
+ * \brief Taille de l'image à envoyer au terminal, au pire 4 octets et un déplacement du curseur par cellule
+ */
+/**
+ * \def ECART_REDESSINE
+ * \brief Nombre de cellules inchangées réécrites entre deux cellules modifiées, moins coûteuses qu'un déplacement du curseur
+ */
+#define LARGEUR_FEUILLE 40
+#define HAUTEUR_FEUILLE 25
+#define LIGNES_ECRAN (MAX_JOUEURS / 2 * (HAUTEUR_FEUILLE + 1) + MAX_JOUEURS + 8)
+#define COLONNES_ECRAN 100
+#define TAILLE_SORTIE_ECRAN (LIGNES_ECRAN * COLONNES_ECRAN * 16 + 64)
+#define ECART_REDESSINE 4
 
-    int taille_total;                       // taille totale à répartir entre les bords
-    int taille_bord_g, taille_bord_d;       // taille du bord gauche et du bord droit
-    size_t taille_joueur;                   // taille du nom du joueur
-    int i;
+/**
+ * \typedef uint32_t t_cellule
+ * \brief Un caractère UTF-8 d'une case de l'écran, ses octets rangés dans l'ordre et complétés par des 0
+ */
+typedef uint32_t t_cellule;
+
+/**
+ * \struct t_ecran
+ * \brief Image de l'écran composée en mémoire, puis envoyée au terminal en une seule écriture
+ *
+ * L'image est une grille de cellules, une par colonne du terminal : un
+ * caractère accentué ou un trait de bordure occupe une seule cellule, quel
+ * que soit son nombre d'octets. Le terminal ne reçoit que les cellules qui
+ * diffèrent de l'image précédente.
+ */
+typedef struct {
+    t_cellule cellules[LIGNES_ECRAN][COLONNES_ECRAN];   /**< Image en cours de composition */
+    t_cellule affichees[LIGNES_ECRAN][COLONNES_ECRAN];  /**< Image que montre le terminal */
+    int nb_lignes;                                      /**< Nombre de lignes utilisées de l'image en cours */
+    int ligne_curseur;                                  /**< Ligne où s'arrête le dernier texte écrit, là où le joueur répond */
+    int colonne_curseur;                                /**< Colonne où s'arrête le dernier texte écrit */
+    int ligne_reponse;                                  /**< Ligne du curseur de l'image affichée, où le joueur a tapé sa réponse */
+    int colonne_reponse;                                /**< Colonne du curseur de l'image affichée */
+    int descripteur;                                    /**< Sortie de l'écran */
+    bool terminal;                                      /**< Vrai si la sortie est un terminal assez grand pour être redessiné sur place */
+    bool premiere;                                      /**< Vrai tant que le terminal n'a reçu aucune image */
+    size_t taille;                                      /**< Nombre d'octets de sortie en attente */
+    char sortie[TAILLE_SORTIE_ECRAN];                   /**< Octets envoyés au terminal */
+} t_ecran;
+
+/**
+ * \fn void effacer_ecran(t_ecran *ecran)
+ * \brief Commence une nouvelle image, vide
+ * \param ecran L'écran
+ */
+void effacer_ecran(t_ecran *ecran) {
+    for (int l = 0; l < LIGNES_ECRAN; l++) {
+        for (int c = 0; c < COLONNES_ECRAN; c++)
+            ecran->cellules[l][c] = ' ';
+    }
+    ecran->nb_lignes = 0;
+    ecran->ligne_curseur = 0;
+    ecran->colonne_curseur = 0;
+}
+
+/**
+ * \fn void initialiser_ecran(t_ecran *ecran, int descripteur)
+ * \brief Prépare un écran vide sur une sortie
+ *
+ * Hors d'un terminal, ou dans un terminal trop petit pour une feuille et
+ * la colonne des questions, chaque image est écrite à la suite de la
+ * précédente, ligne par ligne.
+ * \param ecran L'écran
+ * \param descripteur La sortie de l'écran
+ */
+void initialiser_ecran(t_ecran *ecran, int descripteur) {
+    struct winsize dimensions;
+
+    effacer_ecran(ecran);
+    memcpy(ecran->affichees, ecran->cellules, sizeof(ecran->affichees));
+    ecran->descripteur = descripteur;
+    ecran->terminal = isatty(descripteur) && ioctl(descripteur, TIOCGWINSZ, &dimensions) == 0
+        && dimensions.ws_col >= COLONNES_ECRAN && dimensions.ws_row > HAUTEUR_FEUILLE;
+    ecran->premiere = true;
+    ecran->taille = 0;
+}
+
+/**
+ * \fn int ecrire_ecran(t_ecran *ecran, int ligne, int colonne, const char format[], ...)
+ * \brief Ecrit un texte formaté dans l'image, une cellule par caractère
+ *
+ * Un retour à la ligne reprend à la colonne de départ, et ce qui dépasse
+ * de l'image est ignoré. Le curseur est placé à la fin du texte.
+ * \param ecran L'écran
+ * \param ligne La ligne du premier caractère
+ * \param colonne La colonne du premier caractère
+ * \param format Le format, comme pour printf
+ * \return La ligne où s'arrête le texte
+ */
+int ecrire_ecran(t_ecran *ecran, int ligne, int colonne, const char format[], ...) {
+    char texte[2048];   // une invite complète, les caractères faisant jusqu'à 4 octets
+    const unsigned char *caractere = (const unsigned char *)texte;
+    int c = colonne, nb_octets;
+    t_cellule cellule;
+    va_list arguments;
+
+    va_start(arguments, format);
+    vsnprintf(texte, sizeof(texte), format, arguments);
+    va_end(arguments);
 
-    taille_joueur = strlen(nom_joueur);
+    while (*caractere != '\0') {
+        if (*caractere == '\n') {
+            ligne++;
+            c = colonne;
+            caractere++;
+            continue;
+        }
 
-    // les bords remplissent l'espace qui n'est pris
-    // ni par les 2 marges ni par le nom du joueur
-    taille_total = TAILLE_COL - taille_joueur - 2*MARGE;
-    // le bord gauche est plus long d'un caractère si 
-    // texte ne peut être centré correctement
-    taille_bord_d = taille_total / 2;
-    taille_bord_g = taille_bord_d + (taille_total % 2);
+        // le premier octet d'un caractère UTF-8 donne son nombre d'octets
+        nb_octets = *caractere < 0x80 ? 1 : *caractere < 0xE0 ? 2 : *caractere < 0xF0 ? 3 : 4;
+        cellule = 0;
+        for (int i = 0; i < nb_octets && caractere[i] != '\0'; i++)
+            cellule |= (t_cellule)caractere[i] << (8 * i);
+        caractere += nb_octets;
 
-    strcpy(resultat, "");
-    // on insère le bord gauche
-    for (i = 0; i < taille_bord_g; i++) {
-        strcat(resultat, C_BORD);
+        if (ligne < LIGNES_ECRAN && c < COLONNES_ECRAN) {
+            ecran->cellules[ligne][c] = cellule;
+            if (ligne >= ecran->nb_lignes)
+                ecran->nb_lignes = ligne + 1;
+        }
+        c++;
     }
-    // puis le nom avec ses marges
-    strcat(resultat, C_MARGE);
-    strcat(resultat, nom_joueur);
-    strcat(resultat, C_MARGE);
-    // puis le bord droit
-    for (i = 0; i < taille_bord_d; i++) {
-        strcat(resultat, C_BORD);
+
+    ecran->ligne_curseur = ligne < LIGNES_ECRAN ? ligne : LIGNES_ECRAN - 1;
+    ecran->colonne_curseur = c < COLONNES_ECRAN ? c : COLONNES_ECRAN - 1;
+    return ligne;
+}
+
+/**
+ * \fn void remplir_ecran(t_ecran *ecran, int ligne, int colonne, const char caractere[], int nb)
+ * \brief Répète un caractère sur une ligne de l'image
+ * \param ecran L'écran
+ * \param ligne La ligne
+ * \param colonne La colonne de la première répétition
+ * \param caractere Le caractère UTF-8
+ * \param nb Le nombre de répétitions
+ */
+void remplir_ecran(t_ecran *ecran, int ligne, int colonne, const char caractere[], int nb) {
+    for (int i = 0; i < nb; i++)
+        ecrire_ecran(ecran, ligne, colonne + i, "%s", caractere);
+}
+
+/**
+ * \fn void ajouter_sortie(t_ecran *ecran, const char format[], ...)
+ * \brief Ajoute des octets formatés à la sortie en attente
+ * \param ecran L'écran
+ * \param format Le format, comme pour printf
+ */
+void ajouter_sortie(t_ecran *ecran, const char format[], ...) {
+    va_list arguments;
+
+    va_start(arguments, format);
+    ecran->taille += vsnprintf(ecran->sortie + ecran->taille, TAILLE_SORTIE_ECRAN - ecran->taille, format, arguments);
+    va_end(arguments);
+}
+
+/**
+ * \fn void ajouter_cellules(t_ecran *ecran, const t_cellule cellules[], int nb)
+ * \brief Ajoute les octets de cellules consécutives à la sortie en attente
+ * \param ecran L'écran
+ * \param cellules Les cellules
+ * \param nb Le nombre de cellules
+ */
+void ajouter_cellules(t_ecran *ecran, const t_cellule cellules[], int nb) {
+    for (int i = 0; i < nb; i++) {
+        for (t_cellule reste = cellules[i]; reste != 0; reste >>= 8)
+            ecran->sortie[ecran->taille++] = reste & 0xFF;
     }
 }
 
 /**
- * \fn void formater_valeur(int valeur, char resultat[]) 
- * \brief Transforme une valeur chiffrée d'une case du tableau en texte
- * \param valeur La valeur chiffrée
- * \param resultat Le texte retourné 
+ * \fn bool rendre_ecran(t_ecran *ecran, bool derniere)
+ * \brief Envoie l'image composée au terminal, en une seule écriture
+ *
+ * Dans un terminal, seules les suites de cellules modifiées depuis l'image
+ * précédente sont redessinées, après avoir effacé la réponse tapée à la
+ * place du curseur précédent, puis le curseur revient à la fin du dernier
+ * texte. Sinon, et pour la dernière image,
+ * qui peut dépasser la hauteur du terminal, l'image entière est écrite ligne
+ * par ligne à la suite.
+ * \param ecran L'écran
+ * \param derniere Vrai pour la dernière image, qui n'attend plus de réponse
+ * \return Vrai si l'image est écrite, faux sinon
  */
-void formater_valeur(int valeur, char resultat[]) {
-    strcpy(resultat, "   ");
-    if (valeur != CASE_VIDE) {
-        sprintf(resultat, "%3d", valeur);
+bool rendre_ecran(t_ecran *ecran, bool derniere) {
+    ssize_t ecrits;
+    size_t envoyes = 0;
+    int longueur, fin;
+
+    // les textes de printf encore en attente passent avant l'image
+    fflush(stdout);
+    ecran->taille = 0;
+
+    if (ecran->terminal && (ecran->premiere || derniere))
+        ajouter_sortie(ecran, "\x1b[H\x1b[2J");
+
+    if (ecran->terminal && !derniere) {
+        ajouter_sortie(ecran, "\x1b[?25l");
+
+        // la réponse tapée n'est pas dans l'image : effacée, sa ligne est redessinée
+        if (!ecran->premiere) {
+            ajouter_sortie(ecran, "\x1b[%d;%dH\x1b[K", ecran->ligne_reponse + 1, ecran->colonne_reponse + 1);
+            for (int c = ecran->colonne_reponse; c < COLONNES_ECRAN; c++)
+                ecran->affichees[ecran->ligne_reponse][c] = ' ';
+        }
+
+        for (int l = 0; l < LIGNES_ECRAN; l++) {
+            for (int c = 0; c < COLONNES_ECRAN; c++) {
+                if (ecran->cellules[l][c] == ecran->affichees[l][c])
+                    continue;
+
+                // une suite se prolonge tant qu'une autre modification est proche
+                fin = c + 1;
+                for (int k = fin; k < COLONNES_ECRAN && k < fin + ECART_REDESSINE; k++) {
+                    if (ecran->cellules[l][k] != ecran->affichees[l][k])
+                        fin = k + 1;
+                }
+
+                ajouter_sortie(ecran, "\x1b[%d;%dH", l + 1, c + 1);
+                ajouter_cellules(ecran, &ecran->cellules[l][c], fin - c);
+                c = fin - 1;
+            }
+        }
+        ajouter_sortie(ecran, "\x1b[%d;%dH\x1b[?25h", ecran->ligne_curseur + 1, ecran->colonne_curseur + 1);
+        memcpy(ecran->affichees, ecran->cellules, sizeof(ecran->affichees));
+        ecran->ligne_reponse = ecran->ligne_curseur;
+        ecran->colonne_reponse = ecran->colonne_curseur;
+    }
+    else {
+        for (int l = 0; l < ecran->nb_lignes; l++) {
+            // l'invite garde ses espaces jusqu'au curseur
+            longueur = COLONNES_ECRAN;
+            while (longueur > 0 && ecran->cellules[l][longueur - 1] == ' ')
+                longueur--;
+            if (l == ecran->ligne_curseur && longueur < ecran->colonne_curseur)
+                longueur = ecran->colonne_curseur;
+            ajouter_cellules(ecran, ecran->cellules[l], longueur);
+            ajouter_sortie(ecran, "\n");
+        }
     }
+    ecran->premiere = false;
+
+    while (envoyes < ecran->taille) {
+        ecrits = write(ecran->descripteur, ecran->sortie + envoyes, ecran->taille - envoyes);
+        if (ecrits < 0 && errno == EINTR)
+            continue;
+        if (ecrits <= 0)
+            return false;
+        envoyes += ecrits;
+    }
+
+    return true;
 }
 
 /**
@@ -231,13 +834,12 @@ void formater_valeur(int valeur, char resultat[]) {
  * \param bonus Le bonus. Vaut CASE_VIDE si pas de bonus
  */
 void calculer_totaux(const t_feuille feuille_joueur, int *t_sup, int *t_inf, int *t, int *bonus) {
-    const int BONUS = 35;
-    const int BORNE_BONUS = 62;
     // le dernier indice du tableau de la partie supérieure
     const int BORNE_SUP = 6;
     // si toutes les cases sont vides pour le supérieur et l'inférieur
     bool vide_sup, vide_inf;
     int i;
+    DEBUT_MESURE();
 
     // total supérieur
     *t_sup = 0;
@@ -283,255 +885,655 @@ void calculer_totaux(const t_feuille feuille_joueur, int *t_sup, int *t_inf, int
     else {
         *t = *t_sup + *t_inf;
     }
+
+    FIN_MESURE(PHASE_TOTAUX);
 }
 
 /**
- * \fn void afficher_ligne(const char texte[], int valeur)
- * \brief Affiche une ligne de la feuille de marque
- * \param texte Le texte à afficher dans la colonne de gauche
- * \param valeur La valeur à formater et afficher dans la colonne de droite 
+ * \fn int plafonner_sous_total(int sous_total)
+ * \brief Plafonne un total supérieur : au-delà de la borne, seul le bonus compte
+ * \param sous_total Le total supérieur, sans bonus
+ * \return Le total, au plus BORNE_BONUS + 1
  */
-void afficher_ligne(const char texte[], int valeur) {
-    char case_txt[4];
+int plafonner_sous_total(int sous_total) {
+    if (sous_total > BORNE_BONUS)
+        sous_total = BORNE_BONUS + 1;
 
-    formater_valeur(valeur, case_txt);
-    printf("│ %-20s │      %s      │\n", texte, case_txt);
+    return sous_total;
 }
 
 /**
- * \fn void afficher_feuille_marque(const nom nom_joueur, const t_feuille feuille_joueur)
- * \brief Affiche la feuille de marque d'un joueur
- * \param nom_joueur Le nom du joueur à afficher en haut de la colonne de droite
- * \param feuille_joueur Les scores du joueur
- */ 
-void afficher_feuille_marque(const nom nom_joueur, const t_feuille feuille_joueur) {
-    // Un caractère de bordure est un caractère composé,
-    // (c-a-d un caractère s'étalant sur 3 octets)
-    // On calcule ici la taille maximum du nom formaté maximum
-    const int T_NOM_FORMATE = 3 * TAILLE_NOM;
-
-    char nom_formate[T_NOM_FORMATE];    // le nom avec les bordures
-    int total_sup, total_inf, total;    // les totaux
-    int bonus;                          // la valeur du bonus
-    char texte[20];                     // texte de la colonne de gauche
-
-    calculer_totaux(feuille_joueur, &total_sup, &total_inf, &total, &bonus);
-
-    /* PARTIE HAUTE TABLEAU */
-    formater_nom_joueur(nom_joueur, nom_formate);
-    printf("┌──────────────────────┬%s┐\n", nom_formate);
-
-    // afficher les 6 première cases
-    for (int i = 0; i < 6; i++) {
-        sprintf(texte, "%1$d [total de %1$d]", i+1);    // ex: 5 [total de 5]
-        afficher_ligne(texte, feuille_joueur[i]);
-    }
-
-    afficher_ligne("Bonus si > à 62 [35]", bonus);
-    afficher_ligne("Total superieur", total_sup);
-    printf("└──────────────────────┴───────────────┘\n\n");
-
-    /* PARTIE BASSE TABLEAU */
-    printf("┌──────────────────────┬───────────────┐\n");
-    afficher_ligne("Brelan       [total]", feuille_joueur[I_BRELAN]);
-    afficher_ligne("Carré        [total]", feuille_joueur[I_CARRE]);
-    afficher_ligne("Full House   [25]", feuille_joueur[I_FULL_H]);
-    afficher_ligne("Petite suite [30]", feuille_joueur[I_P_SUITE]);
-    afficher_ligne("Grande suite [40]", feuille_joueur[I_G_SUITE]);
-    afficher_ligne("Yams         [50]", feuille_joueur[I_YAMS]);
-    afficher_ligne("Chance       [total]", feuille_joueur[I_CHANCE]);
-    afficher_ligne("Total inferieur ", total_inf);
-    printf("└──────────────────────┴───────────────┘\n\n");
-
-    /* PARTIE TOTAL TABLEAU */
-    printf("┌──────────────────────┬───────────────┐\n");
-    afficher_ligne("Total", total);
-    printf("└──────────────────────┴───────────────┘\n");
-}
+ * \struct t_feuille_compacte
+ * \brief Feuille de marque compacte, dont les totaux sont tenus à jour à chaque inscription
+ *
+ * Utilisée par la simulation et le solveur. La partie interactive garde la
+ * t_feuille avec ses CASE_VIDE, et passe de l'une à l'autre avec
+ * compacter_feuille et decompacter_feuille.
+ */
+typedef struct {
+    uint16_t remplies;                  /**< Bit i à 1 si la case i est remplie */
+    uint16_t total_sup;                 /**< Total supérieur, sans le bonus */
+    uint16_t total_inf;                 /**< Total inférieur */
+    uint8_t bonus;                      /**< BONUS s'il est gagné, 0 sinon */
+    uint8_t points[TAILLE_FEUILLE];     /**< Points de chaque case, 0 si elle est vide */
+} t_feuille_compacte;
 
 /**
- * \fn bool oui_non(const char texte[]) 
- * \brief Demande à l'utilisateur de saisir oui ou non, et redemande si besoin
- * \param texte Texte accompagnant la demande
- * \return true si l'utilisateur rentre oui, false s'il rentre non
+ * \fn void initialiser_feuille_compacte(t_feuille_compacte *feuille)
+ * \brief Vide une feuille compacte
+ * \param feuille La feuille
  */
-bool oui_non(const char texte[]) {
-    bool correct, resultat;
-    char entree[100];   // une entrée plus grande que "oui" et "non"
-
-    do {
-        // On récupère l'entrée utilisateur
-        printf(texte);
-        lire_clavier(entree);
-        // on met le texte en minuscule pour la comparaison, ce qui permet
-        // d'accepter les mots oui et non quelque soit la casse (OUI, Oui...)
-        for (int i = 0; i < strlen(entree); i++) {
-            entree[i] = tolower(entree[i]);
-        }
-
-        // Début des tests
-        correct = true;
-        if (strcmp(entree, "oui") == 0) {
-            resultat = true;
-        } 
-        else if (strcmp(entree, "non") == 0) {
-            resultat = false;
-        } 
-        else if (entree[0] == '\0') {
-            // on vérifie si le choix est vide
-            printf("Choix vide\n\n");
-            correct = false;
-        }
-        else {
-            printf("Veuillez saisir \"oui\" ou \"non\"\n\n");
-            correct = false;
-        }
-    } while (!correct);
-
-    return resultat;
+void initialiser_feuille_compacte(t_feuille_compacte *feuille) {
+    memset(feuille, 0, sizeof(t_feuille_compacte));
 }
 
 /**
- * \fn void trier_des(t_des liste_des)
- * \brief Tries dans l'ordre croissant les 5 dés pour faciliter les calculs de combinaisons
- * \param liste_des La liste des dés à trier
+ * \fn void ecrire_case(t_feuille_compacte *feuille, int indice, int points)
+ * \brief Inscrit des points dans une case vide et met à jour les totaux et le bonus
+ * \param feuille La feuille
+ * \param indice L'indice de la case
+ * \param points Les points inscrits
  */
-void trier_des(t_des liste_des) {
-    // Implémentation du tri par sélection
-    int ind_min, i, j;
-    int temp;       // variable temporaire pour l'échange
+void ecrire_case(t_feuille_compacte *feuille, int indice, int points) {
+    feuille->remplies |= 1 << indice;
+    feuille->points[indice] = points;
 
-    for (i = 0; i < NB_DES - 1; i++) {
-        ind_min = i;
-        for (j = i+1; j < NB_DES; j++) {
-            if (liste_des[ind_min] > liste_des[j])
-                ind_min = j;
-        }
-
-        // on échange le minimum avec la case i
-        temp = liste_des[i];
-        liste_des[i] = liste_des[ind_min];
-        liste_des[ind_min] = temp;
+    if (indice < 6) {
+        feuille->total_sup += points;
+        if (feuille->total_sup > BORNE_BONUS)
+            feuille->bonus = BONUS;
+    }
+    else {
+        feuille->total_inf += points;
     }
 }
 
 /**
- * \fn afficher_des(t_des liste_des)
- * \brief Affiche la liste des dés, chaque dé ayant une bordure
- * \param liste_des La liste des dés à afficher
+ * \fn bool case_libre(const t_feuille_compacte *feuille, int indice)
+ * \brief Vérifie si une case de la feuille compacte est vide
+ * \param feuille La feuille
+ * \param indice L'indice de la case
+ * \return Vrai si la case est vide
  */
-void afficher_des(t_des liste_des) {
-    printf("    ╭───╮  ╭───╮  ╭───╮  ╭───╮  ╭───╮\n    ");
-    for (int i = 0; i < NB_DES; i++) {
-        printf("│ %d │  ", liste_des[i]);
-    }
-    printf("\n");
-    printf("    ╰───╯  ╰───╯  ╰───╯  ╰───╯  ╰───╯\n");
-    printf(" n°   1      2      3      4      5  \n\n");
+bool case_libre(const t_feuille_compacte *feuille, int indice) {
+    return (feuille->remplies & (1 << indice)) == 0;
 }
 
 /**
- * \fn choix_des(t_des a_lancer)
- * \brief Demande à l'utilisateur les dés qu'il souhaite relancer
- * \param a_lancer Tableau en sortie contenant 1 si le dé doit être relancé, 0 sinon
+ * \fn int total_compacte(const t_feuille_compacte *feuille)
+ * \brief Donne le total d'une feuille compacte, bonus compris
+ * \param feuille La feuille
+ * \return Le total
  */
-void choix_des(t_des a_lancer) {
-    const char FIN[] = "fin";
-    char entree[100];       // réponse entrée par l'utilisateur (volontairement plus grande)
-    int indice_de;          // L'indice du dé une fois transformé en nombre
+int total_compacte(const t_feuille_compacte *feuille) {
+    return feuille->total_sup + feuille->bonus + feuille->total_inf;
+}
 
-    // on initialise les dés à relancer à 0
-    for (int i = 0; i < NB_DES; i++)
-        a_lancer[i] = 0;
+/**
+ * \fn int sous_total_compacte(const t_feuille_compacte *feuille)
+ * \brief Donne le sous-total supérieur plafonné, tel que le distingue le solveur
+ * \param feuille La feuille
+ * \return Le sous-total, au plus BORNE_BONUS + 1
+ */
+int sous_total_compacte(const t_feuille_compacte *feuille) {
+    return plafonner_sous_total(feuille->total_sup);
+}
+
+/**
+ * \fn void compacter_feuille(const t_feuille feuille, t_feuille_compacte *compacte)
+ * \brief Convertit une feuille de marque en feuille compacte
+ * \param feuille La feuille de marque
+ * \param compacte La feuille compacte équivalente
+ */
+void compacter_feuille(const t_feuille feuille, t_feuille_compacte *compacte) {
+    initialiser_feuille_compacte(compacte);
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        if (feuille[i] != CASE_VIDE)
+            ecrire_case(compacte, i, feuille[i]);
+    }
+}
 
-    printf("Veuillez entrer les dés à relancer, un\n");
-    printf("dé par ligne, puis terminez par \"fin\"\n");
+/**
+ * \fn void decompacter_feuille(const t_feuille_compacte *compacte, t_feuille feuille)
+ * \brief Convertit une feuille compacte en feuille de marque
+ * \param compacte La feuille compacte
+ * \param feuille La feuille de marque équivalente, avec CASE_VIDE dans les cases vides
+ */
+void decompacter_feuille(const t_feuille_compacte *compacte, t_feuille feuille) {
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        feuille[i] = CASE_VIDE;
+        if (!case_libre(compacte, i))
+            feuille[i] = compacte->points[i];
+    }
+}
 
-    printf("(1, 2...) ");
-    lire_clavier(entree);
+/**
+ * \fn void totaux_compacte(const t_feuille_compacte *feuille, int *t_sup, int *t_inf, int *t, int *bonus)
+ * \brief Donne les mêmes totaux que calculer_totaux, sans parcourir la feuille
+ * \param feuille La feuille compacte
+ * \param t_sup Le total supérieur, bonus compris. Vaut CASE_VIDE si les cases supérieures sont vides
+ * \param t_inf Le total inférieur. Vaut CASE_VIDE si les cases inférieures sont vides
+ * \param t Le total des deux. Vaut CASE_VIDE si les deux totaux sont vides
+ * \param bonus Le bonus. Vaut CASE_VIDE si pas de bonus
+ */
+void totaux_compacte(const t_feuille_compacte *feuille, int *t_sup, int *t_inf, int *t, int *bonus) {
+    const int CASES_SUP = (1 << 6) - 1;     // les bits des cases supérieures
+    bool vide_sup, vide_inf;
 
-    // on met le texte en minuscules pour autoriser différentes écritures de fin (Fin, FIN...)
-    for (int i = 0; i < strlen(entree); i++)
-        entree[i] = tolower(entree[i]);
+    vide_sup = (feuille->remplies & CASES_SUP) == 0;
+    vide_inf = (feuille->remplies & ~CASES_SUP) == 0;
 
-    while (strcmp(FIN, entree) != 0) {
-        if (entree[0] == '\0') {
-            printf("Choix vide\n");
-        }
-        // vérifier qu'il s'agit d'un chiffre
-        else if (strlen(entree) != 1 || !isdigit(entree[0])) {
-            printf("Nom de dé incorrect\n");
-        }
-        else {
-            // dans le cas où il s'agit bien d'un chiffre, on l'extrait
-            // et on vérifie qu'il est compris entre 1 et 5 et qu'il n'a
-            // pas déjà été entré
-            sscanf(entree, "%d", &indice_de);
-            if (indice_de > NB_DES || indice_de < 1) {
-                printf("Nom de dé incorrect\n");
-            }
-            else if (a_lancer[indice_de - 1] == 1) {
-                printf("Dé déjà saisi\n");
-            }
-            else {
-                a_lancer[indice_de - 1] = 1;
-            }
-        }
+    *bonus = feuille->bonus > 0 ? feuille->bonus : CASE_VIDE;
+    *t_sup = vide_sup ? CASE_VIDE : feuille->total_sup + feuille->bonus;
+    *t_inf = vide_inf ? CASE_VIDE : feuille->total_inf;
+    *t = (vide_sup && vide_inf) ? CASE_VIDE : total_compacte(feuille);
+}
 
-        printf("(1, 2...) ");
-        lire_clavier(entree);
+/**
+ * \struct t_table_joueurs
+ * \brief Feuilles de tous les joueurs d'une table, rangées champ par champ
+ *
+ * Chaque champ de t_feuille_compacte devient un tableau indicé par le joueur :
+ * les totaux ou une même case de tous les joueurs sont contigus, et se
+ * parcourent d'une traite pour classer la table.
+ */
+typedef struct {
+    uint8_t nb_joueurs;                             /**< Nombre de joueurs assis à la table */
+    uint16_t remplies[MAX_JOUEURS];                 /**< Bit i à 1 si la case i du joueur est remplie */
+    uint16_t total_sup[MAX_JOUEURS];                /**< Total supérieur de chaque joueur, sans le bonus */
+    uint16_t total_inf[MAX_JOUEURS];                /**< Total inférieur de chaque joueur */
+    uint8_t bonus[MAX_JOUEURS];                     /**< BONUS si le joueur l'a gagné, 0 sinon */
+    uint8_t points[TAILLE_FEUILLE][MAX_JOUEURS];    /**< Points de chaque case de chaque joueur */
+} t_table_joueurs;
+
+/**
+ * \fn void initialiser_table_joueurs(t_table_joueurs *table, int nb_joueurs)
+ * \brief Vide les feuilles de tous les joueurs d'une table
+ * \param table La table
+ * \param nb_joueurs Le nombre de joueurs, au plus MAX_JOUEURS
+ */
+void initialiser_table_joueurs(t_table_joueurs *table, int nb_joueurs) {
+    memset(table, 0, sizeof(t_table_joueurs));
+    table->nb_joueurs = nb_joueurs;
+}
+
+/**
+ * \fn void inscrire_table(t_table_joueurs *table, int joueur, int indice, int points)
+ * \brief Inscrit des points dans une case vide d'un joueur, comme ecrire_case
+ * \param table La table
+ * \param joueur Le joueur
+ * \param indice L'indice de la case
+ * \param points Les points inscrits
+ */
+void inscrire_table(t_table_joueurs *table, int joueur, int indice, int points) {
+    DEBUT_MESURE();
 
-        // on met le texte en minuscules pour autoriser différentes écritures de fin (Fin, FIN...)
-        for (int i = 0; i < strlen(entree); i++)
-            entree[i] = tolower(entree[i]);
+    table->remplies[joueur] |= 1 << indice;
+    table->points[indice][joueur] = points;
+
+    if (indice < 6) {
+        table->total_sup[joueur] += points;
+        if (table->total_sup[joueur] > BORNE_BONUS)
+            table->bonus[joueur] = BONUS;
+    }
+    else {
+        table->total_inf[joueur] += points;
     }
+
+    FIN_MESURE(PHASE_TOTAUX);
 }
 
 /**
- * \fn lancer_des(t_des liste_des)
- * \brief Gère le lancement aléatoire des dés
- * \param liste_des Les dés triés définitifs triés dans l'ordre croissant
+ * \fn bool case_libre_table(const t_table_joueurs *table, int joueur, int indice)
+ * \brief Vérifie si une case d'un joueur est vide
+ * \param table La table
+ * \param joueur Le joueur
+ * \param indice L'indice de la case
+ * \return Vrai si la case est vide
  */
-void lancer_des(t_des liste_des) {
-    const int MAX_TOURS = 3;
-    t_des a_lancer = {1, 1, 1, 1, 1};   // les dés à lancer (1 = lancer, 0 = garder)
-    bool relancer;                      // s'il faut relancer les dés
-    int tours, i;
+bool case_libre_table(const t_table_joueurs *table, int joueur, int indice) {
+    return (table->remplies[joueur] & (1 << indice)) == 0;
+}
 
-    printf("Appuyez sur entrée pour lancer les dés... ");
-    getchar();
-    printf("\n");
+/**
+ * \fn void feuille_table(const t_table_joueurs *table, int joueur, t_feuille_compacte *feuille)
+ * \brief Rassemble la feuille d'un joueur, pour une stratégie ou un affichage
+ * \param table La table
+ * \param joueur Le joueur
+ * \param feuille La feuille compacte du joueur
+ */
+void feuille_table(const t_table_joueurs *table, int joueur, t_feuille_compacte *feuille) {
+    feuille->remplies = table->remplies[joueur];
+    feuille->total_sup = table->total_sup[joueur];
+    feuille->total_inf = table->total_inf[joueur];
+    feuille->bonus = table->bonus[joueur];
+    for (int i = 0; i < TAILLE_FEUILLE; i++)
+        feuille->points[i] = table->points[i][joueur];
+}
 
-    relancer = true;
-    tours = 1;
+/**
+ * \fn void totaux_table(const t_table_joueurs *table, int totaux[MAX_JOUEURS])
+ * \brief Donne le total de chaque joueur, bonus compris
+ * \param table La table
+ * \param totaux Le total de chaque joueur assis
+ */
+void totaux_table(const t_table_joueurs *table, int totaux[MAX_JOUEURS]) {
+    DEBUT_MESURE();
 
-    while (relancer && tours <= MAX_TOURS) {
-        // lancer les dés nécessaires
-        for (i = 0; i < NB_DES; i++) {
-            if (a_lancer[i] == 1)
-                liste_des[i] = rand() % 6 + 1;
-        }
+    for (int j = 0; j < table->nb_joueurs; j++)
+        totaux[j] = table->total_sup[j] + table->bonus[j] + table->total_inf[j];
 
-        printf("Les dés sont lancés, vous obtenez : \n");
-        afficher_des(liste_des);
+    FIN_MESURE(PHASE_TOTAUX);
+}
 
-        // Ne pas demander à relancer au dernier tour
-        if (tours != MAX_TOURS) {
-            relancer = oui_non("Souhaitez-vous relancer les dés ?\n(oui / non) : ");
-            printf("\n");
+/**
+ * \fn void dessiner_ligne(t_ecran *ecran, int ligne, int colonne, const char texte[], int valeur)
+ * \brief Dessine une ligne de la feuille de marque
+ *
+ * Les colonnes sont placées par cellule : un accent du texte ne décale
+ * plus la bordure.
+ * \param ecran L'écran
+ * \param ligne La ligne de l'écran
+ * \param colonne La colonne du bord gauche de la feuille
+ * \param texte Le texte à afficher dans la colonne de gauche
+ * \param valeur La valeur à afficher dans la colonne de droite, rien si CASE_VIDE
+ */
+void dessiner_ligne(t_ecran *ecran, int ligne, int colonne, const char texte[], int valeur) {
+    ecrire_ecran(ecran, ligne, colonne, "│ %s", texte);
+    if (valeur == CASE_VIDE)
+        ecrire_ecran(ecran, ligne, colonne + 23, "│               │");
+    else
+        ecrire_ecran(ecran, ligne, colonne + 23, "│      %3d      │", valeur);
+}
 
-            if (relancer)
-                choix_des(a_lancer);
-            
-            printf("\n");
-        }
+/**
+ * \fn int dessiner_feuille_marque(t_ecran *ecran, int ligne, int colonne, const nom nom_joueur, const t_feuille feuille_joueur)
+ * \brief Dessine la feuille de marque d'un joueur, sur LARGEUR_FEUILLE colonnes et HAUTEUR_FEUILLE lignes
+ * \param ecran L'écran
+ * \param ligne La ligne du haut de la feuille
+ * \param colonne La colonne du bord gauche de la feuille
+ * \param nom_joueur Le nom du joueur à afficher en haut de la colonne de droite
+ * \param feuille_joueur Les scores du joueur
+ * \return La ligne qui suit la feuille
+ */
+int dessiner_feuille_marque(t_ecran *ecran, int ligne, int colonne, const nom nom_joueur, const t_feuille feuille_joueur) {
+    const int TAILLE_COL = TAILLE_NOM + 1;  // taille de la colonne du joueur
+    const int MARGE = 1;                    // taille d'une marge
+
+    int total_sup, total_inf, total;    // les totaux
+    int bonus;                          // la valeur du bonus
+    int bord_g, bord_d;                 // taille du bord gauche et du bord droit autour du nom
+    char texte[20];                     // texte de la colonne de gauche
+    DEBUT_MESURE();
+
+    calculer_totaux(feuille_joueur, &total_sup, &total_inf, &total, &bonus);
+
+    /* PARTIE HAUTE TABLEAU */
+    // le nom est centré entre ses marges, le bord gauche étant plus long
+    // d'un caractère si le nom ne peut être centré correctement
+    bord_d = (TAILLE_COL - (int)strlen(nom_joueur) - 2*MARGE) / 2;
+    bord_g = TAILLE_COL - (int)strlen(nom_joueur) - 2*MARGE - bord_d;
+    ecrire_ecran(ecran, ligne, colonne, "┌──────────────────────┬");
+    remplir_ecran(ecran, ligne, colonne + 24, "─", bord_g);
+    ecrire_ecran(ecran, ligne, colonne + 24 + bord_g, " %s ", nom_joueur);
+    remplir_ecran(ecran, ligne, colonne + 24 + TAILLE_COL - bord_d, "─", bord_d);
+    ecrire_ecran(ecran, ligne++, colonne + 24 + TAILLE_COL, "┐");
 
-        tours++;
+    // afficher les 6 première cases
+    for (int i = 0; i < 6; i++) {
+        sprintf(texte, "%1$d [total de %1$d]", i+1);    // ex: 5 [total de 5]
+        dessiner_ligne(ecran, ligne++, colonne, texte, feuille_joueur[i]);
     }
 
-    // à ce stade, les dés sont définitifs et ne sont plus affichés
-    // on les trie pour faciliter l'utilisation dans les fonctions
-    trier_des(liste_des);
+    dessiner_ligne(ecran, ligne++, colonne, "Bonus si > à 62 [35]", bonus);
+    dessiner_ligne(ecran, ligne++, colonne, "Total superieur", total_sup);
+    ecrire_ecran(ecran, ligne++, colonne, "└──────────────────────┴───────────────┘");
+    ligne++;
+
+    /* PARTIE BASSE TABLEAU */
+    ecrire_ecran(ecran, ligne++, colonne, "┌──────────────────────┬───────────────┐");
+    dessiner_ligne(ecran, ligne++, colonne, "Brelan       [total]", feuille_joueur[I_BRELAN]);
+    dessiner_ligne(ecran, ligne++, colonne, "Carré        [total]", feuille_joueur[I_CARRE]);
+    dessiner_ligne(ecran, ligne++, colonne, "Full House   [25]", feuille_joueur[I_FULL_H]);
+    dessiner_ligne(ecran, ligne++, colonne, "Petite suite [30]", feuille_joueur[I_P_SUITE]);
+    dessiner_ligne(ecran, ligne++, colonne, "Grande suite [40]", feuille_joueur[I_G_SUITE]);
+    dessiner_ligne(ecran, ligne++, colonne, "Yams         [50]", feuille_joueur[I_YAMS]);
+    dessiner_ligne(ecran, ligne++, colonne, "Chance       [total]", feuille_joueur[I_CHANCE]);
+    dessiner_ligne(ecran, ligne++, colonne, "Total inferieur ", total_inf);
+    ecrire_ecran(ecran, ligne++, colonne, "└──────────────────────┴───────────────┘");
+    ligne++;
+
+    /* PARTIE TOTAL TABLEAU */
+    ecrire_ecran(ecran, ligne++, colonne, "┌──────────────────────┬───────────────┐");
+    dessiner_ligne(ecran, ligne++, colonne, "Total", total);
+    ecrire_ecran(ecran, ligne++, colonne, "└──────────────────────┴───────────────┘");
+
+    FIN_MESURE(PHASE_AFFICHAGE);
+    return ligne;
+}
+
+/**
+ * \def ECHANGER_SI_PLUS_GRAND(a, b)
+ * \brief Place le plus petit de a et b dans a et le plus grand dans b, sans branchement
+ */
+#define ECHANGER_SI_PLUS_GRAND(a, b) do { \
+        int min_ = (a) < (b) ? (a) : (b); \
+        int max_ = (a) < (b) ? (b) : (a); \
+        (a) = min_; \
+        (b) = max_; \
+    } while (0)
+
+/**
+ * \fn void trier_des(t_des liste_des)
+ * \brief Tries dans l'ordre croissant les 5 dés pour faciliter les calculs de combinaisons
+ *
+ * Réseau de tri à 9 comparateurs, optimal pour 5 éléments : la suite des
+ * comparaisons ne dépend pas des dés, et chaque comparateur se compile en
+ * min/max sans saut, donc sans erreur de prédiction sur des dés aléatoires.
+ * \param liste_des La liste des dés à trier
+ */
+void trier_des(t_des liste_des) {
+    int d0 = liste_des[0], d1 = liste_des[1], d2 = liste_des[2], d3 = liste_des[3], d4 = liste_des[4];
+
+    ECHANGER_SI_PLUS_GRAND(d0, d1);
+    ECHANGER_SI_PLUS_GRAND(d3, d4);
+    ECHANGER_SI_PLUS_GRAND(d2, d4);
+    ECHANGER_SI_PLUS_GRAND(d2, d3);
+    ECHANGER_SI_PLUS_GRAND(d0, d3);
+    ECHANGER_SI_PLUS_GRAND(d0, d2);
+    ECHANGER_SI_PLUS_GRAND(d1, d4);
+    ECHANGER_SI_PLUS_GRAND(d1, d3);
+    ECHANGER_SI_PLUS_GRAND(d1, d2);
+
+    liste_des[0] = d0;
+    liste_des[1] = d1;
+    liste_des[2] = d2;
+    liste_des[3] = d3;
+    liste_des[4] = d4;
+}
+
+/**
+ * \def TAILLE_LOT_TRI
+ * \brief Nombre de mains triées ensemble par trier_voies_des, une par voie des registres vectoriels
+ *
+ * 8 entiers remplissent un registre AVX2 ; sans AVX2, le compilateur découpe
+ * mal un vecteur de 32 octets et 4 voies (SSE2, NEON) vont plus vite.
+ */
+#ifdef __AVX2__
+#define TAILLE_LOT_TRI 8
+#else
+#define TAILLE_LOT_TRI 4
+#endif
+
+/**
+ * \typedef int t_voies_des
+ * \brief Même dé de TAILLE_LOT_TRI mains, dans un vecteur du compilateur (SSE, AVX ou NEON selon la cible)
+ */
+typedef int t_voies_des __attribute__((vector_size(TAILLE_LOT_TRI * sizeof(int))));
+
+/**
+ * \fn void trier_voies_des(t_voies_des des[NB_DES])
+ * \brief Trie TAILLE_LOT_TRI mains à la fois avec le même réseau que trier_des
+ *
+ * Les mains sont rangées par position de dé (des[i][j] est le dé i de la
+ * main j), pour qu'un comparateur trie toutes les voies avec un masque de
+ * comparaison au lieu d'un saut. Transposer des t_des coûte plus cher que le
+ * tri lui-même : ce format est fait pour les lots qui restent transposés.
+ * \param des Les dés des mains, par position
+ */
+void trier_voies_des(t_voies_des des[NB_DES]) {
+    t_voies_des masque, min, max;
+
+#define COMPARATEUR_VOIES(a, b) do { \
+        masque = des[a] < des[b]; \
+        min = (des[a] & masque) | (des[b] & ~masque); \
+        max = (des[b] & masque) | (des[a] & ~masque); \
+        des[a] = min; \
+        des[b] = max; \
+    } while (0)
+
+    COMPARATEUR_VOIES(0, 1);
+    COMPARATEUR_VOIES(3, 4);
+    COMPARATEUR_VOIES(2, 4);
+    COMPARATEUR_VOIES(2, 3);
+    COMPARATEUR_VOIES(0, 3);
+    COMPARATEUR_VOIES(0, 2);
+    COMPARATEUR_VOIES(1, 4);
+    COMPARATEUR_VOIES(1, 3);
+    COMPARATEUR_VOIES(1, 2);
+
+#undef COMPARATEUR_VOIES
+}
+
+/**
+ * \fn int dessiner_des(t_ecran *ecran, int ligne, int colonne, t_des liste_des)
+ * \brief Dessine la liste des dés, chaque dé ayant une bordure
+ * \param ecran L'écran
+ * \param ligne La ligne du haut des dés
+ * \param colonne La colonne de départ
+ * \param liste_des La liste des dés à afficher
+ * \return La ligne qui suit les dés et leur ligne vide
+ */
+int dessiner_des(t_ecran *ecran, int ligne, int colonne, t_des liste_des) {
+    ecrire_ecran(ecran, ligne, colonne, "    ╭───╮  ╭───╮  ╭───╮  ╭───╮  ╭───╮");
+    for (int i = 0; i < NB_DES; i++) {
+        ecrire_ecran(ecran, ligne + 1, colonne + 4 + 7 * i, "│ %d │", liste_des[i]);
+    }
+    ecrire_ecran(ecran, ligne + 2, colonne, "    ╰───╯  ╰───╯  ╰───╯  ╰───╯  ╰───╯");
+    ecrire_ecran(ecran, ligne + 3, colonne, " n°   1      2      3      4      5");
+
+    return ligne + 5;
+}
+
+/**
+ * \struct t_alea
+ * \brief Générateur pseudo-aléatoire xoshiro256**, rapide et à flux indépendants
+ *
+ * Chaque fil d'exécution possède son propre générateur : aucun état n'est partagé,
+ * et une même graine redonne exactement les mêmes dés.
+ */
+typedef struct {
+    uint64_t etat[4];   /**< L'état interne, jamais entièrement nul */
+} t_alea;
+
+/**
+ * \fn uint64_t rotation(uint64_t x, int k)
+ * \brief Rotation vers la gauche des bits d'un entier de 64 bits
+ */
+uint64_t rotation(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * \fn uint64_t alea_suivant(t_alea *alea)
+ * \brief Tire le nombre suivant du générateur
+ * \param alea Le générateur
+ * \return Un entier de 64 bits uniforme
+ */
+uint64_t alea_suivant(t_alea *alea) {
+    uint64_t *e = alea->etat;
+    uint64_t resultat, t;
+
+    resultat = rotation(e[1] * 5, 7) * 9;
+    t = e[1] << 17;
+    e[2] ^= e[0];
+    e[3] ^= e[1];
+    e[1] ^= e[2];
+    e[0] ^= e[3];
+    e[2] ^= t;
+    e[3] = rotation(e[3], 45);
+
+    return resultat;
+}
+
+/**
+ * \fn void initialiser_alea(t_alea *alea, uint64_t graine)
+ * \brief Initialise un générateur à partir d'une graine, étalée avec splitmix64
+ * \param alea Le générateur
+ * \param graine La graine, quelconque
+ */
+void initialiser_alea(t_alea *alea, uint64_t graine) {
+    uint64_t z;
+
+    for (int i = 0; i < 4; i++) {
+        graine += 0x9e3779b97f4a7c15ULL;
+        z = graine;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        alea->etat[i] = z ^ (z >> 31);
+    }
+}
+
+/**
+ * \fn void sauter_alea(t_alea *alea)
+ * \brief Avance le générateur de 2^128 tirages, pour obtenir un flux qui ne recoupe pas le précédent
+ * \param alea Le générateur
+ */
+void sauter_alea(t_alea *alea) {
+    const uint64_t SAUT[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+    uint64_t nouvel_etat[4] = {0, 0, 0, 0};
+
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (SAUT[i] & (1ULL << b)) {
+                for (int k = 0; k < 4; k++)
+                    nouvel_etat[k] ^= alea->etat[k];
+            }
+            alea_suivant(alea);
+        }
+    }
+
+    memcpy(alea->etat, nouvel_etat, sizeof(nouvel_etat));
+}
+
+/**
+ * \fn int alea_borne(t_alea *alea, int borne)
+ * \brief Tire un entier uniforme entre 0 et borne - 1, sans le biais du modulo
+ * \param alea Le générateur
+ * \param borne Le nombre de valeurs possibles
+ * \return L'entier tiré
+ */
+int alea_borne(t_alea *alea, int borne) {
+    // méthode de Lemire : on multiplie au lieu de diviser, et on rejette
+    // les rares tirages qui tomberaient dans la partie incomplète
+    const uint32_t SEUIL = (uint32_t)(-borne) % borne;
+    uint64_t produit;
+
+    do {
+        produit = (alea_suivant(alea) >> 32) * (uint64_t)borne;
+    } while ((uint32_t)produit < SEUIL);
+
+    return produit >> 32;
+}
+
+/**
+ * \fn int lancer_de(t_alea *alea)
+ * \brief Lance un dé
+ * \param alea Le générateur
+ * \return La valeur du dé, entre 1 et 6
+ */
+int lancer_de(t_alea *alea) {
+    return alea_borne(alea, 6) + 1;
+}
+
+/**
+ * \typedef uint64_t t_histogramme
+ * \brief Main décrite par le nombre de dés de chaque face : l'octet f - 1 compte les dés montrant f
+ *
+ * Un compte ne dépasse jamais NB_DES, si bien qu'une addition ou une
+ * multiplication sur le mot entier traite les six faces à la fois sans
+ * qu'une retenue passe d'un octet à l'autre.
+ */
+typedef uint64_t t_histogramme;
+
+/**
+ * \def FACES_HISTOGRAMME
+ * \brief Un 1 dans l'octet de chacune des six faces
+ */
+/**
+ * \def COEFFICIENTS_SOMME
+ * \brief Multiplicateur qui range dans l'octet 5 la somme des faces pondérées par leur compte
+ */
+#define FACES_HISTOGRAMME 0x010101010101ULL
+#define COEFFICIENTS_SOMME 0x010203040506ULL
+
+/**
+ * \fn t_histogramme histogramme_des(const t_des liste_des)
+ * \brief Compte les dés de chaque face, une seule fois par lancer
+ * \param liste_des La liste des dés, triée ou non
+ * \return L'histogramme de la main
+ */
+t_histogramme histogramme_des(const t_des liste_des) {
+    t_histogramme histogramme = 0;
+
+    for (int i = 0; i < NB_DES; i++)
+        histogramme += 1ULL << (8 * (liste_des[i] - 1));
+
+    return histogramme;
+}
+
+/**
+ * \fn int nombre_faces(t_histogramme histogramme, int valeur)
+ * \brief Donne le nombre de dés montrant une face
+ * \param histogramme L'histogramme de la main
+ * \param valeur La face, de 1 à 6
+ * \return Le nombre de dés de cette face
+ */
+int nombre_faces(t_histogramme histogramme, int valeur) {
+    return (histogramme >> (8 * (valeur - 1))) & 0xFF;
+}
+
+/**
+ * \fn int somme_histogramme(t_histogramme histogramme)
+ * \brief Calcule la somme des dés en une multiplication : l'octet 5 du produit vaut la somme des comptes fois les faces
+ * \param histogramme L'histogramme de la main
+ * \return La somme des valeurs des dés
+ */
+int somme_histogramme(t_histogramme histogramme) {
+    return ((histogramme * COEFFICIENTS_SOMME) >> 40) & 0xFF;
+}
+
+/**
+ * \fn t_histogramme faces_presentes(t_histogramme histogramme)
+ * \brief Réduit chaque compte à 1 s'il est non nul (un compte tient sur ses 3 bits de poids faible)
+ * \param histogramme L'histogramme de la main
+ * \return Le bit de poids faible de l'octet de chaque face présente
+ */
+t_histogramme faces_presentes(t_histogramme histogramme) {
+    return (histogramme | histogramme >> 1 | histogramme >> 2) & FACES_HISTOGRAMME;
+}
+
+/**
+ * \fn bool faces_identiques(t_histogramme histogramme, int nombre)
+ * \brief Vérifie qu'une face apparait au moins un certain nombre de fois
+ *
+ * Ajouter 128 - nombre à chaque octet fait passer à 1 le bit de poids fort
+ * des seuls comptes supérieurs ou égaux à nombre.
+ * \param histogramme L'histogramme de la main
+ * \param nombre Le nombre de dés identiques à rechercher
+ * \return Vrai si une face apparait au moins nombre fois, faux sinon
+ */
+bool faces_identiques(t_histogramme histogramme, int nombre) {
+    return ((histogramme + (128 - nombre) * FACES_HISTOGRAMME) & (0x80 * FACES_HISTOGRAMME)) != 0;
+}
+
+/**
+ * \fn bool faces_consecutives(t_histogramme histogramme, int longueur)
+ * \brief Vérifie que la main contient une suite de faces consécutives
+ * \param histogramme L'histogramme de la main
+ * \param longueur La longueur de la suite
+ * \return Vrai si la suite est présente, faux sinon
+ */
+bool faces_consecutives(t_histogramme histogramme, int longueur) {
+    t_histogramme suites;
+
+    // chaque décalage garde les faces dont la suivante est aussi présente
+    suites = faces_presentes(histogramme);
+    for (int i = 1; i < longueur; i++)
+        suites &= suites >> 8;
+
+    return suites != 0;
 }
 
 /**
@@ -553,25 +1555,12 @@ int somme_des(t_des liste_des) {
 /**
  * \fn bool suite_identique(t_des liste_des, int taille_suite)
  * \brief Vérifie si un certain nombre de dés sont identiques
- * \param liste_des La liste des dés triée
+ * \param liste_des La liste des dés, triée ou non
  * \param taille_suite Le nombre de dés identiques à rechercher
  * \return Vrai si la suite de dés est présente, faux sinon
  */
 bool suite_identique(t_des liste_des, int taille_suite) {
-    int occurence, i, j;
-
-    i = 0;
-    do {
-        // on vérifie le nombre de fois que le dé apparait dans les cases suivantes
-        occurence = 1;
-        for (j = 1; j < taille_suite; j++)
-            occurence += (liste_des[i] == liste_des[i+j]);
-
-        i++;
-    } while(occurence != taille_suite && i <= NB_DES - taille_suite);
-
-    // le nombre attendu de dé à suivre est trouvé ?
-    return occurence == taille_suite;
+    return faces_identiques(histogramme_des(liste_des), taille_suite);
 }
 
 /**
@@ -582,12 +1571,9 @@ bool suite_identique(t_des liste_des, int taille_suite) {
  */
 int brelan(t_des liste_des) {
     const int TAILLE_BRELAN = 3;
-    int resultat = 0;
+    t_histogramme histogramme = histogramme_des(liste_des);
 
-    if (suite_identique(liste_des, TAILLE_BRELAN))
-        resultat = somme_des(liste_des);
-
-    return resultat;
+    return faces_identiques(histogramme, TAILLE_BRELAN) * somme_histogramme(histogramme);
 }
 
 /**
@@ -598,12 +1584,9 @@ int brelan(t_des liste_des) {
  */
 int carre(t_des liste_des) {
     const int TAILLE_CARRE = 4;
-    int resultat = 0;
+    t_histogramme histogramme = histogramme_des(liste_des);
 
-    if (suite_identique(liste_des, TAILLE_CARRE))
-        resultat = somme_des(liste_des);
-
-    return resultat;
+    return faces_identiques(histogramme, TAILLE_CARRE) * somme_histogramme(histogramme);
 }
 
 /**
@@ -629,12 +1612,14 @@ int yams(t_des liste_des) {
  */
 int full_house(t_des liste_des) {
     const int POINTS = 25;
-    bool trouve = false;
+    t_histogramme histogramme = histogramme_des(liste_des);
+    int nb_faces;
+    bool trouve;
 
-    // dans un full house, les extrémités sont égales deux par deux,
-    // et la case centrale est égale à l'une des deux extrémités
-    trouve = (liste_des[0] == liste_des[1]) && (liste_des[3] == liste_des[4]);
-    trouve = trouve && (liste_des[2] == liste_des[0] || liste_des[2] == liste_des[4]);
+    // deux faces sans carré donnent un brelan et une paire ;
+    // comme avant, un yams compte aussi comme un full house
+    nb_faces = __builtin_popcountll(faces_presentes(histogramme));
+    trouve = (nb_faces == 2 && !faces_identiques(histogramme, 4)) || nb_faces == 1;
 
     // Pas de point si le full house n'est pas trouvée, et 25 si il l'est,
     // un booléen valant 0 ou 1
@@ -667,20 +1652,11 @@ void dedoublonner(t_des liste_des, t_des des_uniques) {
  */
 int petite_suite(t_des liste_des) {
     const int POINTS = 30;
-
-    t_des des_uniques;  // la liste des dés sans doublons
-    bool trouve;
-
-    // on récupère les dés uniques
-    dedoublonner(liste_des, des_uniques);
-
-    // Deux cas possibles seulement
-    trouve = (des_uniques[0] == des_uniques[3] - 3);
-    trouve = trouve || (des_uniques[1] == des_uniques[4] - 3);
+    const int LONGUEUR = 4;
 
     // Pas de point si la suite n'est pas trouvée, et 30 si elle l'est,
     // un booléen valant 0 ou 1
-    return trouve * POINTS;
+    return faces_consecutives(histogramme_des(liste_des), LONGUEUR) * POINTS;
 }
 
 /**
@@ -691,19 +1667,11 @@ int petite_suite(t_des liste_des) {
  */
 int grande_suite(t_des liste_des) {
     const int POINTS = 40;
-    
-    t_des des_uniques;  // la liste des dés sans doublons
-    bool trouve;
-
-    // on récupère les dés uniques
-    dedoublonner(liste_des, des_uniques);
-
-    // Un seul cas possible
-    trouve = (des_uniques[0] == des_uniques[4] - 4);
+    const int LONGUEUR = 5;
 
     // Pas de point si la suite n'est pas trouvée, et 40 si elle l'est,
     // un booléen valant 0 ou 1
-    return trouve * POINTS;
+    return faces_consecutives(histogramme_des(liste_des), LONGUEUR) * POINTS;
 }
 
 /**
@@ -724,15 +1692,114 @@ int chance(t_des liste_des) {
  * \return La somme de tous les dés de cette valeur
  */
 int total_de(t_des liste_des, int valeur) {
-    int somme;
+    return nombre_faces(histogramme_des(liste_des), valeur) * valeur;
+}
 
-    somme = 0;
-    for (int i = 0; i < NB_DES; i++) {
-        if (liste_des[i] == valeur)
-            somme = somme + liste_des[i];
+/**
+ * \fn int code_tirage(const t_des liste_des)
+ * \brief Calcule le code d'un tirage ordonné, en lisant les dés comme un nombre en base 6
+ * \param liste_des La liste des dés, triée ou non
+ * \return Le code du tirage, compris entre 0 et NB_TIRAGES - 1
+ */
+int code_tirage(const t_des liste_des) {
+    int code;
+
+    code = 0;
+    for (int i = NB_DES - 1; i >= 0; i--)
+        code = code * 6 + (liste_des[i] - 1);
+
+    return code;
+}
+
+/**
+ * \fn void initialiser_tables()
+ * \brief Construit les tables de points de toutes les mains, à appeler une fois au démarrage
+ *
+ * Chacune des 252 mains triées est évaluée une seule fois avec les fonctions
+ * de combinaisons (brelan, carre...), ce qui garantit des points identiques.
+ * Chacun des 7776 tirages ordonnés est ensuite associé à l'indice de sa main triée,
+ * de même que chaque lancer tel qu'il est enregistré dans un journal de parties.
+ */
+void initialiser_tables() {
+    t_des des;      // la main triée en cours de construction
+    int indice;     // l'indice de la main triée
+    int code;
+
+    // Etape 1 : on énumère les mains triées dans l'ordre croissant
+    indice = 0;
+    for (des[0] = 1; des[0] <= 6; des[0]++)
+    for (des[1] = des[0]; des[1] <= 6; des[1]++)
+    for (des[2] = des[1]; des[2] <= 6; des[2]++)
+    for (des[3] = des[2]; des[3] <= 6; des[3]++)
+    for (des[4] = des[3]; des[4] <= 6; des[4]++) {
+        memcpy(mains_triees[indice], des, sizeof(t_des));
+
+        for (int i = 0; i < 6; i++)
+            points_mains[indice][i] = total_de(des, i+1);
+        points_mains[indice][I_BRELAN] = brelan(des);
+        points_mains[indice][I_CARRE] = carre(des);
+        points_mains[indice][I_FULL_H] = full_house(des);
+        points_mains[indice][I_P_SUITE] = petite_suite(des);
+        points_mains[indice][I_G_SUITE] = grande_suite(des);
+        points_mains[indice][I_YAMS] = yams(des);
+        points_mains[indice][I_CHANCE] = chance(des);
+
+        for (int i = 0; i < TAILLE_FEUILLE; i++) {
+            if (points_mains[indice][i] > points_max[i])
+                points_max[i] = points_mains[indice][i];
+        }
+
+        indice_tirages[code_tirage(des)] = indice;
+        indice++;
     }
 
-    return somme;
+    // Etape 2 : un tirage non trié prend l'indice de sa version triée
+    for (code = 0; code < NB_TIRAGES; code++) {
+        int reste = code;
+        for (int i = 0; i < NB_DES; i++) {
+            des[i] = reste % 6 + 1;
+            reste = reste / 6;
+        }
+        trier_des(des);
+        indice_tirages[code] = indice_tirages[code_tirage(des)];
+    }
+
+    // Etape 3 : un lancer lu dans un journal, BITS_DE bits par dé, prend l'indice de sa main
+    for (int paquet = 0; paquet < NB_PAQUETS; paquet++) {
+        bool correct = true;
+        for (int i = 0; i < NB_DES; i++) {
+            des[i] = paquet >> (i * BITS_DE) & ((1 << BITS_DE) - 1);
+            correct = correct && des[i] >= 1 && des[i] <= 6;
+        }
+        indice_paquets[paquet] = correct ? indice_tirages[code_tirage(des)] : MAIN_INCORRECTE;
+    }
+}
+
+/**
+ * \fn int indice_main(const t_des liste_des)
+ * \brief Retrouve l'indice de la main triée correspondant à des dés
+ * \param liste_des La liste des dés, triée ou non
+ * \return L'indice de la main, compris entre 0 et NB_MAINS - 1
+ */
+int indice_main(const t_des liste_des) {
+    return indice_tirages[code_tirage(liste_des)];
+}
+
+/**
+ * \fn int points_case(const t_des liste_des, int indice)
+ * \brief Donne les points que rapportent des dés dans une case, comme les parties les inscrivent
+ * \param liste_des La liste des dés, triée ou non
+ * \param indice L'indice de la case
+ * \return Les points
+ */
+int points_case(const t_des liste_des, int indice) {
+    int points;
+    DEBUT_MESURE();
+
+    points = points_mains[indice_main(liste_des)][indice];
+
+    FIN_MESURE(PHASE_COMBINAISONS);
+    return points;
 }
 
 /**
@@ -743,57 +1810,21 @@ int total_de(t_des liste_des, int valeur) {
  * \param combi_possible La liste des points par combinaison
  */
 void rechercher_combinaisons(t_feuille feuille_joueur, t_des liste_des, t_feuille combi_possible) {
-    int points;
-    
-    // on calcule le nombre de points pour chaque combinaison si elle était choisie
+    const unsigned char *points;    // les points de chaque combinaison pour cette main
+    DEBUT_MESURE();
+
+    // une seule lecture de table donne les points des 13 combinaisons
+    points = points_mains[indice_main(liste_des)];
+
     for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        // si la case de la feuille de marque est déjà remplie,
+        // le choix de la combinaison est impossible
         combi_possible[i] = CASE_VIDE;
+        if (feuille_joueur[i] == CASE_VIDE)
+            combi_possible[i] = points[i];
+    }
 
-        if (feuille_joueur[i] == CASE_VIDE) {
-            // si la case de la feuille de marque est déjà remplie, on ne calcule pas,
-            // le choix de la combinaison étant impossible
-            if (i < 6) {
-                points = total_de(liste_des, i+1);
-            }
-            else {
-                switch (i) {
-                    case I_BRELAN:
-                        points = brelan(liste_des);
-                        break;
-
-                    case I_CARRE:
-                        points = carre(liste_des);
-                        break;
-
-                    case I_FULL_H:
-                        points = full_house(liste_des);
-                        break;
-
-                    case I_P_SUITE:
-                        points = petite_suite(liste_des);
-                        break;
-
-                    case I_G_SUITE:
-                        points = grande_suite(liste_des);
-                        break;
-
-                    case I_YAMS:
-                        points = yams(liste_des);
-                        break;
-                    
-                    case I_CHANCE:
-                        points = chance(liste_des);
-                        break;
-                    
-                    default:
-                        printf("Erreur dans l'indice de la combinaison !\n");
-                        break;
-                }
-            }
-
-            combi_possible[i] = points;
-        }
-    }
+    FIN_MESURE(PHASE_COMBINAISONS);
 }
 
 /**
@@ -866,137 +1897,8090 @@ int combi_vers_indice(combi nom_combi) {
 }
 
 /**
- * \fn void choisir_combinaison(t_feuille feuille_joueur, t_des liste_des)
- * \brief Affiche à l'utilisateur les combinaisons qui lui rapportent des point, puis demande quelle combinaison choisir
- * \param feuille_joueur La feuille de marque du joueur
- * \param liste_des Les dés triés
- */
-void choisir_combinaison(t_feuille feuille_joueur, t_des liste_des) {
-    t_feuille combi_possibles;  // les points rapportés par chaque combinaison si jouée
-    bool zeros;                 // tous les dés sont à zéro (ou CASE_VIDE)
-    char entree[100];           // l'entrée utilisateur volontairement plus grande
-    bool correct;               // l'entrée est correcte
-    int indice;                 // l'indice de la case à compléter
-    combi nom_combinaison;
+ * \fn int dessiner_gagnant(t_ecran *ecran, int ligne, int colonne, nom noms[], t_feuille feuilles[], int nb_joueurs)
+ * \brief Dessine les totaux finaux de chaque joueur sous forme de petit tableau
+ * \param ecran L'écran
+ * \param ligne La ligne du haut du tableau
+ * \param colonne La colonne du bord gauche du tableau
+ * \param noms Le nom de chaque joueur
+ * \param feuilles La feuille de marque de chaque joueur
+ * \param nb_joueurs Le nombre de joueurs
+ * \return La ligne qui suit le tableau
+ */
+int dessiner_gagnant(t_ecran *ecran, int ligne, int colonne, nom noms[], t_feuille feuilles[], int nb_joueurs) {
+    int total, total_sup, total_inf;    // les totaux du joueur
+    int bonus_temp;                     // le bonus temporaire car non compté
 
-    // Etape 1 : Afficher les combinaisons possibles
-    zeros = true;
-    rechercher_combinaisons(feuille_joueur, liste_des, combi_possibles);
+    ecrire_ecran(ecran, ligne++, colonne, "┌────────────────┬─────── Totaux ──────┐");
+    for (int j = 0; j < nb_joueurs; j++) {
+        calculer_totaux(feuilles[j], &total_sup, &total_inf, &total, &bonus_temp);
+        ecrire_ecran(ecran, ligne++, colonne, "│ %-14s │ %3d + %3d = %3d     │", noms[j], total_sup, total_inf, total);
+    }
+    ecrire_ecran(ecran, ligne++, colonne, "└────────────────┴─────────────────────┘");
 
-    for (int i = 0; i < TAILLE_FEUILLE; i++) {
-        if (combi_possibles[i] > 0) {
-            if (zeros) {
-                // si aucune combinaison n'a été affichée
-                zeros = false;
-                printf("Vous pouvez remplir les cases suivantes : \n");
-            }
+    return ligne;
+}
 
-            indice_vers_combi(i, nom_combinaison);
-            printf(" - %s (%d points)\n", nom_combinaison, combi_possibles[i]);
-        }
+/**
+ * \def DECALAGE_GARDES
+ * \brief Position des masques de dés gardés avant le deuxième et le troisième lancer, 5 bits chacun
+ */
+/**
+ * \def DECALAGE_CASE
+ * \brief Position de la case remplie (4 bits)
+ */
+/**
+ * \def DECALAGE_JOUEUR
+ * \brief Position du joueur qui a joué le tour (3 bits)
+ */
+/**
+ * \def DECALAGE_TYPE
+ * \brief Position du type du mot (2 bits) : MOT_TOUR ou MOT_PARTIE
+ */
+#define DECALAGE_GARDES (NB_LANCERS * NB_DES * BITS_DE)
+#define DECALAGE_CASE (DECALAGE_GARDES + (NB_LANCERS - 1) * NB_DES)
+#define DECALAGE_JOUEUR (DECALAGE_CASE + 4)
+#define DECALAGE_TYPE 62
+
+/**
+ * \def MOT_TOUR
+ * \brief Type d'un mot qui décrit un tour : les lancers, les dés gardés et la case remplie
+ */
+/**
+ * \def MOT_PARTIE
+ * \brief Type d'un mot qui commence une partie, avec le nombre de joueurs dans les 4 bits de poids faible
+ */
+/**
+ * \def MAX_MOTS_PARTIE
+ * \brief Nombre maximum de mots d'une partie : son début, puis un mot par tour de chaque joueur
+ */
+/**
+ * \def TAILLE_TAMPON_JOURNAL
+ * \brief Nombre de mots mis en attente avant d'écrire dans le journal
+ */
+#define MOT_TOUR 0
+#define MOT_PARTIE 1
+#define MAX_MOTS_PARTIE (1 + MAX_JOUEURS * TAILLE_FEUILLE)
+#define TAILLE_TAMPON_JOURNAL 4096
+
+/**
+ * \fn uint64_t mot_partie(int nb_joueurs)
+ * \brief Donne le mot qui commence une partie dans le journal
+ * \param nb_joueurs Le nombre de joueurs de la partie
+ * \return Le mot
+ */
+uint64_t mot_partie(int nb_joueurs) {
+    return (uint64_t)MOT_PARTIE << DECALAGE_TYPE | nb_joueurs;
+}
+
+/**
+ * \fn void noter_lancer(uint64_t *mot, int lancer, const t_des des)
+ * \brief Inscrit les dés obtenus à un lancer dans le mot d'un tour
+ * \param mot Le mot du tour
+ * \param lancer Le numéro du lancer, à partir de 0
+ * \param des Les dés après le lancer, gardés compris
+ */
+void noter_lancer(uint64_t *mot, int lancer, const t_des des) {
+    for (int i = 0; i < NB_DES; i++)
+        *mot |= (uint64_t)des[i] << ((lancer * NB_DES + i) * BITS_DE);
+}
+
+/**
+ * \fn void noter_garde(uint64_t *mot, int lancer, int garde)
+ * \brief Inscrit les dés gardés avant un lancer dans le mot d'un tour
+ * \param mot Le mot du tour
+ * \param lancer Le numéro du lancer qui suit, 1 ou 2
+ * \param garde Bit i à 1 si le dé i est gardé
+ */
+void noter_garde(uint64_t *mot, int lancer, int garde) {
+    *mot |= (uint64_t)(garde & GARDER_TOUT) << (DECALAGE_GARDES + (lancer - 1) * NB_DES);
+}
+
+/**
+ * \fn void noter_case(uint64_t *mot, int joueur, int indice)
+ * \brief Inscrit la case remplie, et le joueur qui l'a remplie, dans le mot d'un tour
+ * \param mot Le mot du tour
+ * \param joueur Le joueur
+ * \param indice L'indice de la case
+ */
+void noter_case(uint64_t *mot, int joueur, int indice) {
+    *mot |= (uint64_t)indice << DECALAGE_CASE | (uint64_t)joueur << DECALAGE_JOUEUR;
+}
+
+/**
+ * \fn int type_mot(uint64_t mot)
+ * \brief Donne le type d'un mot du journal
+ * \param mot Le mot
+ * \return MOT_TOUR ou MOT_PARTIE
+ */
+int type_mot(uint64_t mot) {
+    return mot >> DECALAGE_TYPE;
+}
+
+/**
+ * \fn int paquet_mot(uint64_t mot, int lancer)
+ * \brief Donne les dés d'un lancer d'un tour tels qu'ils sont enregistrés, BITS_DE bits par dé
+ * \param mot Le mot du tour
+ * \param lancer Le numéro du lancer, à partir de 0
+ * \return Le lancer, à traduire en main avec indice_paquets
+ */
+int paquet_mot(uint64_t mot, int lancer) {
+    return mot >> (lancer * NB_DES * BITS_DE) & (NB_PAQUETS - 1);
+}
+
+/**
+ * \fn int nb_lancers_mot(uint64_t mot)
+ * \brief Compte les lancers d'un tour, dont les dés sont toujours non nuls
+ * \param mot Le mot du tour
+ * \return Le nombre de lancers, de 1 à NB_LANCERS
+ */
+int nb_lancers_mot(uint64_t mot) {
+    int nb_lancers = 1;
+
+    for (int lancer = 1; lancer < NB_LANCERS; lancer++)
+        nb_lancers += paquet_mot(mot, lancer) != 0;
+
+    return nb_lancers;
+}
+
+/**
+ * \fn void des_mot(uint64_t mot, int lancer, t_des des)
+ * \brief Donne les dés obtenus à un lancer d'un tour
+ * \param mot Le mot du tour
+ * \param lancer Le numéro du lancer, à partir de 0
+ * \param des Les dés en sortie, à 0 si le lancer n'a pas eu lieu
+ */
+void des_mot(uint64_t mot, int lancer, t_des des) {
+    for (int i = 0; i < NB_DES; i++)
+        des[i] = mot >> ((lancer * NB_DES + i) * BITS_DE) & ((1 << BITS_DE) - 1);
+}
+
+/**
+ * \fn int garde_mot(uint64_t mot, int lancer)
+ * \brief Donne les dés gardés avant un lancer d'un tour
+ * \param mot Le mot du tour
+ * \param lancer Le numéro du lancer qui suit, 1 ou 2
+ * \return Bit i à 1 si le dé i est gardé
+ */
+int garde_mot(uint64_t mot, int lancer) {
+    return mot >> (DECALAGE_GARDES + (lancer - 1) * NB_DES) & GARDER_TOUT;
+}
+
+/**
+ * \fn int case_mot(uint64_t mot)
+ * \brief Donne la case remplie à la fin d'un tour
+ * \param mot Le mot du tour
+ * \return L'indice de la case
+ */
+int case_mot(uint64_t mot) {
+    return mot >> DECALAGE_CASE & 0xF;
+}
+
+/**
+ * \fn int joueur_mot(uint64_t mot)
+ * \brief Donne le joueur qui a joué un tour
+ * \param mot Le mot du tour
+ * \return Le joueur, à partir de 0
+ */
+int joueur_mot(uint64_t mot) {
+    return mot >> DECALAGE_JOUEUR & (MAX_JOUEURS - 1);
+}
+
+/**
+ * \struct t_entete_journal
+ * \brief En-tête d'un journal de parties, suivi des mots de 64 bits (petit-boutistes)
+ *
+ * Un journal ne fait que grandir : chaque partie y est ajoutée d'un bloc, son
+ * mot MOT_PARTIE suivi d'un mot par tour joué. Les points ne sont pas
+ * enregistrés, ils se déduisent des derniers dés et de la case.
+ */
+typedef struct {
+    char magie[8];              /**< Signature du fichier, MAGIE_JOURNAL */
+    uint32_t version;           /**< Version du format, VERSION_JOURNAL */
+    uint32_t taille_entete;     /**< Taille de l'en-tête, début des mots */
+} t_entete_journal;
+
+/**
+ * \fn bool entete_journal_valide(const t_entete_journal *entete, off_t taille)
+ * \brief Vérifie l'en-tête d'un journal avant d'en lire les mots
+ *
+ * Les mots doivent commencer après l'en-tête connu, dans le fichier, et sur
+ * une frontière de mot pour être lus en place.
+ * \param entete L'en-tête lu au début du fichier
+ * \param taille La taille du fichier
+ * \return Vrai si l'en-tête est celui d'un journal lisible, faux sinon
+ */
+bool entete_journal_valide(const t_entete_journal *entete, off_t taille) {
+    return memcmp(entete->magie, MAGIE_JOURNAL, sizeof(entete->magie)) == 0
+        && entete->version == VERSION_JOURNAL
+        && entete->taille_entete >= sizeof(t_entete_journal)
+        && entete->taille_entete % sizeof(uint64_t) == 0
+        && entete->taille_entete <= taille;
+}
+
+/**
+ * \struct t_journal
+ * \brief Ecriture d'un journal, avec son tampon
+ *
+ * Le tampon n'est écrit que par parties entières, en un seul write sur un
+ * fichier ouvert en O_APPEND : plusieurs fils, chacun avec son t_journal,
+ * peuvent ajouter leurs parties au même fichier sans les entremêler.
+ */
+typedef struct {
+    int descripteur;                        /**< Fichier du journal, ouvert par ouvrir_ecriture_journal */
+    int nb_mots;                            /**< Nombre de mots en attente */
+    bool erreur;                            /**< Une écriture a échoué, le journal est incomplet */
+    uint64_t mots[TAILLE_TAMPON_JOURNAL];   /**< Mots en attente */
+} t_journal;
+
+/**
+ * \fn int ouvrir_ecriture_journal(const char fichier[])
+ * \brief Ouvre un journal pour y ajouter des parties, en le créant au besoin
+ * \param fichier Le nom du fichier
+ * \return Le descripteur du fichier, ou -1 si le fichier n'est pas un journal intact
+ */
+int ouvrir_ecriture_journal(const char fichier[]) {
+    t_entete_journal entete;
+    struct stat infos;
+    int descripteur;
+    bool correct;
+
+    descripteur = open(fichier, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (descripteur < 0 || fstat(descripteur, &infos) != 0) {
+        fprintf(stderr, "Impossible d'ouvrir %s\n", fichier);
+        if (descripteur >= 0)
+            close(descripteur);
+        return -1;
+    }
+
+    if (infos.st_size == 0) {
+        memset(&entete, 0, sizeof(entete));
+        memcpy(entete.magie, MAGIE_JOURNAL, sizeof(entete.magie));
+        entete.version = VERSION_JOURNAL;
+        entete.taille_entete = sizeof(entete);
+        correct = write(descripteur, &entete, sizeof(entete)) == sizeof(entete);
+    }
+    else {
+        // un journal coupé au milieu d'un mot décalerait toutes les parties ajoutées
+        correct = pread(descripteur, &entete, sizeof(entete), 0) == sizeof(entete);
+        correct = correct && entete_journal_valide(&entete, infos.st_size);
+        correct = correct && (infos.st_size - entete.taille_entete) % sizeof(uint64_t) == 0;
     }
 
-    if (zeros) {
-        // si aucune combinaison n'a été affichée
-        printf("Aucune combinaison ne vous rapporte de points\n");
+    if (!correct) {
+        fprintf(stderr, "%s n'est pas un journal de parties intact\n", fichier);
+        close(descripteur);
+        return -1;
     }
 
-    // Etape 2 : Choisir la combinaison
-    do {
-        printf("Quel est votre choix : ");
-        lire_clavier(entree);
+    return descripteur;
+}
 
-        correct = false;
-        if (strlen(entree) == 0) {
-            printf("Choix vide\n");
-        }
-        else if (strlen(entree) > TAILLE_COMBI-1) {
-            printf("Case inexistante\n");
-        }
-        else {
-            indice = combi_vers_indice(entree);
-            if (indice == -1) {
-                printf("Case inexistante\n");
-            }
-            else if (combi_possibles[indice] == CASE_VIDE) {
-                printf("Vous ne pouvez pas jouer cette case\n");
-            }
-            else {
-                if (combi_possibles[indice] == 0) {
-                    printf("Attention, la combinaison ne\n");
-                    printf("rapporte rien\n");
-                }
-                correct = true;
-                feuille_joueur[indice] = combi_possibles[indice];
-            }
-        }
-    } while(!correct);
+/**
+ * \fn void initialiser_journal(t_journal *journal, int descripteur)
+ * \brief Prépare l'écriture d'un journal, tampon vide
+ * \param journal Le journal
+ * \param descripteur Le fichier donné par ouvrir_ecriture_journal
+ */
+void initialiser_journal(t_journal *journal, int descripteur) {
+    journal->descripteur = descripteur;
+    journal->nb_mots = 0;
+    journal->erreur = false;
 }
 
 /**
- * \fn void afficher_gagnant(nom nom1, nom nom2, t_feuille feuille1, t_feuille feuille2)
- * \brief Affiche les totaux finaux de chaque joueur sous forme de petit tableau
- * \param nom1 Le nom du joueur 1
- * \param nom2 Le nom du joueur 2
- * \param feuille1 La feuille de marque du joueur 1
- * \param feuille2 La feuille de marque du joueur 2
+ * \fn bool vider_journal(t_journal *journal)
+ * \brief Ecrit les mots en attente dans le fichier du journal
+ * \param journal Le journal
+ * \return Vrai si toutes les écritures du journal ont réussi, faux sinon
  */
-void afficher_gagnant(nom nom1, nom nom2, t_feuille feuille1, t_feuille feuille2) {
-    int total_j1, total_sup_j1, total_inf_j1;   // les totaux du joueur 1
-    int total_j2, total_sup_j2, total_inf_j2;   // les totaux du joueur 2
-    int bonus_temp;                             // le bonus temporaire car non compté
+bool vider_journal(t_journal *journal) {
+    const ssize_t TAILLE = journal->nb_mots * sizeof(uint64_t);
 
-    // calcul des totaux
-    calculer_totaux(feuille1, &total_sup_j1, &total_inf_j1, &total_j1, &bonus_temp);
-    calculer_totaux(feuille2, &total_sup_j2, &total_inf_j2, &total_j2, &bonus_temp);
+    if (journal->nb_mots > 0 && write(journal->descripteur, journal->mots, TAILLE) != TAILLE)
+        journal->erreur = true;
+    journal->nb_mots = 0;
 
-    printf("\n");
-    printf("┌────────────────┬─────── Totaux ──────┐\n");
-    printf("│ %-14s │ %3d + %3d = %3d     │\n", nom1, total_sup_j1, total_inf_j1, total_j1);
-    printf("│ %-14s │ %3d + %3d = %3d     │\n", nom2, total_sup_j2, total_inf_j2, total_j2);
-    printf("└────────────────┴─────────────────────┘\n");
+    return !journal->erreur;
 }
 
 /**
- * \fn int main()
- * \brief Fonction principale
- * \return EXIT_SUCCESS
+ * \fn void journaliser_partie(t_journal *journal, const uint64_t mots[], int nb_mots)
+ * \brief Ajoute une partie au journal, écrit quand le tampon est plein
+ * \param journal Le journal
+ * \param mots Les mots de la partie, son mot MOT_PARTIE en premier
+ * \param nb_mots Le nombre de mots, au plus MAX_MOTS_PARTIE
  */
-int main() {
-    t_feuille feuille_j1, feuille_j2;
-    nom joueur1, joueur2;
-    t_des des;
+void journaliser_partie(t_journal *journal, const uint64_t mots[], int nb_mots) {
+    if (journal->nb_mots + nb_mots > TAILLE_TAMPON_JOURNAL)
+        vider_journal(journal);
 
-    initialiser_feuilles(feuille_j1, feuille_j2);
-    recuperer_nom_joueur(1, joueur1);
-    do {
-        recuperer_nom_joueur(2, joueur2);
-        if (strcmp(joueur1, joueur2) == 0) {
-            printf("Nom de joueur déjà pris\n");
-        }
-    } while(strcmp(joueur1, joueur2) == 0);
+    memcpy(&journal->mots[journal->nb_mots], mots, nb_mots * sizeof(uint64_t));
+    journal->nb_mots += nb_mots;
+}
+
+/**
+ * \struct t_lecture_journal
+ * \brief Journal projeté en mémoire pour le relire
+ */
+typedef struct {
+    void *projection;           /**< Début de la projection du fichier */
+    size_t taille;              /**< Taille de la projection */
+    const uint64_t *mots;       /**< Les mots du journal */
+    size_t nb_mots;             /**< Le nombre de mots */
+} t_lecture_journal;
+
+/**
+ * \fn bool ouvrir_lecture_journal(const char fichier[], t_lecture_journal *lecture)
+ * \brief Projette en mémoire un journal, après avoir vérifié son en-tête
+ *
+ * Un dernier mot incomplet, laissé par une écriture interrompue, est ignoré.
+ * \param fichier Le nom du fichier
+ * \param lecture Le journal projeté
+ * \return Vrai si le journal est lisible, faux sinon
+ */
+bool ouvrir_lecture_journal(const char fichier[], t_lecture_journal *lecture) {
+    const t_entete_journal *entete;
+    struct stat infos;
+    int descripteur;
 
-    // On initialise l'horloge pour l'aléatoire
-    srand(time(NULL));
+    descripteur = open(fichier, O_RDONLY);
+    if (descripteur < 0) {
+        fprintf(stderr, "Impossible d'ouvrir %s\n", fichier);
+        return false;
+    }
 
-    for (int i = 0; i < TAILLE_FEUILLE; i++) {
-        // Chaque case de la feuille de marque doit être remplie
-        
-        // Joueur 1
-        afficher_feuille_marque(joueur1, feuille_j1);
-        lancer_des(des);
-        choisir_combinaison(feuille_j1, des);
+    lecture->projection = MAP_FAILED;
+    if (fstat(descripteur, &infos) == 0 && infos.st_size >= (off_t)sizeof(t_entete_journal)) {
+        lecture->taille = infos.st_size;
+        lecture->projection = mmap(NULL, lecture->taille, PROT_READ, MAP_SHARED, descripteur, 0);
+    }
+    close(descripteur);
 
-        // Joueur 2
-        afficher_feuille_marque(joueur2, feuille_j2);
-        lancer_des(des);
-        choisir_combinaison(feuille_j2, des);
+    entete = lecture->projection;
+    if (lecture->projection == MAP_FAILED || !entete_journal_valide(entete, lecture->taille)) {
+        fprintf(stderr, "%s n'est pas un journal de parties\n", fichier);
+        if (lecture->projection != MAP_FAILED)
+            munmap(lecture->projection, lecture->taille);
+        return false;
     }
 
-    afficher_feuille_marque(joueur1, feuille_j1);
-    afficher_feuille_marque(joueur2, feuille_j2);
-    printf("\n");
-    afficher_gagnant(joueur1, joueur2, feuille_j1, feuille_j2);
+    // le journal est lu d'un bout à l'autre : le noyau peut lire en avance
+    madvise(lecture->projection, lecture->taille, MADV_SEQUENTIAL);
+    lecture->mots = (const uint64_t *)((const char *)entete + entete->taille_entete);
+    lecture->nb_mots = (lecture->taille - entete->taille_entete) / sizeof(uint64_t);
+    return true;
+}
+
+/**
+ * \fn void fermer_lecture_journal(t_lecture_journal *lecture)
+ * \brief Libère la projection d'un journal
+ * \param lecture Le journal projeté
+ */
+void fermer_lecture_journal(t_lecture_journal *lecture) {
+    munmap(lecture->projection, lecture->taille);
+    lecture->projection = NULL;
+    lecture->mots = NULL;
+}
+
+/**
+ * \def MAGIE_DIFFUSION
+ * \brief Signature de l'anneau de diffusion en mémoire partagée
+ */
+/**
+ * \def VERSION_DIFFUSION
+ * \brief Version du format de l'anneau, augmentée à chaque changement incompatible
+ */
+/**
+ * \def CAPACITE_DIFFUSION
+ * \brief Nombre d'évènements gardés dans l'anneau, une puissance de 2
+ */
+/**
+ * \def MOTS_EVENEMENT
+ * \brief Nombre de mots de 64 bits d'un évènement dans l'anneau : une case et sa séquence occupent une ligne de cache
+ */
+#define MAGIE_DIFFUSION "YAMSDIF"
+#define VERSION_DIFFUSION 1
+#define CAPACITE_DIFFUSION 65536
+#define MOTS_EVENEMENT 7
+
+/**
+ * \def DIFFUSION_PARTIE
+ * \brief Type d'un évènement qui commence une partie
+ */
+/**
+ * \def DIFFUSION_LANCER
+ * \brief Type d'un évènement de lancer : les dés du joueur au trait
+ */
+/**
+ * \def DIFFUSION_CASE
+ * \brief Type d'un évènement d'inscription : la case remplie et ses points
+ */
+/**
+ * \def DIFFUSION_FIN
+ * \brief Type d'un évènement qui termine une partie
+ */
+#define DIFFUSION_PARTIE 1
+#define DIFFUSION_LANCER 2
+#define DIFFUSION_CASE 3
+#define DIFFUSION_FIN 4
+
+/**
+ * \struct t_evenement_partie
+ * \brief Evènement d'une partie, tel que le lisent les spectateurs
+ */
+typedef struct {
+    uint64_t partie;                /**< Numéro de la partie, attribué par le producteur à partir de 1 */
+    uint8_t type;                   /**< Un DIFFUSION_* */
+    uint8_t nb_joueurs;             /**< Nombre de joueurs de la partie */
+    uint8_t joueur;                 /**< Joueur qui a lancé les dés ou rempli la case, à partir de 0 */
+    uint8_t lancer;                 /**< Numéro du lancer, à partir de 1 */
+    uint8_t indice;                 /**< Case remplie */
+    uint8_t points;                 /**< Points inscrits dans la case */
+    uint8_t des[NB_DES];            /**< Dés du lancer, ou de l'inscription */
+    int16_t totaux[MAX_JOUEURS];    /**< Total de chaque joueur après l'évènement, bonus compris */
+} t_evenement_partie;
+
+/**
+ * \struct t_entete_diffusion
+ * \brief En-tête de l'anneau de diffusion, suivi de CAPACITE_DIFFUSION cases
+ *
+ * Le compteur d'évènements écrits occupe sa propre ligne de cache : les
+ * spectateurs le lisent sans cesse, le producteur l'écrit à chaque évènement.
+ */
+typedef struct {
+    char magie[8];                  /**< Signature, MAGIE_DIFFUSION */
+    uint32_t version;               /**< Version du format, VERSION_DIFFUSION */
+    uint32_t capacite;              /**< Nombre de cases de l'anneau */
+    uint32_t taille_evenement;      /**< sizeof(t_evenement_partie) */
+    uint32_t terminee;              /**< 1 quand le producteur a fermé l'anneau */
+    uint64_t ecrits __attribute__((aligned(64)));   /**< Nombre d'évènements écrits depuis l'ouverture */
+} __attribute__((aligned(64))) t_entete_diffusion;
+
+/**
+ * \struct t_case_diffusion
+ * \brief Case de l'anneau, protégée par un compteur de séquence
+ *
+ * La séquence vaut 2n + 2 quand l'évènement n y est entièrement écrit, et
+ * reste impaire pendant son écriture : un lecteur qui trouve une autre
+ * séquence après sa copie sait que la case a été réécrite sous ses yeux.
+ */
+typedef struct {
+    uint64_t sequence;                  /**< Séquence de l'évènement écrit */
+    uint64_t mots[MOTS_EVENEMENT];      /**< L'évènement, mot à mot */
+} __attribute__((aligned(64))) t_case_diffusion;
+
+/**
+ * \struct t_diffusion
+ * \brief Anneau projeté, côté producteur ou côté spectateur
+ */
+typedef struct {
+    t_entete_diffusion *entete;     /**< L'en-tête projeté */
+    t_case_diffusion *cases;        /**< Les cases projetées */
+    size_t taille;                  /**< Taille de la projection */
+    uint64_t position;              /**< Prochain évènement à écrire ou à lire */
+    uint64_t nb_parties;            /**< Parties numérotées par le producteur */
+    char nom[NAME_MAX];             /**< Nom de l'objet en mémoire partagée, commençant par / */
+} t_diffusion;
+
+/**
+ * \var diffusion
+ * \brief Anneau où les parties menées par t_machine_partie publient leurs évènements, NULL sans spectateurs
+ */
+t_diffusion *diffusion = NULL;
+
+/**
+ * \fn void nommer_diffusion(const char nom[], t_diffusion *anneau)
+ * \brief Donne à l'objet en mémoire partagée le nom choisi, précédé d'un / s'il n'en a pas
+ * \param nom Le nom choisi
+ * \param anneau L'anneau dont le nom est rempli
+ */
+void nommer_diffusion(const char nom[], t_diffusion *anneau) {
+    snprintf(anneau->nom, sizeof(anneau->nom), "%s%s", nom[0] == '/' ? "" : "/", nom);
+}
+
+/**
+ * \fn bool ouvrir_diffusion(const char nom[])
+ * \brief Crée l'anneau de diffusion, en remplaçant celui d'un producteur précédent
+ *
+ * Les spectateurs d'un anneau remplacé gardent leur projection, sans jamais
+ * rien y lire de nouveau.
+ * \param nom Le nom de l'objet en mémoire partagée
+ * \return Vrai si l'anneau est prêt, faux sinon
+ */
+bool ouvrir_diffusion(const char nom[]) {
+    t_diffusion *anneau = calloc(1, sizeof(t_diffusion));
+    void *projection = MAP_FAILED;
+    int descripteur;
+
+    nommer_diffusion(nom, anneau);
+    anneau->taille = sizeof(t_entete_diffusion) + CAPACITE_DIFFUSION * sizeof(t_case_diffusion);
+
+    shm_unlink(anneau->nom);
+    descripteur = shm_open(anneau->nom, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (descripteur >= 0) {
+        if (ftruncate(descripteur, anneau->taille) == 0)
+            projection = mmap(NULL, anneau->taille, PROT_READ | PROT_WRITE, MAP_SHARED, descripteur, 0);
+        close(descripteur);
+    }
+
+    if (projection == MAP_FAILED) {
+        fprintf(stderr, "Impossible de créer la diffusion %s\n", anneau->nom);
+        if (descripteur >= 0)
+            shm_unlink(anneau->nom);
+        free(anneau);
+        return false;
+    }
+
+    // la mémoire arrive à zéro : séquences et compteur sont prêts, la signature vient en dernier
+    anneau->entete = projection;
+    anneau->cases = (t_case_diffusion *)(anneau->entete + 1);
+    anneau->entete->version = VERSION_DIFFUSION;
+    anneau->entete->capacite = CAPACITE_DIFFUSION;
+    anneau->entete->taille_evenement = sizeof(t_evenement_partie);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(anneau->entete->magie, MAGIE_DIFFUSION, sizeof(anneau->entete->magie));
+
+    diffusion = anneau;
+    return true;
+}
+
+/**
+ * \fn void fermer_diffusion()
+ * \brief Signale aux spectateurs la fin de la diffusion et supprime l'anneau
+ */
+void fermer_diffusion() {
+    if (diffusion == NULL)
+        return;
+
+    __atomic_store_n(&diffusion->entete->terminee, 1, __ATOMIC_RELEASE);
+    munmap(diffusion->entete, diffusion->taille);
+    shm_unlink(diffusion->nom);
+    free(diffusion);
+    diffusion = NULL;
+}
+
+/**
+ * \fn void publier_evenement(t_diffusion *anneau, const t_evenement_partie *evenement)
+ * \brief Ecrit un évènement dans la case suivante de l'anneau, sans jamais attendre les spectateurs
+ *
+ * Le plus ancien évènement est écrasé : un spectateur trop lent le
+ * découvre à sa lecture, au lieu de ralentir la partie.
+ * \param anneau L'anneau, côté producteur
+ * \param evenement L'évènement
+ */
+void publier_evenement(t_diffusion *anneau, const t_evenement_partie *evenement) {
+    t_case_diffusion *place = &anneau->cases[anneau->position & (CAPACITE_DIFFUSION - 1)];
+    uint64_t mots[MOTS_EVENEMENT] = {0};
+
+    memcpy(mots, evenement, sizeof(*evenement));
+
+    __atomic_store_n(&place->sequence, 2 * anneau->position + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (int i = 0; i < MOTS_EVENEMENT; i++)
+        __atomic_store_n(&place->mots[i], mots[i], __ATOMIC_RELAXED);
+    __atomic_store_n(&place->sequence, 2 * anneau->position + 2, __ATOMIC_RELEASE);
+
+    anneau->position++;
+    __atomic_store_n(&anneau->entete->ecrits, anneau->position, __ATOMIC_RELEASE);
+}
+
+/**
+ * \enum t_lecture_diffusion
+ * \brief Résultat d'une lecture de l'anneau par un spectateur
+ */
+typedef enum {
+    LECTURE_EVENEMENT,  /**< Un évènement a été lu */
+    LECTURE_VIDE,       /**< Le spectateur a lu tous les évènements écrits */
+    LECTURE_TERMINEE    /**< Tout est lu, et le producteur a fermé l'anneau */
+} t_lecture_diffusion;
+
+/**
+ * \fn bool ouvrir_spectateur(const char nom[], t_diffusion *anneau)
+ * \brief Projette en lecture seule l'anneau d'un producteur, pour en lire les prochains évènements
+ *
+ * Un spectateur n'écrit rien dans l'anneau : le producteur ignore combien
+ * de spectateurs le lisent, et à quel rythme.
+ * \param nom Le nom de l'objet en mémoire partagée
+ * \param anneau L'anneau projeté, positionné après le dernier évènement écrit
+ * \return Vrai si l'anneau est lisible, faux sinon
+ */
+bool ouvrir_spectateur(const char nom[], t_diffusion *anneau) {
+    struct stat infos;
+    void *projection = MAP_FAILED;
+    int descripteur;
+    bool correct;
+
+    memset(anneau, 0, sizeof(*anneau));
+    nommer_diffusion(nom, anneau);
+    anneau->taille = sizeof(t_entete_diffusion) + CAPACITE_DIFFUSION * sizeof(t_case_diffusion);
+
+    descripteur = shm_open(anneau->nom, O_RDONLY, 0);
+    if (descripteur < 0) {
+        fprintf(stderr, "Aucune diffusion %s\n", anneau->nom);
+        return false;
+    }
+    if (fstat(descripteur, &infos) == 0 && (size_t)infos.st_size == anneau->taille)
+        projection = mmap(NULL, anneau->taille, PROT_READ, MAP_SHARED, descripteur, 0);
+    close(descripteur);
+
+    if (projection == MAP_FAILED) {
+        fprintf(stderr, "%s n'est pas une diffusion de parties\n", anneau->nom);
+        return false;
+    }
+
+    anneau->entete = projection;
+    anneau->cases = (t_case_diffusion *)(anneau->entete + 1);
+    correct = memcmp(anneau->entete->magie, MAGIE_DIFFUSION, sizeof(anneau->entete->magie)) == 0;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    correct = correct && anneau->entete->version == VERSION_DIFFUSION;
+    correct = correct && anneau->entete->capacite == CAPACITE_DIFFUSION;
+    correct = correct && anneau->entete->taille_evenement == sizeof(t_evenement_partie);
+
+    if (!correct) {
+        fprintf(stderr, "%s est incomplète ou d'une version incompatible\n", anneau->nom);
+        munmap(projection, anneau->taille);
+        return false;
+    }
+
+    anneau->position = __atomic_load_n(&anneau->entete->ecrits, __ATOMIC_ACQUIRE);
+    return true;
+}
+
+/**
+ * \fn t_lecture_diffusion lire_diffusion(t_diffusion *anneau, t_evenement_partie *evenement, uint64_t *perdus)
+ * \brief Lit l'évènement suivant de l'anneau, sans attendre
+ *
+ * Un spectateur dépassé par le producteur saute aux plus anciens évènements
+ * encore dans l'anneau, et compte ceux qu'il a perdus.
+ * \param anneau L'anneau, côté spectateur
+ * \param evenement L'évènement lu
+ * \param perdus Le nombre d'évènements écrasés avant d'avoir été lus, sautés par cette lecture
+ * \return LECTURE_EVENEMENT si un évènement est lu
+ */
+t_lecture_diffusion lire_diffusion(t_diffusion *anneau, t_evenement_partie *evenement, uint64_t *perdus) {
+    const t_case_diffusion *place;
+    uint64_t mots[MOTS_EVENEMENT];
+    uint64_t ecrits, sequence;
+    bool terminee;
+
+    *perdus = 0;
+    while (true) {
+        // la fin est lue avant le compteur, pour ne pas manquer les derniers évènements
+        terminee = __atomic_load_n(&anneau->entete->terminee, __ATOMIC_ACQUIRE);
+        ecrits = __atomic_load_n(&anneau->entete->ecrits, __ATOMIC_ACQUIRE);
+        if (anneau->position == ecrits)
+            return terminee ? LECTURE_TERMINEE : LECTURE_VIDE;
+
+        // la case de l'évènement ecrits - CAPACITE_DIFFUSION est peut-être déjà en cours d'écriture
+        if (ecrits - anneau->position >= CAPACITE_DIFFUSION) {
+            *perdus += ecrits - CAPACITE_DIFFUSION + 1 - anneau->position;
+            anneau->position = ecrits - CAPACITE_DIFFUSION + 1;
+        }
+
+        place = &anneau->cases[anneau->position & (CAPACITE_DIFFUSION - 1)];
+        sequence = __atomic_load_n(&place->sequence, __ATOMIC_ACQUIRE);
+        for (int i = 0; i < MOTS_EVENEMENT; i++)
+            mots[i] = __atomic_load_n(&place->mots[i], __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (sequence == 2 * anneau->position + 2 && __atomic_load_n(&place->sequence, __ATOMIC_RELAXED) == sequence) {
+            memcpy(evenement, mots, sizeof(*evenement));
+            anneau->position++;
+            return LECTURE_EVENEMENT;
+        }
+        // la case a été réécrite pendant la copie : le compteur relu dira combien d'évènements sont perdus
+    }
+}
+
+/**
+ * \fn void fermer_spectateur(t_diffusion *anneau)
+ * \brief Libère la projection d'un spectateur
+ * \param anneau L'anneau, côté spectateur
+ */
+void fermer_spectateur(t_diffusion *anneau) {
+    munmap(anneau->entete, anneau->taille);
+    anneau->entete = NULL;
+    anneau->cases = NULL;
+}
+
+/**
+ * \def TAILLE_MESSAGE
+ * \brief Taille du texte affiché avant les dés ou la feuille de marque
+ */
+/**
+ * \def TAILLE_INVITE
+ * \brief Taille du texte affiché après, qui se termine par la question posée
+ */
+/**
+ * \def TAILLE_ENTREE
+ * \brief Longueur maximale d'une ligne d'entrée prise en compte
+ */
+#define TAILLE_MESSAGE 128
+#define TAILLE_INVITE 768
+#define TAILLE_ENTREE 100
+
+/**
+ * \def EVENEMENT_NOUVEAU_TOUR
+ * \brief Un joueur commence son tour : afficher sa feuille de marque
+ */
+/**
+ * \def EVENEMENT_DES_LANCES
+ * \brief Les dés viennent d'être lancés : les afficher
+ */
+/**
+ * \def EVENEMENT_FIN_PARTIE
+ * \brief La dernière case vient d'être remplie
+ */
+#define EVENEMENT_NOUVEAU_TOUR 1
+#define EVENEMENT_DES_LANCES 2
+#define EVENEMENT_FIN_PARTIE 4
+
+/**
+ * \enum t_etat_machine
+ * \brief Ce qu'attend une partie pour avancer
+ */
+typedef enum {
+    ATTENTE_LANCER,     /**< N'importe quelle ligne lance les dés */
+    ATTENTE_RELANCE,    /**< "oui" ou "non" pour relancer les dés */
+    ATTENTE_GARDE,      /**< Un dé à relancer par ligne, puis "fin" */
+    ATTENTE_CASE,       /**< Le nom de la case à remplir */
+    PARTIE_TERMINEE     /**< Plus aucune entrée n'est attendue */
+} t_etat_machine;
+
+/**
+ * \struct t_machine_partie
+ * \brief Partie menée entrée par entrée, sans jamais attendre le clavier
+ *
+ * Tout l'état d'une partie tient dans cette structure (un peu plus de 200 octets) :
+ * une seule boucle d'évènements peut ainsi mener des milliers de parties, en
+ * passant à avancer_machine chaque ligne reçue du joueur concerné.
+ */
+typedef struct {
+    t_alea alea;                                /**< Générateur de la partie */
+    t_table_joueurs table;                      /**< Feuilles des joueurs */
+    uint8_t des[NB_DES];                        /**< Dés du lancer en cours */
+    uint8_t a_relancer;                         /**< Bit i à 1 si le dé i doit être relancé */
+    uint8_t lancer;                             /**< Nombre de lancers faits ce tour */
+    uint8_t joueur;                             /**< Joueur dont c'est le tour */
+    uint8_t tour;                               /**< Nombre de tours complets joués */
+    uint8_t etat;                               /**< Un t_etat_machine */
+    uint64_t mot_tour;                          /**< Mot du tour en cours pour le journal, ou du dernier tour joué jusqu'au lancer suivant */
+    uint64_t partie;                            /**< Numéro de la partie dans l'anneau de diffusion */
+} t_machine_partie;
+
+/**
+ * \struct t_sortie_machine
+ * \brief Ce qu'il faut montrer au joueur après une entrée
+ *
+ * Les dés et la feuille de marque ne sont pas mis en forme ici : les
+ * évènements indiquent à l'appelant qu'il doit les afficher, entre le
+ * message et l'invite.
+ */
+typedef struct {
+    int evenements;                 /**< Combinaison de EVENEMENT_* */
+    char message[TAILLE_MESSAGE];   /**< Réponse à l'entrée, erreurs comprises */
+    char invite[TAILLE_INVITE];     /**< Question posée pour l'entrée suivante */
+} t_sortie_machine;
+
+/**
+ * \fn void diffuser_machine(t_machine_partie *machine, int type, int joueur, int indice, int points)
+ * \brief Publie un évènement d'une partie dans l'anneau de diffusion, s'il y en a un
+ * \param machine La partie, après l'évènement
+ * \param type Un DIFFUSION_*
+ * \param joueur Le joueur qui a lancé les dés ou rempli la case
+ * \param indice La case remplie, pour DIFFUSION_CASE
+ * \param points Les points inscrits, pour DIFFUSION_CASE
+ */
+void diffuser_machine(t_machine_partie *machine, int type, int joueur, int indice, int points) {
+    t_evenement_partie evenement;
+    int totaux[MAX_JOUEURS];
+
+    if (diffusion == NULL)
+        return;
+
+    // une partie reçoit son numéro à son premier évènement
+    if (type == DIFFUSION_PARTIE)
+        machine->partie = ++diffusion->nb_parties;
+
+    memset(&evenement, 0, sizeof(evenement));
+    evenement.partie = machine->partie;
+    evenement.type = type;
+    evenement.nb_joueurs = machine->table.nb_joueurs;
+    evenement.joueur = joueur;
+    evenement.lancer = machine->lancer;
+    evenement.indice = indice;
+    evenement.points = points;
+    memcpy(evenement.des, machine->des, sizeof(evenement.des));
+    totaux_table(&machine->table, totaux);
+    for (int j = 0; j < machine->table.nb_joueurs; j++)
+        evenement.totaux[j] = totaux[j];
+
+    publier_evenement(diffusion, &evenement);
+}
+
+/**
+ * \fn void ajouter_texte(char texte[], int taille, const char format[], ...)
+ * \brief Ajoute un texte formaté à la fin d'une chaine, sans dépasser sa taille
+ * \param texte La chaine à compléter
+ * \param taille La taille de la chaine
+ * \param format Le format, comme pour printf
+ */
+void ajouter_texte(char texte[], int taille, const char format[], ...) {
+    int longueur = strlen(texte);
+    va_list arguments;
+
+    va_start(arguments, format);
+    vsnprintf(texte + longueur, taille - longueur, format, arguments);
+    va_end(arguments);
+}
+
+/**
+ * \fn void des_machine(const t_machine_partie *machine, t_des des)
+ * \brief Copie les dés du lancer en cours d'une partie
+ * \param machine La partie
+ * \param des Les dés en sortie
+ */
+void des_machine(const t_machine_partie *machine, t_des des) {
+    for (int i = 0; i < NB_DES; i++)
+        des[i] = machine->des[i];
+}
+
+/**
+ * \fn void lancer_des_machine(t_machine_partie *machine)
+ * \brief Lance les dés à relancer ; après le dernier lancer, la partie attend la case
+ * \param machine La partie
+ */
+void lancer_des_machine(t_machine_partie *machine) {
+    t_des des;
+
+    if (machine->lancer == 0)
+        machine->mot_tour = 0;
+    else
+        noter_garde(&machine->mot_tour, machine->lancer, ~machine->a_relancer);
+
+    DEBUT_MESURE();
+    for (int i = 0; i < NB_DES; i++) {
+        if (machine->a_relancer & (1 << i))
+            machine->des[i] = lancer_de(&machine->alea);
+    }
+    FIN_MESURE(PHASE_LANCER);
+    des_machine(machine, des);
+    noter_lancer(&machine->mot_tour, machine->lancer, des);
+    machine->lancer++;
+    diffuser_machine(machine, DIFFUSION_LANCER, machine->joueur, 0, 0);
+
+    machine->etat = machine->lancer < NB_LANCERS ? ATTENTE_RELANCE : ATTENTE_CASE;
+}
+
+/**
+ * \fn void commencer_tour_machine(t_machine_partie *machine)
+ * \brief Prépare le tour du joueur courant, qui doit d'abord lancer les dés
+ * \param machine La partie
+ */
+void commencer_tour_machine(t_machine_partie *machine) {
+    machine->a_relancer = GARDER_TOUT;
+    machine->lancer = 0;
+    machine->etat = ATTENTE_LANCER;
+}
+
+/**
+ * \fn int remplir_case_machine(t_machine_partie *machine, int indice)
+ * \brief Remplit une case libre avec les dés en cours, puis passe au joueur suivant ou termine la partie
+ * \param machine La partie
+ * \param indice L'indice de la case, qui doit être libre
+ * \return Les points inscrits
+ */
+int remplir_case_machine(t_machine_partie *machine, int indice) {
+    t_des des;
+    int points;
+
+    des_machine(machine, des);
+    points = points_case(des, indice);
+    inscrire_table(&machine->table, machine->joueur, indice, points);
+    noter_case(&machine->mot_tour, machine->joueur, indice);
+    COMPTER_TOUR(indice, points, machine->lancer);
+    diffuser_machine(machine, DIFFUSION_CASE, machine->joueur, indice, points);
+
+    // le tour est complet quand le dernier joueur a joué
+    machine->joueur = (machine->joueur + 1) % machine->table.nb_joueurs;
+    if (machine->joueur == 0)
+        machine->tour++;
+
+    if (machine->tour == TAILLE_FEUILLE) {
+        machine->etat = PARTIE_TERMINEE;
+        diffuser_machine(machine, DIFFUSION_FIN, 0, 0, 0);
+    }
+    else {
+        commencer_tour_machine(machine);
+    }
+
+    return points;
+}
+
+/**
+ * \fn void proposer_cases(t_machine_partie *machine, t_sortie_machine *sortie)
+ * \brief Trie les dés définitifs, liste les cases qui rapportent des points et demande laquelle remplir
+ * \param machine La partie
+ * \param sortie Ce qu'il faut montrer au joueur
+ */
+void proposer_cases(t_machine_partie *machine, t_sortie_machine *sortie) {
+    const unsigned char *points;
+    t_des des;
+    combi nom_combinaison;
+    bool zeros = true;
+
+    // à ce stade, les dés sont définitifs et ne sont plus affichés
+    des_machine(machine, des);
+    trier_des(des);
+    for (int i = 0; i < NB_DES; i++)
+        machine->des[i] = des[i];
+
+    points = points_mains[indice_main(des)];
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        if (case_libre_table(&machine->table, machine->joueur, i) && points[i] > 0) {
+            if (zeros) {
+                zeros = false;
+                ajouter_texte(sortie->invite, TAILLE_INVITE, "Vous pouvez remplir les cases suivantes : \n");
+            }
+
+            indice_vers_combi(i, nom_combinaison);
+            ajouter_texte(sortie->invite, TAILLE_INVITE, " - %s (%d points)\n", nom_combinaison, points[i]);
+        }
+    }
+
+    if (zeros)
+        ajouter_texte(sortie->invite, TAILLE_INVITE, "Aucune combinaison ne vous rapporte de points\n");
+
+    ajouter_texte(sortie->invite, TAILLE_INVITE, "Quel est votre choix : ");
+    machine->etat = ATTENTE_CASE;
+}
+
+/**
+ * \fn void lancer_machine(t_machine_partie *machine, t_sortie_machine *sortie)
+ * \brief Lance les dés à relancer, puis propose une relance ou, au dernier lancer, les cases
+ * \param machine La partie
+ * \param sortie Ce qu'il faut montrer au joueur
+ */
+void lancer_machine(t_machine_partie *machine, t_sortie_machine *sortie) {
+    lancer_des_machine(machine);
+
+    ajouter_texte(sortie->message, TAILLE_MESSAGE, "Les dés sont lancés, vous obtenez : \n");
+    sortie->evenements |= EVENEMENT_DES_LANCES;
+
+    // Ne pas demander à relancer au dernier lancer
+    if (machine->etat == ATTENTE_RELANCE)
+        ajouter_texte(sortie->invite, TAILLE_INVITE, "Souhaitez-vous relancer les dés ?\n(oui / non) : ");
+    else
+        proposer_cases(machine, sortie);
+}
+
+/**
+ * \fn void commencer_tour(t_machine_partie *machine, t_sortie_machine *sortie)
+ * \brief Prépare le tour du joueur courant, qui doit d'abord lancer les dés
+ * \param machine La partie
+ * \param sortie Ce qu'il faut montrer au joueur
+ */
+void commencer_tour(t_machine_partie *machine, t_sortie_machine *sortie) {
+    commencer_tour_machine(machine);
+
+    sortie->evenements |= EVENEMENT_NOUVEAU_TOUR;
+    ajouter_texte(sortie->invite, TAILLE_INVITE, "Appuyez sur entrée pour lancer les dés... ");
+}
+
+/**
+ * \fn void initialiser_machine(t_machine_partie *machine, uint64_t graine, int nb_joueurs, t_sortie_machine *sortie)
+ * \brief Commence une partie, au tour du premier joueur
+ * \param machine La partie
+ * \param graine La graine du générateur de la partie
+ * \param nb_joueurs Le nombre de joueurs, au plus MAX_JOUEURS
+ * \param sortie Ce qu'il faut montrer au joueur, NULL si la partie n'est pas affichée
+ */
+void initialiser_machine(t_machine_partie *machine, uint64_t graine, int nb_joueurs, t_sortie_machine *sortie) {
+    initialiser_alea(&machine->alea, graine);
+    initialiser_table_joueurs(&machine->table, nb_joueurs);
+    memset(machine->des, 0, sizeof(machine->des));
+    machine->joueur = 0;
+    machine->tour = 0;
+    machine->mot_tour = 0;
+    commencer_tour_machine(machine);
+    diffuser_machine(machine, DIFFUSION_PARTIE, 0, 0, 0);
+
+    if (sortie != NULL) {
+        sortie->evenements = 0;
+        sortie->message[0] = '\0';
+        sortie->invite[0] = '\0';
+        commencer_tour(machine, sortie);
+    }
+}
+
+/**
+ * \fn void repondre_relance(t_machine_partie *machine, const char entree[], t_sortie_machine *sortie)
+ * \brief Traite la réponse à "Souhaitez-vous relancer les dés ?"
+ * \param machine La partie
+ * \param entree La réponse, en minuscules
+ * \param sortie Ce qu'il faut montrer au joueur
+ */
+void repondre_relance(t_machine_partie *machine, const char entree[], t_sortie_machine *sortie) {
+    if (strcmp(entree, "oui") == 0) {
+        machine->a_relancer = 0;
+        ajouter_texte(sortie->message, TAILLE_MESSAGE, "\n");
+        ajouter_texte(sortie->invite, TAILLE_INVITE, "Veuillez entrer les dés à relancer, un\n");
+        ajouter_texte(sortie->invite, TAILLE_INVITE, "dé par ligne, puis terminez par \"fin\"\n(1, 2...) ");
+        machine->etat = ATTENTE_GARDE;
+    }
+    else if (strcmp(entree, "non") == 0) {
+        ajouter_texte(sortie->message, TAILLE_MESSAGE, "\n\n");
+        proposer_cases(machine, sortie);
+    }
+    else {
+        if (entree[0] == '\0')
+            ajouter_texte(sortie->message, TAILLE_MESSAGE, "Choix vide\n\n");
+        else
+            ajouter_texte(sortie->message, TAILLE_MESSAGE, "Veuillez saisir \"oui\" ou \"non\"\n\n");
+        ajouter_texte(sortie->invite, TAILLE_INVITE, "Souhaitez-vous relancer les dés ?\n(oui / non) : ");
+    }
+}
+
+/**
+ * \fn void repondre_garde(t_machine_partie *machine, const char entree[], t_sortie_machine *sortie)
+ * \brief Traite un numéro de dé à relancer, ou "fin" pour relancer les dés choisis
+ * \param machine La partie
+ * \param entree L'entrée, en minuscules
+ * \param sortie Ce qu'il faut montrer au joueur
+ */
+void repondre_garde(t_machine_partie *machine, const char entree[], t_sortie_machine *sortie) {
+    int indice_de;
+
+    if (strcmp(entree, "fin") == 0) {
+        ajouter_texte(sortie->message, TAILLE_MESSAGE, "\n");
+        lancer_machine(machine, sortie);
+        return;
+    }
+
+    if (entree[0] == '\0') {
+        ajouter_texte(sortie->message, TAILLE_MESSAGE, "Choix vide\n");
+    }
+    // vérifier qu'il s'agit d'un chiffre entre 1 et 5
+    else if (strlen(entree) != 1 || entree[0] < '1' || entree[0] > '0' + NB_DES) {
+        ajouter_texte(sortie->message, TAILLE_MESSAGE, "Nom de dé incorrect\n");
+    }
+    else {
+        indice_de = entree[0] - '1';
+        if (machine->a_relancer & (1 << indice_de))
+            ajouter_texte(sortie->message, TAILLE_MESSAGE, "Dé déjà saisi\n");
+        else
+            machine->a_relancer |= 1 << indice_de;
+    }
+
+    ajouter_texte(sortie->invite, TAILLE_INVITE, "(1, 2...) ");
+}
+
+/**
+ * \fn void repondre_case(t_machine_partie *machine, const char entree[], t_sortie_machine *sortie)
+ * \brief Remplit la case choisie, puis passe au joueur suivant ou termine la partie
+ * \param machine La partie
+ * \param entree Le nom de la case, en minuscules
+ * \param sortie Ce qu'il faut montrer au joueur
+ */
+void repondre_case(t_machine_partie *machine, const char entree[], t_sortie_machine *sortie) {
+    combi nom_combinaison;
+    int indice, points;
+
+    indice = -1;
+    if (strlen(entree) == 0) {
+        ajouter_texte(sortie->message, TAILLE_MESSAGE, "Choix vide\n");
+    }
+    else if (strlen(entree) > TAILLE_COMBI-1) {
+        ajouter_texte(sortie->message, TAILLE_MESSAGE, "Case inexistante\n");
+    }
+    else {
+        strcpy(nom_combinaison, entree);
+        indice = combi_vers_indice(nom_combinaison);
+        if (indice == -1) {
+            ajouter_texte(sortie->message, TAILLE_MESSAGE, "Case inexistante\n");
+        }
+        else if (!case_libre_table(&machine->table, machine->joueur, indice)) {
+            ajouter_texte(sortie->message, TAILLE_MESSAGE, "Vous ne pouvez pas jouer cette case\n");
+            indice = -1;
+        }
+    }
+
+    if (indice == -1) {
+        ajouter_texte(sortie->invite, TAILLE_INVITE, "Quel est votre choix : ");
+        return;
+    }
+
+    points = remplir_case_machine(machine, indice);
+    if (points == 0)
+        ajouter_texte(sortie->message, TAILLE_MESSAGE, "Attention, la combinaison ne\nrapporte rien\n");
+
+    if (machine->etat == PARTIE_TERMINEE) {
+        sortie->evenements |= EVENEMENT_FIN_PARTIE;
+    }
+    else {
+        sortie->evenements |= EVENEMENT_NOUVEAU_TOUR;
+        ajouter_texte(sortie->invite, TAILLE_INVITE, "Appuyez sur entrée pour lancer les dés... ");
+    }
+}
+
+/**
+ * \fn t_etat_machine avancer_machine(t_machine_partie *machine, const char entree[], t_sortie_machine *sortie)
+ * \brief Fait avancer une partie d'une ligne d'entrée, sans jamais bloquer
+ *
+ * Une entrée incorrecte laisse la partie dans le même état, avec le message
+ * d'erreur et la même question.
+ * \param machine La partie
+ * \param entree La ligne entrée par le joueur dont c'est le tour, sans le retour à la ligne
+ * \param sortie Ce qu'il faut montrer au joueur, remplacé à chaque appel
+ * \return Ce qu'attend maintenant la partie
+ */
+t_etat_machine avancer_machine(t_machine_partie *machine, const char entree[], t_sortie_machine *sortie) {
+    char minuscules[TAILLE_ENTREE];
+    int i;
+
+    sortie->evenements = 0;
+    sortie->message[0] = '\0';
+    sortie->invite[0] = '\0';
+
+    // on met le texte en minuscules pour accepter toutes les écritures (OUI, Fin...)
+    for (i = 0; entree[i] != '\0' && i < TAILLE_ENTREE - 1; i++)
+        minuscules[i] = tolower((unsigned char)entree[i]);
+    minuscules[i] = '\0';
+
+    switch (machine->etat) {
+        case ATTENTE_LANCER:
+            ajouter_texte(sortie->message, TAILLE_MESSAGE, "\n");
+            lancer_machine(machine, sortie);
+            break;
+        case ATTENTE_RELANCE:
+            repondre_relance(machine, minuscules, sortie);
+            break;
+        case ATTENTE_GARDE:
+            repondre_garde(machine, minuscules, sortie);
+            break;
+        case ATTENTE_CASE:
+            repondre_case(machine, minuscules, sortie);
+            break;
+        default:
+            break;
+    }
+
+    return machine->etat;
+}
+
+/**
+ * \fn int code_comptes(const int comptes[6])
+ * \brief Calcule le code d'un ensemble de dés à partir du nombre de dés de chaque face
+ * \param comptes Le nombre de dés valant 1, 2... 6
+ * \return Le code, lu en base 6, compris entre 0 et NB_CODES_COMPTES - 1
+ */
+int code_comptes(const int comptes[6]) {
+    int code;
+
+    code = 0;
+    for (int face = 5; face >= 0; face--)
+        code = code * 6 + comptes[face];
+
+    return code;
+}
+
+/**
+ * \fn int indice_garde(const t_des des, int garde)
+ * \brief Retrouve l'indice des dés gardés parmi les NB_GARDES ensembles possibles
+ * \param des La liste des dés, triée ou non
+ * \param garde Le masque des dés gardés
+ * \return L'indice de l'ensemble des dés gardés
+ */
+int indice_garde(const t_des des, int garde) {
+    int comptes[6] = {0};
+
+    for (int i = 0; i < NB_DES; i++) {
+        if (garde & (1 << i))
+            comptes[des[i] - 1]++;
+    }
+
+    return indice_gardes[code_comptes(comptes)];
+}
+
+/**
+ * \fn void gardes_des(const t_des des, int gardes[1 << NB_DES])
+ * \brief Retrouve l'indice des dés gardés pour chacun des 32 masques, en une seule passe
+ *
+ * Le code d'un masque est celui du masque sans son premier dé, plus le poids de ce dé.
+ * \param des La liste des dés, triée ou non
+ * \param gardes L'indice des dés gardés pour chaque masque
+ */
+void gardes_des(const t_des des, int gardes[1 << NB_DES]) {
+    const int POIDS[6] = {1, 6, 36, 216, 1296, 7776};   // 6 puissance (face - 1)
+    int codes[1 << NB_DES];
+
+    codes[0] = 0;
+    gardes[0] = 0;
+    for (int garde = 1; garde <= GARDER_TOUT; garde++) {
+        codes[garde] = codes[garde & (garde - 1)] + POIDS[des[__builtin_ctz(garde)] - 1];
+        gardes[garde] = indice_gardes[codes[garde]];
+    }
+}
+
+/**
+ * \fn void initialiser_transitions()
+ * \brief Construit les probabilités de passage de chaque ensemble de dés gardés vers chaque main
+ *
+ * Les dés gardés ne dépendent pas de leur ordre : seuls 462 ensembles existent, de 0 à 5 dés.
+ * Les dés relancés forment eux-mêmes l'un de ces ensembles, dont la probabilité ne
+ * dépend que de lui : elle est partagée par toutes les gardes de même taille, et seule
+ * la main obtenue est enregistrée pour chaque couple (garde, issue). Pour une taille
+ * donnée, les cibles sont rangées issue par issue, les gardes se suivant : une issue
+ * met à jour toutes les gardes de la taille dans une boucle contiguë.
+ */
+void initialiser_transitions() {
+    const int FACTORIELLE[NB_DES + 1] = {1, 1, 2, 6, 24, 120};
+    int comptes[NB_GARDES][6];      // le nombre de dés de chaque face de chaque garde
+    int indice, nb_transitions, relances, diviseur, arrangements;
+    int total[6];
+    t_des des;
+
+    // Etape 1 : on numérote les gardes par taille croissante, la garde vide en premier,
+    // avec la probabilité de les obtenir en lançant tous leurs dés
+    indice = 0;
+    for (int t = 0; t <= NB_DES; t++) {
+        debut_taille_gardes[t] = indice;
+        diviseur = 1;
+        for (int i = 0; i < t; i++)
+            diviseur *= 6;
+
+        for (int code = 0; code < NB_CODES_COMPTES; code++) {
+            int reste = code, somme = 0;
+            for (int face = 0; face < 6; face++) {
+                total[face] = reste % 6;
+                somme += total[face];
+                reste = reste / 6;
+            }
+            if (somme == t) {
+                arrangements = FACTORIELLE[t];
+                for (int face = 0; face < 6; face++)
+                    arrangements /= FACTORIELLE[total[face]];
+
+                memcpy(comptes[indice], total, sizeof(total));
+                taille_gardes[indice] = t;
+                proba_tirages[indice] = (float)arrangements / diviseur;
+                proba_exacte_tirages[indice] = (double)arrangements / diviseur;
+                indice_gardes[code] = indice;
+                indice++;
+            }
+        }
+    }
+    debut_taille_gardes[NB_DES + 1] = indice;
+
+    // Etape 2 : la main obtenue par chaque garde et chaque issue de la relance
+    nb_transitions = 0;
+    for (int t = 0; t <= NB_DES; t++) {
+        debut_transitions[t] = nb_transitions;
+        relances = NB_DES - t;
+        for (int r = debut_taille_gardes[relances]; r < debut_taille_gardes[relances + 1]; r++) {
+            for (int g = debut_taille_gardes[t]; g < debut_taille_gardes[t + 1]; g++) {
+                int n = 0;
+                for (int face = 0; face < 6; face++) {
+                    for (int k = 0; k < comptes[g][face] + comptes[r][face]; k++)
+                        des[n++] = face + 1;
+                }
+                cible_transitions[nb_transitions++] = indice_main(des);
+            }
+        }
+    }
+
+    // Etape 3 : les gardes possibles de chaque main triée, sans doublon
+    for (int h = 0; h < NB_MAINS; h++) {
+        nb_gardes_main[h] = 0;
+        for (int garde = GARDER_TOUT; garde >= 0; garde--) {
+            int g = indice_garde(mains_triees[h], garde);
+            bool deja_vue = false;
+            for (int i = 0; i < nb_gardes_main[h] && !deja_vue; i++)
+                deja_vue = (gardes_main[h][i] == g);
+            if (!deja_vue)
+                gardes_main[h][nb_gardes_main[h]++] = g;
+        }
+    }
+
+    // Etape 4 : les sous-totaux supérieurs atteignables pour chaque ensemble de cases supérieures remplies
+    for (int cases = 0; cases < (1 << 6); cases++) {
+        uint64_t possibles = 1;     // seul le sous-total 0 est atteignable sans case remplie
+        for (int face = 0; face < 6; face++) {
+            if (cases & (1 << face)) {
+                uint64_t suivants = 0;
+                for (int st = 0; st < NB_SOUS_TOTAUX; st++) {
+                    if (possibles & (1ULL << st)) {
+                        for (int n = 0; n <= NB_DES; n++)
+                            suivants |= 1ULL << plafonner_sous_total(st + n * (face + 1));
+                    }
+                }
+                possibles = suivants;
+            }
+        }
+        sous_totaux_possibles[cases] = possibles;
+    }
+}
+
+/**
+ * \fn float esperance_garde(const float valeurs[NB_MAINS], int garde)
+ * \brief Calcule l'espérance après relance des dés non gardés, pour une seule garde
+ * \param valeurs La valeur de chaque main obtenue après la relance
+ * \param garde L'indice des dés gardés
+ * \return La moyenne des valeurs, pondérée par la probabilité de chaque main
+ */
+float esperance_garde(const float valeurs[NB_MAINS], int garde) {
+    const int TAILLE = taille_gardes[garde];
+    const int NB = debut_taille_gardes[TAILLE + 1] - debut_taille_gardes[TAILLE];
+    const int RELANCES = NB_DES - TAILLE;
+    const unsigned char *cibles;
+    float somme = 0;
+
+    // les cibles de cette garde sont espacées du nombre de gardes de même taille
+    cibles = cible_transitions + debut_transitions[TAILLE] + (garde - debut_taille_gardes[TAILLE]);
+    for (int r = debut_taille_gardes[RELANCES]; r < debut_taille_gardes[RELANCES + 1]; r++) {
+        somme += proba_tirages[r] * valeurs[*cibles];
+        cibles += NB;
+    }
+
+    return somme;
+}
+
+/**
+ * \fn void esperances_gardes(const float valeurs[NB_MAINS], float esperances[NB_GARDES])
+ * \brief Calcule l'espérance après relance de chacune des 462 gardes
+ *
+ * Les gardes d'une même taille partagent les probabilités des issues : pour chaque
+ * issue, la boucle sur les gardes lit des cibles contiguës avec un seul facteur,
+ * ce que le compilateur peut vectoriser.
+ * \param valeurs La valeur de chaque main obtenue après la relance
+ * \param esperances L'espérance de chaque garde
+ */
+void esperances_gardes(const float valeurs[NB_MAINS], float esperances[NB_GARDES]) {
+    const unsigned char *cibles;
+    float *sortie;
+    float proba;
+    int nb;
+
+    for (int t = 0; t <= NB_DES; t++) {
+        nb = debut_taille_gardes[t + 1] - debut_taille_gardes[t];
+        sortie = esperances + debut_taille_gardes[t];
+        cibles = cible_transitions + debut_transitions[t];
+
+        for (int g = 0; g < nb; g++)
+            sortie[g] = 0;
+
+        for (int r = debut_taille_gardes[NB_DES - t]; r < debut_taille_gardes[NB_DES - t + 1]; r++) {
+            proba = proba_tirages[r];
+            for (int g = 0; g < nb; g++)
+                sortie[g] += proba * valeurs[cibles[g]];
+            cibles += nb;
+        }
+    }
+}
+
+/**
+ * \fn void meilleures_gardes(const float esperances[NB_GARDES], float valeurs[NB_MAINS])
+ * \brief Donne à chaque main la valeur de sa meilleure garde
+ * \param esperances L'espérance de chaque garde
+ * \param valeurs La valeur de chaque main avant la relance
+ */
+void meilleures_gardes(const float esperances[NB_GARDES], float valeurs[NB_MAINS]) {
+    float meilleure;
+
+    for (int h = 0; h < NB_MAINS; h++) {
+        meilleure = esperances[gardes_main[h][0]];
+        for (int i = 1; i < nb_gardes_main[h]; i++) {
+            if (esperances[gardes_main[h][i]] > meilleure)
+                meilleure = esperances[gardes_main[h][i]];
+        }
+        valeurs[h] = meilleure;
+    }
+}
+
+/**
+ * \fn float valeur_case(const float *esperances, int masque, int sous_total, int indice, int points)
+ * \brief Calcule la valeur de l'inscription de points dans une case : points, bonus et espérance de la suite
+ * \param esperances La table des espérances des états suivants
+ * \param masque Les cases remplies avant l'inscription
+ * \param sous_total Le sous-total supérieur plafonné avant l'inscription
+ * \param indice L'indice de la case remplie
+ * \param points Les points inscrits
+ * \return La valeur de l'inscription
+ */
+float valeur_case(const float *esperances, int masque, int sous_total, int indice, int points) {
+    float valeur = points;
+
+    if (indice < 6) {
+        // le bonus est gagné à l'inscription qui fait passer la borne
+        if (sous_total <= BORNE_BONUS && sous_total + points > BORNE_BONUS)
+            valeur += BONUS;
+        sous_total = plafonner_sous_total(sous_total + points);
+    }
+
+    return valeur + esperances[(masque | (1 << indice)) * NB_SOUS_TOTAUX + sous_total];
+}
+
+/**
+ * \fn void valeurs_finales(const float *esperances, int masque, int sous_total, float valeurs[NB_MAINS])
+ * \brief Calcule la valeur de chaque main quand il ne reste plus qu'à choisir la case
+ * \param esperances La table des espérances des états suivants
+ * \param masque Les cases remplies
+ * \param sous_total Le sous-total supérieur plafonné
+ * \param valeurs La valeur de chaque main, avec la meilleure case
+ */
+void valeurs_finales(const float *esperances, int masque, int sous_total, float valeurs[NB_MAINS]) {
+    float valeur_sup[6][NB_DES + 1];    // la valeur de chaque case supérieure selon le nombre de dés
+    float valeur_inf[TAILLE_FEUILLE];   // la valeur de chaque case inférieure, hors points
+    int libres[TAILLE_FEUILLE];         // les cases libres
+    int nb_libres;
+    float meilleure, valeur;
+
+    nb_libres = 0;
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        if ((masque & (1 << i)) == 0) {
+            libres[nb_libres++] = i;
+            if (i < 6) {
+                for (int n = 0; n <= NB_DES; n++)
+                    valeur_sup[i][n] = valeur_case(esperances, masque, sous_total, i, n * (i + 1));
+            }
+            else {
+                valeur_inf[i] = valeur_case(esperances, masque, sous_total, i, 0);
+            }
+        }
+    }
+
+    for (int h = 0; h < NB_MAINS; h++) {
+        meilleure = -1;
+        for (int i = 0; i < nb_libres; i++) {
+            int c = libres[i];
+            if (c < 6)
+                valeur = valeur_sup[c][points_mains[h][c] / (c + 1)];
+            else
+                valeur = valeur_inf[c] + points_mains[h][c];
+
+            if (valeur > meilleure)
+                meilleure = valeur;
+        }
+        valeurs[h] = meilleure;
+    }
+}
+
+/**
+ * \struct t_evaluation_tour
+ * \brief Espérance de chaque garde à chaque relance d'un tour, pour un état de la feuille
+ *
+ * Une fois préparée pour un état, elle évalue les 32 masques d'une main
+ * par simple lecture, sans refaire le calcul des relances.
+ */
+typedef struct {
+    int masque;                             /**< Les cases remplies de l'état évalué */
+    int sous_total;                         /**< Le sous-total supérieur plafonné de l'état évalué */
+    float esperance;                        /**< L'espérance du tour et de la fin de partie */
+    float gardes[NB_LANCERS][NB_GARDES];    /**< gardes[l] : espérance de chaque garde quand il reste l relances */
+} t_evaluation_tour;
+
+/**
+ * \fn void evaluer_relances(float valeurs[NB_MAINS], t_evaluation_tour *evaluation)
+ * \brief Remonte les relances d'un tour à partir de la valeur de chaque main définitive
+ *
+ * Les valeurs peuvent être des espérances de points comme des probabilités de
+ * victoire : seul compte le choix de la garde qui donne la plus grande moyenne.
+ * \param valeurs La valeur de chaque main définitive, écrasée par le calcul
+ * \param evaluation L'évaluation du tour, dont sont remplies les gardes et l'espérance
+ */
+void evaluer_relances(float valeurs[NB_MAINS], t_evaluation_tour *evaluation) {
+    for (int l = 1; l < NB_LANCERS; l++) {
+        esperances_gardes(valeurs, evaluation->gardes[l]);
+        meilleures_gardes(evaluation->gardes[l], valeurs);
+    }
+
+    // le premier lancer est une relance des 5 dés, sans aucun dé gardé
+    evaluation->esperance = esperance_garde(valeurs, 0);
+}
+
+/**
+ * \fn void preparer_evaluation_tour(const float *esperances, int masque, int sous_total, t_evaluation_tour *evaluation)
+ * \brief Calcule l'espérance de chaque garde à chaque relance d'un tour
+ * \param esperances La table des espérances des états suivants
+ * \param masque Les cases remplies
+ * \param sous_total Le sous-total supérieur plafonné
+ * \param evaluation L'évaluation du tour
+ */
+void preparer_evaluation_tour(const float *esperances, int masque, int sous_total, t_evaluation_tour *evaluation) {
+    float valeurs[NB_MAINS];
+
+    evaluation->masque = masque;
+    evaluation->sous_total = sous_total;
+
+    valeurs_finales(esperances, masque, sous_total, valeurs);
+    evaluer_relances(valeurs, evaluation);
+}
+
+/**
+ * \fn void evaluer_gardes(const t_evaluation_tour *evaluation, const t_des des, int lancers_restants, float esperances[1 << NB_DES])
+ * \brief Donne l'espérance de chacun des 32 masques de dés gardés pour une main
+ * \param evaluation L'évaluation du tour, préparée pour l'état de la feuille
+ * \param des Les dés, triés ou non
+ * \param lancers_restants Le nombre de relances restantes, de 1 à NB_LANCERS - 1
+ * \param esperances L'espérance de chaque masque (bit i à 1 si le dé i est gardé)
+ */
+void evaluer_gardes(const t_evaluation_tour *evaluation, const t_des des, int lancers_restants, float esperances[1 << NB_DES]) {
+    int gardes[1 << NB_DES];
+
+    gardes_des(des, gardes);
+    for (int garde = 0; garde <= GARDER_TOUT; garde++)
+        esperances[garde] = evaluation->gardes[lancers_restants][gardes[garde]];
+}
+
+/**
+ * \fn int meilleure_garde_evaluee(const t_evaluation_tour *evaluation, const t_des des, int lancers_restants)
+ * \brief Recherche le masque de dés gardés de plus grande espérance
+ * \param evaluation L'évaluation du tour, préparée pour l'état de la feuille
+ * \param des Les dés, triés ou non
+ * \param lancers_restants Le nombre de relances restantes, de 1 à NB_LANCERS - 1
+ * \return Le masque des dés à garder, GARDER_TOUT pour ne plus relancer
+ */
+int meilleure_garde_evaluee(const t_evaluation_tour *evaluation, const t_des des, int lancers_restants) {
+    float esperances[1 << NB_DES];
+    int resultat;
+
+    evaluer_gardes(evaluation, des, lancers_restants, esperances);
+
+    // en cas d'égalité, on garde le plus de dés possible
+    resultat = GARDER_TOUT;
+    for (int garde = GARDER_TOUT - 1; garde >= 0; garde--) {
+        if (esperances[garde] > esperances[resultat])
+            resultat = garde;
+    }
+
+    return resultat;
+}
+
+/**
+ * \fn void resoudre_masque(float *esperances, int masque)
+ * \brief Calcule l'espérance de tous les sous-totaux atteignables pour un ensemble de cases remplies
+ *
+ * Le sous-total ne compte plus quand le bonus ne peut plus changer : toutes les cases
+ * supérieures sont remplies, ou même 5 dés dans chaque case supérieure libre ne
+ * l'atteindraient pas. Ces états reprennent alors l'espérance du sous-total 0.
+ * \param esperances La table des espérances, complétée pour ce masque
+ * \param masque Les cases remplies
+ */
+void resoudre_masque(float *esperances, int masque) {
+    t_evaluation_tour evaluation;
+    uint64_t possibles;
+    int reste_max;      // le plus grand total que peuvent encore apporter les cases supérieures
+
+    reste_max = 0;
+    for (int face = 0; face < 6; face++) {
+        if ((masque & (1 << face)) == 0)
+            reste_max += NB_DES * (face + 1);
+    }
+
+    possibles = sous_totaux_possibles[masque & 0x3F];
+    for (int st = 0; st < NB_SOUS_TOTAUX; st++) {
+        if (possibles & (1ULL << st)) {
+            if (st > 0 && (reste_max == 0 || st + reste_max <= BORNE_BONUS))
+                esperances[masque * NB_SOUS_TOTAUX + st] = esperances[masque * NB_SOUS_TOTAUX];
+            else {
+                preparer_evaluation_tour(esperances, masque, st, &evaluation);
+                esperances[masque * NB_SOUS_TOTAUX + st] = evaluation.esperance;
+            }
+        }
+    }
+}
+
+/**
+ * \fn int lancer_fils(pthread_t fils[], int nb_fils, void *(*executer)(void *), void *arguments, size_t taille_argument)
+ * \brief Lance nb_fils fils d'exécution ; le travail d'un fil qui ne peut être créé est fait par le fil appelant
+ *
+ * Si taille_argument est non nul, le fil i reçoit arguments + i * taille_argument
+ * et le fil appelant fait sur place la part d'un fil manquant. Sinon, tous les
+ * fils partagent le même argument, une file de travail : s'il manque des fils,
+ * le fil appelant vide la file avec ceux qui sont lancés.
+ * \param fils Les fils lancés, rangés en tête du tableau
+ * \param nb_fils Le nombre de fils voulus
+ * \param executer La fonction des fils
+ * \param arguments L'argument partagé, ou le premier des arguments propres à chaque fil
+ * \param taille_argument La taille de l'argument propre à chaque fil, 0 pour un argument partagé
+ * \return Le nombre de fils lancés, à attendre avec attendre_fils
+ */
+int lancer_fils(pthread_t fils[], int nb_fils, void *(*executer)(void *), void *arguments, size_t taille_argument) {
+    void *argument;
+    int lances = 0;
+
+    for (int i = 0; i < nb_fils; i++) {
+        argument = (char *)arguments + i * taille_argument;
+        if (pthread_create(&fils[lances], NULL, executer, argument) == 0)
+            lances++;
+        else if (taille_argument > 0)
+            executer(argument);
+    }
+
+    if (taille_argument == 0 && lances < nb_fils)
+        executer(arguments);
+
+    return lances;
+}
+
+/**
+ * \fn void attendre_fils(pthread_t fils[], int nb_fils)
+ * \brief Attend la fin des fils lancés par lancer_fils
+ * \param fils Les fils
+ * \param nb_fils Le nombre de fils lancés
+ */
+void attendre_fils(pthread_t fils[], int nb_fils) {
+    for (int i = 0; i < nb_fils; i++)
+        pthread_join(fils[i], NULL);
+}
+
+/**
+ * \struct t_niveau_solveur
+ * \brief Ensemble de masques ayant le même nombre de cases remplies, résolus en parallèle
+ */
+typedef struct {
+    float *esperances;      /**< La table des espérances */
+    const int *masques;     /**< Les masques du niveau */
+    int nb_masques;         /**< Le nombre de masques du niveau */
+    int prochain;           /**< Le prochain masque à résoudre, partagé entre les fils */
+} t_niveau_solveur;
+
+/**
+ * \fn void *executer_niveau_solveur(void *argument)
+ * \brief Point d'entrée d'un fil du solveur : résout des masques tant qu'il en reste
+ * \param argument Le niveau à résoudre (t_niveau_solveur)
+ * \return NULL
+ */
+void *executer_niveau_solveur(void *argument) {
+    t_niveau_solveur *niveau = argument;
+    int i;
+
+    while ((i = __atomic_fetch_add(&niveau->prochain, 1, __ATOMIC_RELAXED)) < niveau->nb_masques)
+        resoudre_masque(niveau->esperances, niveau->masques[i]);
+
+    return NULL;
+}
+
+/**
+ * \fn bool resoudre_strategie_optimale(float *esperances, int nb_fils)
+ * \brief Calcule l'espérance de chaque état de la feuille de marque en jouant au mieux
+ *
+ * Un état est l'ensemble des cases remplies et le sous-total supérieur, plafonné à
+ * BORNE_BONUS + 1 car seul le passage de la borne compte. Les états sont résolus du
+ * plus rempli au moins rempli : ceux d'un même niveau ne dépendent que du niveau
+ * suivant, et sont répartis entre les fils. La table obtenue suffit à retrouver
+ * chaque décision optimale (meilleure_garde, meilleure_case).
+ * \param esperances La table de NB_MASQUES * NB_SOUS_TOTAUX espérances, remplie
+ * \param nb_fils Le nombre de fils d'exécution
+ * \return Vrai si la table est résolue, faux si la mémoire manque
+ */
+bool resoudre_strategie_optimale(float *esperances, int nb_fils) {
+    t_niveau_solveur niveau;
+    pthread_t *fils;
+    int *masques;
+
+    fils = malloc(nb_fils * sizeof(pthread_t));
+    masques = malloc(NB_MASQUES * sizeof(int));
+    if (fils == NULL || masques == NULL) {
+        free(masques);
+        free(fils);
+        return false;
+    }
+
+    // une feuille remplie ne rapporte plus rien, et les états inatteignables restent à 0
+    memset(esperances, 0, NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float));
+
+    for (int remplies = TAILLE_FEUILLE - 1; remplies >= 0; remplies--) {
+        niveau.esperances = esperances;
+        niveau.masques = masques;
+        niveau.nb_masques = 0;
+        niveau.prochain = 0;
+        for (int masque = 0; masque < NB_MASQUES; masque++) {
+            if (__builtin_popcount(masque) == remplies)
+                masques[niveau.nb_masques++] = masque;
+        }
+
+        attendre_fils(fils, lancer_fils(fils, nb_fils, executer_niveau_solveur, &niveau, 0));
+    }
+
+    free(masques);
+    free(fils);
+    return true;
+}
+
+/**
+ * \fn void etat_feuille(const t_feuille feuille, int *masque, int *sous_total)
+ * \brief Résume une feuille de marque en état du solveur
+ * \param feuille La feuille de marque
+ * \param masque Les cases remplies
+ * \param sous_total Le sous-total supérieur plafonné
+ */
+void etat_feuille(const t_feuille feuille, int *masque, int *sous_total) {
+    t_feuille_compacte compacte;
+
+    compacter_feuille(feuille, &compacte);
+    *masque = compacte.remplies;
+    *sous_total = sous_total_compacte(&compacte);
+}
+
+/**
+ * \fn int meilleure_garde(const float *esperances, int masque, int sous_total, const t_des des, int lancers_restants)
+ * \brief Recherche les dés à garder qui maximisent l'espérance de la fin de partie
+ * \param esperances La table des espérances calculée par le solveur
+ * \param masque Les cases remplies
+ * \param sous_total Le sous-total supérieur plafonné
+ * \param des Les dés, triés ou non
+ * \param lancers_restants Le nombre de relances restantes, 1 ou 2
+ * \return Le masque des dés à garder, GARDER_TOUT pour ne plus relancer
+ */
+int meilleure_garde(const float *esperances, int masque, int sous_total, const t_des des, int lancers_restants) {
+    t_evaluation_tour evaluation;
+
+    preparer_evaluation_tour(esperances, masque, sous_total, &evaluation);
+    return meilleure_garde_evaluee(&evaluation, des, lancers_restants);
+}
+
+/**
+ * \fn int meilleure_case(const float *esperances, int masque, int sous_total, const t_des des)
+ * \brief Recherche la case qui maximise l'espérance de la fin de partie
+ * \param esperances La table des espérances calculée par le solveur
+ * \param masque Les cases remplies
+ * \param sous_total Le sous-total supérieur plafonné
+ * \param des Les dés définitifs, triés ou non
+ * \return L'indice de la case à remplir
+ */
+int meilleure_case(const float *esperances, int masque, int sous_total, const t_des des) {
+    const unsigned char *points;
+    float valeur, meilleure;
+    int resultat;
+
+    points = points_mains[indice_main(des)];
+
+    resultat = -1;
+    meilleure = -1;
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        if ((masque & (1 << i)) == 0) {
+            valeur = valeur_case(esperances, masque, sous_total, i, points[i]);
+            if (valeur > meilleure) {
+                meilleure = valeur;
+                resultat = i;
+            }
+        }
+    }
+
+    return resultat;
+}
+
+/**
+ * \struct t_entete_table
+ * \brief En-tête du fichier de la table optimale, suivi des espérances en float (petit-boutiste)
+ *
+ * Le fichier est projeté tel quel en mémoire : les espérances sont lues directement,
+ * sans analyse, et plusieurs processus partagent les mêmes pages physiques.
+ * Les règles (bonus, borne) et les dimensions sont enregistrées pour refuser une
+ * table calculée pour d'autres règles.
+ */
+typedef struct {
+    char magie[8];              /**< Signature du fichier, MAGIE_TABLE */
+    uint32_t version;           /**< Version du format, VERSION_TABLE */
+    uint32_t taille_entete;     /**< Taille de l'en-tête, début des espérances */
+    uint32_t nb_masques;        /**< Nombre d'ensembles de cases remplies */
+    uint32_t nb_sous_totaux;    /**< Nombre de sous-totaux supérieurs par ensemble */
+    uint32_t bonus;             /**< Points du bonus utilisés par le solveur */
+    uint32_t borne_bonus;       /**< Borne du bonus utilisée par le solveur */
+    uint64_t taille_donnees;    /**< Taille des espérances, en octets */
+    uint64_t somme_donnees;     /**< Somme de contrôle des espérances */
+    uint64_t somme_entete;      /**< Somme de contrôle des champs précédents */
+    char reserve[8];            /**< Réservé, à zéro, pour aligner l'en-tête sur 64 octets */
+} t_entete_table;
+
+/**
+ * \struct t_table_optimale
+ * \brief Table optimale projetée en mémoire depuis un fichier
+ */
+typedef struct {
+    void *projection;           /**< Début de la projection du fichier */
+    size_t taille;              /**< Taille de la projection */
+    const float *esperances;    /**< Les NB_MASQUES * NB_SOUS_TOTAUX espérances */
+} t_table_optimale;
+
+/**
+ * \fn uint64_t somme_controle(const void *donnees, size_t taille)
+ * \brief Calcule une somme de contrôle de Fletcher sur des mots de 32 bits
+ * \param donnees Les données, de taille multiple de 4 octets
+ * \param taille La taille des données, en octets
+ * \return La somme de contrôle
+ */
+uint64_t somme_controle(const void *donnees, size_t taille) {
+    const uint32_t *mots = donnees;
+    uint64_t somme1 = 0, somme2 = 0;
+
+    // la seconde somme dépend de la position de chaque mot
+    for (size_t i = 0; i < taille / sizeof(uint32_t); i++) {
+        somme1 += mots[i];
+        somme2 += somme1;
+    }
+
+    return (somme2 << 32) ^ somme1;
+}
+
+/**
+ * \fn bool enregistrer_table_optimale(const char fichier[], const float *esperances)
+ * \brief Enregistre la table du solveur dans un fichier projetable en mémoire
+ *
+ * La table est écrite dans un fichier temporaire, renommé une fois complet :
+ * un lecteur ne voit jamais de table à moitié écrite.
+ * \param fichier Le nom du fichier
+ * \param esperances La table des espérances calculée par le solveur
+ * \return Vrai si le fichier est écrit, faux sinon
+ */
+bool enregistrer_table_optimale(const char fichier[], const float *esperances) {
+    const size_t TAILLE_DONNEES = NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float);
+    char temporaire[PATH_MAX];
+    t_entete_table entete;
+    FILE *flux;
+    bool correct;
+
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.magie, MAGIE_TABLE, sizeof(entete.magie));
+    entete.version = VERSION_TABLE;
+    entete.taille_entete = sizeof(entete);
+    entete.nb_masques = NB_MASQUES;
+    entete.nb_sous_totaux = NB_SOUS_TOTAUX;
+    entete.bonus = BONUS;
+    entete.borne_bonus = BORNE_BONUS;
+    entete.taille_donnees = TAILLE_DONNEES;
+    entete.somme_donnees = somme_controle(esperances, TAILLE_DONNEES);
+    entete.somme_entete = somme_controle(&entete, offsetof(t_entete_table, somme_entete));
+
+    snprintf(temporaire, sizeof(temporaire), "%s.tmp", fichier);
+    flux = fopen(temporaire, "wb");
+    if (flux == NULL) {
+        fprintf(stderr, "Impossible de créer %s\n", temporaire);
+        return false;
+    }
+
+    correct = fwrite(&entete, sizeof(entete), 1, flux) == 1;
+    correct = correct && fwrite(esperances, TAILLE_DONNEES, 1, flux) == 1;
+    correct = (fclose(flux) == 0) && correct;
+    correct = correct && rename(temporaire, fichier) == 0;
+
+    if (!correct) {
+        fprintf(stderr, "Erreur d'écriture de %s\n", fichier);
+        remove(temporaire);
+    }
+
+    return correct;
+}
+
+/**
+ * \fn bool ouvrir_table_optimale(const char fichier[], t_table_optimale *table)
+ * \brief Projette en mémoire une table enregistrée, après avoir vérifié son en-tête et ses sommes de contrôle
+ * \param fichier Le nom du fichier
+ * \param table La table projetée
+ * \return Vrai si la table est utilisable, faux sinon
+ */
+bool ouvrir_table_optimale(const char fichier[], t_table_optimale *table) {
+    const t_entete_table *entete;
+    struct stat infos;
+    int descripteur;
+    bool correct;
+
+    descripteur = open(fichier, O_RDONLY);
+    if (descripteur < 0) {
+        fprintf(stderr, "Impossible d'ouvrir %s\n", fichier);
+        return false;
+    }
+
+    table->projection = MAP_FAILED;
+    if (fstat(descripteur, &infos) == 0 && infos.st_size >= (off_t)sizeof(t_entete_table)) {
+        table->taille = infos.st_size;
+        table->projection = mmap(NULL, table->taille, PROT_READ, MAP_SHARED, descripteur, 0);
+    }
+    close(descripteur);
+
+    if (table->projection == MAP_FAILED) {
+        fprintf(stderr, "%s n'est pas une table optimale\n", fichier);
+        return false;
+    }
+
+    entete = table->projection;
+    correct = memcmp(entete->magie, MAGIE_TABLE, sizeof(entete->magie)) == 0;
+    correct = correct && entete->somme_entete == somme_controle(entete, offsetof(t_entete_table, somme_entete));
+    correct = correct && entete->version == VERSION_TABLE;
+    correct = correct && entete->nb_masques == NB_MASQUES && entete->nb_sous_totaux == NB_SOUS_TOTAUX;
+    correct = correct && entete->bonus == BONUS && entete->borne_bonus == BORNE_BONUS;
+    correct = correct && entete->taille_donnees == NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float);
+    correct = correct && entete->taille_entete + entete->taille_donnees == table->taille;
+    correct = correct && entete->somme_donnees
+        == somme_controle((const char *)entete + entete->taille_entete, entete->taille_donnees);
+
+    if (!correct) {
+        fprintf(stderr, "%s est corrompue ou d'une version incompatible\n", fichier);
+        munmap(table->projection, table->taille);
+        return false;
+    }
+
+    table->esperances = (const float *)((const char *)entete + entete->taille_entete);
+    return true;
+}
+
+/**
+ * \fn void fermer_table_optimale(t_table_optimale *table)
+ * \brief Libère la projection d'une table
+ * \param table La table projetée
+ */
+void fermer_table_optimale(t_table_optimale *table) {
+    munmap(table->projection, table->taille);
+    table->projection = NULL;
+    table->esperances = NULL;
+}
+
+/**
+ * \fn float table_esperance(const t_table_optimale *table, const t_feuille feuille)
+ * \brief Donne l'espérance des points restant à marquer depuis une feuille, en jouant au mieux
+ * \param table La table projetée
+ * \param feuille La feuille de marque
+ * \return L'espérance, hors points déjà marqués
+ */
+float table_esperance(const t_table_optimale *table, const t_feuille feuille) {
+    int masque, sous_total;
+
+    etat_feuille(feuille, &masque, &sous_total);
+    return table->esperances[masque * NB_SOUS_TOTAUX + sous_total];
+}
+
+/**
+ * \fn int table_meilleure_garde(const t_table_optimale *table, const t_feuille feuille, const t_des des, int lancer)
+ * \brief Donne les dés à garder après un lancer, d'après une table projetée
+ * \param table La table projetée
+ * \param feuille La feuille de marque
+ * \param des Les dés, triés ou non
+ * \param lancer Le numéro du lancer qui vient d'être fait, 1 ou 2
+ * \return Le masque des dés à garder, GARDER_TOUT pour ne plus relancer
+ */
+int table_meilleure_garde(const t_table_optimale *table, const t_feuille feuille, const t_des des, int lancer) {
+    int masque, sous_total;
+
+    etat_feuille(feuille, &masque, &sous_total);
+    return meilleure_garde(table->esperances, masque, sous_total, des, NB_LANCERS - lancer);
+}
+
+/**
+ * \fn int table_meilleure_case(const t_table_optimale *table, const t_feuille feuille, const t_des des)
+ * \brief Donne la case à remplir avec des dés définitifs, d'après une table projetée
+ * \param table La table projetée
+ * \param feuille La feuille de marque
+ * \param des Les dés définitifs, triés ou non
+ * \return L'indice de la case à remplir
+ */
+int table_meilleure_case(const t_table_optimale *table, const t_feuille feuille, const t_des des) {
+    int masque, sous_total;
+
+    etat_feuille(feuille, &masque, &sous_total);
+    return meilleure_case(table->esperances, masque, sous_total, des);
+}
+
+/**
+ * \def MAX_PLIS_FINALE
+ * \brief Nombre maximum de plis de fin de partie résolus : le niveau suivant dépasserait 5 Go
+ */
+/**
+ * \def ECHELLE_FINALE
+ * \brief Une probabilité de victoire est enregistrée sur 16 bits, en multiple de 1 / ECHELLE_FINALE
+ */
+#define MAX_PLIS_FINALE 4
+#define ECHELLE_FINALE 65535
+
+/**
+ * \struct t_entete_finale
+ * \brief En-tête du fichier de la table de fin de partie, suivi des moyennes, des variances puis des plis
+ */
+typedef struct {
+    char magie[8];              /**< Signature du fichier, MAGIE_FINALE */
+    uint32_t version;           /**< Version du format, VERSION_FINALE */
+    uint32_t taille_entete;     /**< Taille de l'en-tête, début des données */
+    uint32_t nb_plis;           /**< Nombre de plis de fin de partie résolus */
+    uint32_t nb_masques;        /**< Nombre d'ensembles de cases remplies */
+    uint32_t nb_sous_totaux;    /**< Nombre de sous-totaux supérieurs par ensemble */
+    uint32_t bonus;             /**< Points du bonus utilisés pour la construction */
+    uint32_t borne_bonus;       /**< Borne du bonus utilisée pour la construction */
+    uint32_t reserve;           /**< Réservé, à zéro */
+    uint64_t taille_donnees;    /**< Taille des données, en octets */
+    uint64_t somme_donnees;     /**< Somme de contrôle des données */
+    uint64_t somme_entete;      /**< Somme de contrôle des champs précédents */
+} t_entete_finale;
+
+/**
+ * \struct t_finale
+ * \brief Probabilités de victoire en tête à tête : table exacte des derniers plis, approximation avant
+ *
+ * Un pli est le tour d'un seul joueur. Une position est vue du joueur au trait :
+ * son état, celui de l'adversaire et son avance au total. Dans la table, l'état
+ * d'un joueur est réduit à ses cases remplies et aux points qui lui manquent
+ * pour le bonus (0 si le bonus n'est plus en jeu) : le sous-total exact ne
+ * change plus rien. Plus tôt dans la partie, le total restant de chaque joueur
+ * est approché par une loi normale, d'après sa moyenne et sa variance en jouant
+ * pour l'espérance.
+ */
+typedef struct {
+    void *bloc;                                 /**< En-tête et données : projection du fichier, ou bloc de la construction */
+    size_t taille;                              /**< Taille du bloc, celle du fichier */
+    bool projete;                               /**< Vrai si le bloc est projeté depuis un fichier */
+    int nb_plis;                                /**< Nombre de plis de fin de partie résolus */
+    const float *moyennes;                      /**< Moyenne des points restant à marquer de chaque état du solveur */
+    const float *variances;                     /**< Variance de ces points */
+    const uint16_t *plis[MAX_PLIS_FINALE + 1];  /**< plis[r] : probabilité de victoire du joueur au trait, à r plis de la fin */
+    int debut_etats[NB_MASQUES];                /**< Premier état réduit de chaque masque, parmi ceux de même nombre de cases libres */
+    int nb_etats[TAILLE_FEUILLE + 1];           /**< Nombre d'états réduits selon le nombre de cases libres */
+} t_finale;
+
+/**
+ * \fn int reste_superieur(int masque)
+ * \brief Donne le plus grand total que peuvent encore apporter les cases supérieures libres
+ * \param masque Les cases remplies
+ * \return 5 dés dans chaque case supérieure libre
+ */
+int reste_superieur(int masque) {
+    int reste = 0;
+
+    for (int face = 0; face < 6; face++) {
+        if ((masque & (1 << face)) == 0)
+            reste += NB_DES * (face + 1);
+    }
+
+    return reste;
+}
+
+/**
+ * \fn int besoin_bonus(int masque, int sous_total)
+ * \brief Donne les points qui manquent au total supérieur pour le bonus
+ * \param masque Les cases remplies
+ * \param sous_total Le sous-total supérieur plafonné
+ * \return Les points manquants, 0 si le bonus est gagné ou ne peut plus l'être
+ */
+int besoin_bonus(int masque, int sous_total) {
+    int besoin = BORNE_BONUS + 1 - sous_total;
+
+    return besoin > 0 && besoin <= reste_superieur(masque) ? besoin : 0;
+}
+
+/**
+ * \fn int gain_max(int nb_libres)
+ * \brief Donne le plus de points que peuvent encore apporter un nombre de cases libres, bonus compris
+ * \param nb_libres Le nombre de cases libres
+ * \return Les points des cases les plus chères, plus le bonus
+ */
+int gain_max(int nb_libres) {
+    // les cases de la plus chère à la moins chère : yams, grande suite, 30 points (6 fois), 25 points...
+    const int GAIN_MAX[TAILLE_FEUILLE + 1] = {0, 85, 125, 155, 185, 215, 245, 275, 300, 325, 345, 360, 370, 375};
+
+    return GAIN_MAX[nb_libres];
+}
+
+/**
+ * \fn int largeur_pli(int plis)
+ * \brief Donne le nombre d'avances distinguées à un nombre de plis de la fin
+ *
+ * Au-delà, la partie est jouée : l'adversaire ne peut plus rattraper le joueur
+ * au trait, ou l'inverse.
+ * \param plis Le nombre de plis restants
+ * \return Le nombre d'avances, de -gain_max du joueur au trait à +gain_max de l'adversaire
+ */
+int largeur_pli(int plis) {
+    return gain_max((plis + 1) / 2) + gain_max(plis / 2) + 1;
+}
+
+/**
+ * \fn void initialiser_finale(t_finale *finale)
+ * \brief Numérote les états réduits de chaque nombre de cases libres, masque par masque
+ * \param finale La table, dont sont remplis debut_etats et nb_etats
+ */
+void initialiser_finale(t_finale *finale) {
+    int libres;
+
+    memset(finale->nb_etats, 0, sizeof(finale->nb_etats));
+    for (int masque = 0; masque < NB_MASQUES; masque++) {
+        libres = TAILLE_FEUILLE - __builtin_popcount(masque);
+        finale->debut_etats[masque] = finale->nb_etats[libres];
+        finale->nb_etats[libres] += 1 + reste_superieur(masque);
+    }
+}
+
+/**
+ * \fn size_t taille_pli(const t_finale *finale, int plis)
+ * \brief Donne le nombre de positions d'un pli de la table
+ * \param finale La table, initialisée
+ * \param plis Le nombre de plis restants
+ * \return Le nombre de probabilités enregistrées
+ */
+size_t taille_pli(const t_finale *finale, int plis) {
+    return (size_t)finale->nb_etats[(plis + 1) / 2] * finale->nb_etats[plis / 2] * largeur_pli(plis);
+}
+
+/**
+ * \fn double probabilite_position(const t_finale *finale, int masque, int sous_total, int masque_adversaire, int sous_total_adversaire, int avance)
+ * \brief Donne la probabilité de victoire du joueur au trait, une égalité comptant pour moitié
+ * \param finale La table
+ * \param masque Les cases remplies du joueur au trait
+ * \param sous_total Son sous-total supérieur plafonné
+ * \param masque_adversaire Les cases remplies de l'adversaire
+ * \param sous_total_adversaire Son sous-total supérieur plafonné
+ * \param avance Le total du joueur au trait moins celui de l'adversaire, bonus compris
+ * \return La probabilité, exacte dans les plis de la table, approchée avant
+ */
+double probabilite_position(const t_finale *finale, int masque, int sous_total,
+        int masque_adversaire, int sous_total_adversaire, int avance) {
+    const int LIBRES = TAILLE_FEUILLE - __builtin_popcount(masque);
+    const int LIBRES_ADVERSAIRE = TAILLE_FEUILLE - __builtin_popcount(masque_adversaire);
+    const int PLIS = LIBRES + LIBRES_ADVERSAIRE;
+    int etat, etat_adversaire;
+    double moyenne, variance;
+
+    if (PLIS == 0)
+        return avance > 0 ? 1 : avance == 0 ? 0.5 : 0;
+
+    // le joueur au trait a autant de cases libres que l'adversaire, ou une de plus
+    if (PLIS <= finale->nb_plis && LIBRES == (PLIS + 1) / 2) {
+        if (avance > gain_max(LIBRES_ADVERSAIRE))
+            return 1;
+        if (avance < -gain_max(LIBRES))
+            return 0;
+
+        etat = finale->debut_etats[masque] + besoin_bonus(masque, sous_total);
+        etat_adversaire = finale->debut_etats[masque_adversaire] + besoin_bonus(masque_adversaire, sous_total_adversaire);
+        return (double)finale->plis[PLIS][((size_t)etat * finale->nb_etats[LIBRES_ADVERSAIRE] + etat_adversaire)
+            * largeur_pli(PLIS) + avance + gain_max(LIBRES)] / ECHELLE_FINALE;
+    }
+
+    moyenne = avance + finale->moyennes[masque * NB_SOUS_TOTAUX + sous_total]
+        - finale->moyennes[masque_adversaire * NB_SOUS_TOTAUX + sous_total_adversaire];
+    variance = finale->variances[masque * NB_SOUS_TOTAUX + sous_total]
+        + finale->variances[masque_adversaire * NB_SOUS_TOTAUX + sous_total_adversaire];
+    if (variance <= 0)
+        return moyenne > 0 ? 1 : moyenne == 0 ? 0.5 : 0;
+
+    // P(avance finale > 0) + P(avance finale = 0) / 2, avec la correction de continuité
+    return 0.5 * erfc(-moyenne / sqrt(2 * variance));
+}
+
+/**
+ * \fn double victoire_case(const t_finale *finale, int masque, int sous_total, int masque_adversaire, int sous_total_adversaire, int avance, int indice, int points)
+ * \brief Donne la probabilité de victoire après l'inscription de points dans une case, quand l'adversaire prend la main
+ * \param finale La table
+ * \param masque Les cases remplies du joueur au trait, avant l'inscription
+ * \param sous_total Son sous-total supérieur plafonné, avant l'inscription
+ * \param masque_adversaire Les cases remplies de l'adversaire
+ * \param sous_total_adversaire Son sous-total supérieur plafonné
+ * \param avance L'avance du joueur au trait, avant l'inscription
+ * \param indice L'indice de la case remplie
+ * \param points Les points inscrits
+ * \return La probabilité de victoire du joueur qui inscrit les points
+ */
+double victoire_case(const t_finale *finale, int masque, int sous_total, int masque_adversaire,
+        int sous_total_adversaire, int avance, int indice, int points) {
+    int gain = points;
+
+    if (indice < 6) {
+        // le bonus est gagné à l'inscription qui fait passer la borne
+        if (sous_total <= BORNE_BONUS && sous_total + points > BORNE_BONUS)
+            gain += BONUS;
+        sous_total = plafonner_sous_total(sous_total + points);
+    }
+
+    return 1 - probabilite_position(finale, masque_adversaire, sous_total_adversaire,
+        masque | (1 << indice), sous_total, -(avance + gain));
+}
+
+/**
+ * \fn void preparer_evaluation_victoire(const t_finale *finale, int masque, int sous_total, int masque_adversaire, int sous_total_adversaire, int avance, t_evaluation_tour *evaluation)
+ * \brief Calcule la probabilité de victoire de chaque garde à chaque relance du tour du joueur au trait
+ *
+ * Même calcul que preparer_evaluation_tour, la valeur d'une main définitive
+ * étant la meilleure probabilité de victoire parmi les cases libres. Les
+ * probabilités de chaque couple (case, points) sont calculées à la demande.
+ * \param finale La table
+ * \param masque Les cases remplies du joueur au trait
+ * \param sous_total Son sous-total supérieur plafonné
+ * \param masque_adversaire Les cases remplies de l'adversaire
+ * \param sous_total_adversaire Son sous-total supérieur plafonné
+ * \param avance Le total du joueur au trait moins celui de l'adversaire
+ * \param evaluation L'évaluation du tour, dont l'espérance est la probabilité de victoire de la position
+ */
+void preparer_evaluation_victoire(const t_finale *finale, int masque, int sous_total, int masque_adversaire,
+        int sous_total_adversaire, int avance, t_evaluation_tour *evaluation) {
+    float victoires[TAILLE_FEUILLE][POINTS_CASE_MAX + 1];
+    float valeurs[NB_MAINS];
+    int libres[TAILLE_FEUILLE];
+    int nb_libres, c, points;
+    float meilleure;
+
+    evaluation->masque = masque;
+    evaluation->sous_total = sous_total;
+
+    nb_libres = 0;
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        if ((masque & (1 << i)) == 0) {
+            libres[nb_libres++] = i;
+            for (int p = 0; p <= POINTS_CASE_MAX; p++)
+                victoires[i][p] = -1;
+        }
+    }
+
+    for (int h = 0; h < NB_MAINS; h++) {
+        meilleure = 0;
+        for (int i = 0; i < nb_libres; i++) {
+            c = libres[i];
+            points = points_mains[h][c];
+            if (victoires[c][points] < 0)
+                victoires[c][points] = victoire_case(finale, masque, sous_total, masque_adversaire,
+                    sous_total_adversaire, avance, c, points);
+            if (victoires[c][points] > meilleure)
+                meilleure = victoires[c][points];
+        }
+        valeurs[h] = meilleure;
+    }
+
+    evaluer_relances(valeurs, evaluation);
+}
+
+/**
+ * \fn int meilleure_case_victoire(const t_finale *finale, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des)
+ * \brief Recherche la case qui maximise la probabilité de victoire en tête à tête
+ * \param finale La table
+ * \param feuille La feuille du joueur au trait
+ * \param adversaire La feuille de l'adversaire
+ * \param des Les dés définitifs, triés ou non
+ * \return L'indice de la case à remplir
+ */
+int meilleure_case_victoire(const t_finale *finale, const t_feuille_compacte *feuille,
+        const t_feuille_compacte *adversaire, const t_des des) {
+    const unsigned char *points = points_mains[indice_main(des)];
+    double victoire, meilleure = -1;
+    int resultat = -1;
+
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        if (case_libre(feuille, i)) {
+            victoire = victoire_case(finale, feuille->remplies, sous_total_compacte(feuille), adversaire->remplies,
+                sous_total_compacte(adversaire), total_compacte(feuille) - total_compacte(adversaire), i, points[i]);
+            if (victoire > meilleure) {
+                meilleure = victoire;
+                resultat = i;
+            }
+        }
+    }
+
+    return resultat;
+}
+
+/**
+ * \fn size_t taille_donnees_finale(const t_finale *finale, int nb_plis)
+ * \brief Donne la taille des données d'une table de fin de partie : moyennes, variances puis plis
+ * \param finale La table, initialisée
+ * \param nb_plis Le nombre de plis résolus
+ * \return La taille, en octets
+ */
+size_t taille_donnees_finale(const t_finale *finale, int nb_plis) {
+    size_t taille = 2 * NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float);
+
+    for (int r = 1; r <= nb_plis; r++)
+        taille += taille_pli(finale, r) * sizeof(uint16_t);
+
+    return taille;
+}
+
+/**
+ * \fn void placer_donnees_finale(t_finale *finale, int nb_plis)
+ * \brief Fait pointer les moyennes, les variances et les plis dans le bloc, après l'en-tête
+ * \param finale La table, initialisée, dont le bloc est en place
+ * \param nb_plis Le nombre de plis résolus
+ */
+void placer_donnees_finale(t_finale *finale, int nb_plis) {
+    const char *donnees = (const char *)finale->bloc + sizeof(t_entete_finale);
+
+    finale->nb_plis = nb_plis;
+    finale->moyennes = (const float *)donnees;
+    donnees += NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float);
+    finale->variances = (const float *)donnees;
+    donnees += NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float);
+    for (int r = 1; r <= nb_plis; r++) {
+        finale->plis[r] = (const uint16_t *)donnees;
+        donnees += taille_pli(finale, r) * sizeof(uint16_t);
+    }
+}
+
+/**
+ * \fn bool ouvrir_finale(const char fichier[], t_finale *finale)
+ * \brief Projette en mémoire une table de fin de partie, après avoir vérifié son en-tête et sa somme de contrôle
+ * \param fichier Le nom du fichier
+ * \param finale La table projetée
+ * \return Vrai si la table est utilisable, faux sinon
+ */
+bool ouvrir_finale(const char fichier[], t_finale *finale) {
+    const t_entete_finale *entete;
+    struct stat infos;
+    int descripteur;
+    bool correct;
+
+    descripteur = open(fichier, O_RDONLY);
+    if (descripteur < 0) {
+        fprintf(stderr, "Impossible d'ouvrir %s\n", fichier);
+        return false;
+    }
+
+    finale->bloc = MAP_FAILED;
+    if (fstat(descripteur, &infos) == 0 && infos.st_size >= (off_t)sizeof(t_entete_finale)) {
+        finale->taille = infos.st_size;
+        finale->bloc = mmap(NULL, finale->taille, PROT_READ, MAP_SHARED, descripteur, 0);
+    }
+    close(descripteur);
+
+    if (finale->bloc == MAP_FAILED) {
+        fprintf(stderr, "%s n'est pas une table de fin de partie\n", fichier);
+        return false;
+    }
+
+    initialiser_finale(finale);
+    entete = finale->bloc;
+    correct = memcmp(entete->magie, MAGIE_FINALE, sizeof(entete->magie)) == 0;
+    correct = correct && entete->somme_entete == somme_controle(entete, offsetof(t_entete_finale, somme_entete));
+    correct = correct && entete->version == VERSION_FINALE && entete->taille_entete == sizeof(t_entete_finale);
+    correct = correct && entete->nb_masques == NB_MASQUES && entete->nb_sous_totaux == NB_SOUS_TOTAUX;
+    correct = correct && entete->bonus == BONUS && entete->borne_bonus == BORNE_BONUS;
+    correct = correct && entete->nb_plis <= MAX_PLIS_FINALE;
+    correct = correct && entete->taille_donnees == taille_donnees_finale(finale, entete->nb_plis);
+    correct = correct && entete->taille_entete + entete->taille_donnees == finale->taille;
+    correct = correct && entete->somme_donnees
+        == somme_controle((const char *)entete + entete->taille_entete, entete->taille_donnees);
+
+    if (!correct) {
+        fprintf(stderr, "%s est corrompue ou d'une version incompatible\n", fichier);
+        munmap(finale->bloc, finale->taille);
+        return false;
+    }
+
+    finale->projete = true;
+    placer_donnees_finale(finale, entete->nb_plis);
+    return true;
+}
+
+/**
+ * \fn void fermer_finale(t_finale *finale)
+ * \brief Libère une table de fin de partie, projetée ou construite en mémoire
+ * \param finale La table
+ */
+void fermer_finale(t_finale *finale) {
+    if (finale->projete)
+        munmap(finale->bloc, finale->taille);
+    else
+        free(finale->bloc);
+    finale->bloc = NULL;
+    finale->nb_plis = 0;
+}
+
+/**
+ * \fn float finale_probabilite_victoire(const t_finale *finale, const t_feuille feuille, const t_feuille adversaire)
+ * \brief Donne la probabilité de victoire en tête à tête du joueur au trait, une égalité comptant pour moitié
+ * \param finale La table de fin de partie
+ * \param feuille La feuille du joueur au trait
+ * \param adversaire La feuille de l'adversaire
+ * \return La probabilité de victoire
+ */
+float finale_probabilite_victoire(const t_finale *finale, const t_feuille feuille, const t_feuille adversaire) {
+    t_feuille_compacte compacte, compacte_adversaire;
+
+    compacter_feuille(feuille, &compacte);
+    compacter_feuille(adversaire, &compacte_adversaire);
+    return probabilite_position(finale, compacte.remplies, sous_total_compacte(&compacte), compacte_adversaire.remplies,
+        sous_total_compacte(&compacte_adversaire), total_compacte(&compacte) - total_compacte(&compacte_adversaire));
+}
+
+/**
+ * \fn int finale_meilleure_garde(const t_finale *finale, const t_feuille feuille, const t_feuille adversaire, const t_des des, int lancer)
+ * \brief Donne les dés à garder qui maximisent la probabilité de victoire en tête à tête
+ * \param finale La table de fin de partie
+ * \param feuille La feuille du joueur au trait
+ * \param adversaire La feuille de l'adversaire
+ * \param des Les dés, triés ou non
+ * \param lancer Le numéro du lancer qui vient d'être fait, 1 ou 2
+ * \return Le masque des dés à garder, GARDER_TOUT pour ne plus relancer
+ */
+int finale_meilleure_garde(const t_finale *finale, const t_feuille feuille, const t_feuille adversaire,
+        const t_des des, int lancer) {
+    t_feuille_compacte compacte, compacte_adversaire;
+    t_evaluation_tour evaluation;
+
+    compacter_feuille(feuille, &compacte);
+    compacter_feuille(adversaire, &compacte_adversaire);
+    preparer_evaluation_victoire(finale, compacte.remplies, sous_total_compacte(&compacte), compacte_adversaire.remplies,
+        sous_total_compacte(&compacte_adversaire), total_compacte(&compacte) - total_compacte(&compacte_adversaire),
+        &evaluation);
+    return meilleure_garde_evaluee(&evaluation, des, NB_LANCERS - lancer);
+}
+
+/**
+ * \fn int finale_meilleure_case(const t_finale *finale, const t_feuille feuille, const t_feuille adversaire, const t_des des)
+ * \brief Donne la case qui maximise la probabilité de victoire en tête à tête
+ * \param finale La table de fin de partie
+ * \param feuille La feuille du joueur au trait
+ * \param adversaire La feuille de l'adversaire
+ * \param des Les dés définitifs, triés ou non
+ * \return L'indice de la case à remplir
+ */
+int finale_meilleure_case(const t_finale *finale, const t_feuille feuille, const t_feuille adversaire, const t_des des) {
+    t_feuille_compacte compacte, compacte_adversaire;
+
+    compacter_feuille(feuille, &compacte);
+    compacter_feuille(adversaire, &compacte_adversaire);
+    return meilleure_case_victoire(finale, &compacte, &compacte_adversaire, des);
+}
+
+/**
+ * \struct t_strategie
+ * \brief Joueur automatique, qui prend les décisions d'un tour sans clavier ni affichage
+ *
+ * Le masque des dés à garder a son bit i à 1 si le dé i est gardé.
+ * Garder tous les dés (GARDER_TOUT) termine les lancers du tour.
+ * La feuille de l'adversaire n'est donnée qu'en tête à tête, NULL sinon.
+ */
+typedef struct s_strategie t_strategie;
+struct s_strategie {
+    /** Nom de la stratégie, utilisé en ligne de commande */
+    const char *nom;
+    /** Choisit les dés à garder, alors qu'il reste lancers_restants relances */
+    int (*choisir_garde)(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea);
+    /** Choisit l'indice de la case à remplir avec les dés définitifs */
+    int (*choisir_case)(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea);
+    /** Vrai si les décisions dépendent du hasard, et pas seulement de la feuille et des dés */
+    bool aleatoire;
+    /** Données propres à la stratégie */
+    void *contexte;
+};
+
+/**
+ * \fn int premiere_case_vide(const t_feuille_compacte *feuille)
+ * \brief Recherche la première case vide d'une feuille compacte
+ * \param feuille La feuille
+ * \return L'indice de la case, ou -1 si la feuille est remplie
+ */
+int premiere_case_vide(const t_feuille_compacte *feuille) {
+    int libres = ~feuille->remplies & FEUILLE_REMPLIE;
+
+    return libres == 0 ? -1 : __builtin_ctz(libres);
+}
+
+/**
+ * \fn int greedy_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea)
+ * \brief Garde les dés de la face la plus fréquente, ou tous les dés si une combinaison spéciale libre est faite
+ */
+int greedy_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea) {
+    const int SEUIL = 25;           // points à partir desquels on ne relance plus
+    const unsigned char *points;    // les points de la main pour chaque case
+    int occurences[7] = {0};        // le nombre de dés de chaque face
+    int face, masque;
+
+    // une combinaison spéciale libre est déjà faite (full, suites, yams)
+    points = points_mains[indice_main(des)];
+    for (int i = I_FULL_H; i <= I_YAMS; i++) {
+        if (case_libre(feuille, i) && points[i] >= SEUIL)
+            return GARDER_TOUT;
+    }
+
+    // sinon on garde la face la plus fréquente, la plus haute en cas d'égalité
+    for (int i = 0; i < NB_DES; i++)
+        occurences[des[i]]++;
+
+    face = 6;
+    for (int valeur = 5; valeur >= 1; valeur--) {
+        if (occurences[valeur] > occurences[face])
+            face = valeur;
+    }
+
+    masque = 0;
+    for (int i = 0; i < NB_DES; i++) {
+        if (des[i] == face)
+            masque |= 1 << i;
+    }
+
+    return masque;
+}
+
+/**
+ * \fn int greedy_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea)
+ * \brief Choisit la case qui rapporte le plus de points, ou sacrifie la case qui pourrait en rapporter le moins
+ */
+int greedy_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea) {
+    const unsigned char *points;
+    int meilleure, sacrifice;
+
+    points = points_mains[indice_main(des)];
+    meilleure = -1;
+    sacrifice = -1;
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        if (case_libre(feuille, i)) {
+            if (meilleure == -1 || points[i] > points[meilleure])
+                meilleure = i;
+            if (sacrifice == -1 || points_max[i] < points_max[sacrifice])
+                sacrifice = i;
+        }
+    }
+
+    if (points[meilleure] == 0)
+        meilleure = sacrifice;
+
+    return meilleure;
+}
+
+/**
+ * \fn bool bonus_a_portee(const t_feuille_compacte *feuille)
+ * \brief Indique si le bonus reste à gagner en faisant trois dés de chaque face dont la case supérieure est libre
+ * \param feuille La feuille
+ * \return Vrai si le bonus n'est pas encore gagné et reste à portée
+ */
+bool bonus_a_portee(const t_feuille_compacte *feuille) {
+    int total = feuille->total_sup;
+
+    for (int i = 0; i < I_BRELAN; i++) {
+        if (case_libre(feuille, i))
+            total += 3 * (i + 1);
+    }
+
+    return feuille->bonus == 0 && total > BORNE_BONUS;
+}
+
+/**
+ * \fn int bonus_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea)
+ * \brief Garde les dés de la face la plus fréquente dont la case supérieure est libre, tant que le bonus est à portée
+ *
+ * Joue comme greedy quand le bonus est hors de portée, ou quand aucune face
+ * libre n'a au moins deux dés.
+ */
+int bonus_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea) {
+    int occurences[7] = {0};        // le nombre de dés de chaque face
+    int face, masque;
+
+    if (!bonus_a_portee(feuille))
+        return greedy_garde(strategie, feuille, adversaire, des, lancers_restants, alea);
+    if (case_libre(feuille, I_YAMS) && points_mains[indice_main(des)][I_YAMS] > 0)
+        return GARDER_TOUT;
+
+    for (int i = 0; i < NB_DES; i++)
+        occurences[des[i]]++;
+
+    // la face libre la plus fréquente, la plus haute en cas d'égalité
+    face = 0;
+    for (int valeur = 6; valeur >= 1; valeur--) {
+        if (case_libre(feuille, valeur - 1) && (face == 0 || occurences[valeur] > occurences[face]))
+            face = valeur;
+    }
+
+    if (face == 0 || occurences[face] < 2)
+        return greedy_garde(strategie, feuille, adversaire, des, lancers_restants, alea);
+
+    masque = 0;
+    for (int i = 0; i < NB_DES; i++) {
+        if (des[i] == face)
+            masque |= 1 << i;
+    }
+
+    return masque;
+}
+
+/**
+ * \fn int bonus_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea)
+ * \brief Choisit la case supérieure qui rapporte le plus, si elle atteint trois dés et que le bonus est à portée, sinon joue comme greedy
+ */
+int bonus_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea) {
+    const unsigned char *points = points_mains[indice_main(des)];
+    int meilleure = -1;
+
+    if (bonus_a_portee(feuille) && !(case_libre(feuille, I_YAMS) && points[I_YAMS] > 0)) {
+        for (int i = 0; i < I_BRELAN; i++) {
+            if (case_libre(feuille, i) && points[i] >= 3 * (i + 1) && (meilleure == -1 || points[i] > points[meilleure]))
+                meilleure = i;
+        }
+    }
+
+    if (meilleure == -1)
+        meilleure = greedy_case(strategie, feuille, adversaire, des, alea);
+
+    return meilleure;
+}
+
+/**
+ * \fn int straight_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea)
+ * \brief Garde un dé de chaque face de la suite libre la plus avancée
+ *
+ * Vise la grande suite si sa case est libre, la petite sinon. Une petite suite
+ * déjà faite est gardée entière pendant la chasse à la grande. Joue comme
+ * greedy quand les deux suites sont remplies, ou quand moins de trois faces
+ * de la suite sont présentes.
+ */
+int straight_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea) {
+    const unsigned char *points;    // les points de la main pour chaque case
+    int presentes, cible, longueur, debut, couvertes, meilleures, vues, masque;
+
+    if (!case_libre(feuille, I_P_SUITE) && !case_libre(feuille, I_G_SUITE))
+        return greedy_garde(strategie, feuille, adversaire, des, lancers_restants, alea);
+
+    // la suite visée, déjà faite, ou un yams libre, terminent les lancers
+    points = points_mains[indice_main(des)];
+    cible = case_libre(feuille, I_G_SUITE) ? I_G_SUITE : I_P_SUITE;
+    if (points[cible] > 0 || (case_libre(feuille, I_YAMS) && points[I_YAMS] > 0))
+        return GARDER_TOUT;
+
+    // bit f à 1 si la face f est présente
+    presentes = 0;
+    for (int i = 0; i < NB_DES; i++)
+        presentes |= 1 << des[i];
+
+    // la fenêtre de faces consécutives qui en contient le plus, la plus basse en cas d'égalité
+    longueur = cible == I_G_SUITE && points[I_P_SUITE] == 0 ? 5 : 4;
+    debut = 1;
+    meilleures = 0;
+    for (int premiere = 1; premiere + longueur <= 7; premiere++) {
+        couvertes = __builtin_popcount(presentes & (((1 << longueur) - 1) << premiere));
+        if (couvertes > meilleures) {
+            meilleures = couvertes;
+            debut = premiere;
+        }
+    }
+
+    if (meilleures < 3)
+        return greedy_garde(strategie, feuille, adversaire, des, lancers_restants, alea);
+
+    vues = 0;
+    masque = 0;
+    for (int i = 0; i < NB_DES; i++) {
+        if (des[i] >= debut && des[i] < debut + longueur && (vues & (1 << des[i])) == 0) {
+            vues |= 1 << des[i];
+            masque |= 1 << i;
+        }
+    }
+
+    return masque;
+}
+
+/**
+ * \fn int straight_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea)
+ * \brief Inscrit la suite faite dans sa case libre, la grande d'abord, sinon joue comme greedy
+ */
+int straight_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea) {
+    const unsigned char *points = points_mains[indice_main(des)];
+
+    if (case_libre(feuille, I_G_SUITE) && points[I_G_SUITE] > 0)
+        return I_G_SUITE;
+    if (case_libre(feuille, I_P_SUITE) && points[I_P_SUITE] > 0)
+        return I_P_SUITE;
+
+    return greedy_case(strategie, feuille, adversaire, des, alea);
+}
+
+/**
+ * \fn int random_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea)
+ * \brief Garde des dés au hasard
+ */
+int random_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea) {
+    return alea_suivant(alea) & GARDER_TOUT;
+}
+
+/**
+ * \fn int random_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea)
+ * \brief Choisit une case vide au hasard
+ */
+int random_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea) {
+    int libres, rang;
+
+    // on retire les cases vides qui précèdent celle de rang tiré au hasard
+    libres = ~feuille->remplies & FEUILLE_REMPLIE;
+    rang = alea_borne(alea, __builtin_popcount(libres));
+    for (int i = 0; i < rang; i++)
+        libres &= libres - 1;
+
+    return __builtin_ctz(libres);
+}
+
+/**
+ * \fn int optimal_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea)
+ * \brief Garde les dés qui maximisent l'espérance, d'après la table du solveur placée en contexte
+ */
+int optimal_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea) {
+    // les relances d'un même tour partagent l'évaluation de l'état, gardée par fil
+    static _Thread_local t_evaluation_tour evaluation;
+    static _Thread_local const void *table = NULL;
+    int sous_total = sous_total_compacte(feuille);
+
+    if (table != strategie->contexte || evaluation.masque != feuille->remplies || evaluation.sous_total != sous_total) {
+        preparer_evaluation_tour(strategie->contexte, feuille->remplies, sous_total, &evaluation);
+        table = strategie->contexte;
+    }
+
+    return meilleure_garde_evaluee(&evaluation, des, lancers_restants);
+}
+
+/**
+ * \fn int optimal_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea)
+ * \brief Choisit la case qui maximise l'espérance, d'après la table du solveur placée en contexte
+ */
+int optimal_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea) {
+    return meilleure_case(strategie->contexte, feuille->remplies, sous_total_compacte(feuille), des);
+}
+
+/**
+ * \fn int win_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea)
+ * \brief Garde les dés qui maximisent la probabilité de battre l'adversaire, d'après la table de fin de partie placée en contexte
+ *
+ * Sans adversaire, joue pour l'espérance d'après les moyennes de la table.
+ */
+int win_garde(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, int lancers_restants, t_alea *alea) {
+    // les relances d'un même tour partagent l'évaluation de la position, gardée par fil
+    static _Thread_local t_evaluation_tour evaluation;
+    static _Thread_local const void *table = NULL;
+    static _Thread_local int position[3];
+    const t_finale *finale = strategie->contexte;
+    int sous_total = sous_total_compacte(feuille);
+    int adverse[3] = {-1, 0, 0};    // cases remplies et sous-total de l'adversaire, avance du joueur
+
+    if (adversaire != NULL) {
+        adverse[0] = adversaire->remplies;
+        adverse[1] = sous_total_compacte(adversaire);
+        adverse[2] = total_compacte(feuille) - total_compacte(adversaire);
+    }
+
+    if (table != finale || evaluation.masque != feuille->remplies || evaluation.sous_total != sous_total
+            || memcmp(position, adverse, sizeof(adverse)) != 0) {
+        if (adversaire == NULL)
+            preparer_evaluation_tour(finale->moyennes, feuille->remplies, sous_total, &evaluation);
+        else
+            preparer_evaluation_victoire(finale, feuille->remplies, sous_total, adverse[0], adverse[1], adverse[2], &evaluation);
+        table = finale;
+        memcpy(position, adverse, sizeof(adverse));
+    }
+
+    return meilleure_garde_evaluee(&evaluation, des, lancers_restants);
+}
+
+/**
+ * \fn int win_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea)
+ * \brief Choisit la case qui maximise la probabilité de battre l'adversaire, ou l'espérance sans adversaire
+ */
+int win_case(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, const t_des des, t_alea *alea) {
+    const t_finale *finale = strategie->contexte;
+
+    if (adversaire == NULL)
+        return meilleure_case(finale->moyennes, feuille->remplies, sous_total_compacte(feuille), des);
+    return meilleure_case_victoire(finale, feuille, adversaire, des);
+}
+
+/**
+ * \var STRATEGIES
+ * \brief Les stratégies disponibles en ligne de commande
+ *
+ * La stratégie optimale reçoit sa table d'espérances au lancement de la simulation,
+ * la stratégie win sa table de fin de partie.
+ */
+t_strategie STRATEGIES[] = {
+    {"greedy", greedy_garde, greedy_case, false, NULL},
+    {"bonus", bonus_garde, bonus_case, false, NULL},
+    {"straight", straight_garde, straight_case, false, NULL},
+    {"random", random_garde, random_case, true, NULL},
+    {"optimal", optimal_garde, optimal_case, false, NULL},
+    {"win", win_garde, win_case, false, NULL},
+};
+
+/**
+ * \fn t_strategie *rechercher_strategie(const char nom_strategie[])
+ * \brief Recherche une stratégie par son nom
+ * \param nom_strategie Le nom de la stratégie
+ * \return La stratégie, ou NULL si elle n'existe pas
+ */
+t_strategie *rechercher_strategie(const char nom_strategie[]) {
+    const int NB_STRATEGIES = sizeof(STRATEGIES) / sizeof(STRATEGIES[0]);
+    t_strategie *resultat = NULL;
+
+    for (int i = 0; i < NB_STRATEGIES && resultat == NULL; i++) {
+        if (strcmp(nom_strategie, STRATEGIES[i].nom) == 0)
+            resultat = &STRATEGIES[i];
+    }
+
+    return resultat;
+}
+
+/**
+ * \fn int jouer_tour_auto(const t_strategie *strategie, const t_feuille_compacte *feuille, const t_feuille_compacte *adversaire, t_alea *alea, int *points, uint64_t *mot)
+ * \brief Joue un tour complet pour une stratégie : lancers, relances puis choix de la case
+ * \param strategie La stratégie qui prend les décisions
+ * \param feuille La feuille du joueur
+ * \param adversaire La feuille de l'adversaire en tête à tête, NULL sinon
+ * \param alea Le générateur utilisé pour lancer les dés
+ * \param points Les points à inscrire dans la case choisie
+ * \param mot Le mot du tour pour le journal, sans le joueur ni la case
+ * \return L'indice de la case choisie, toujours libre
+ */
+int jouer_tour_auto(const t_strategie *strategie, const t_feuille_compacte *feuille,
+        const t_feuille_compacte *adversaire, t_alea *alea, int *points, uint64_t *mot) {
+    t_des des;
+    int garde, indice;
+    uint64_t mot_tour = 0;
+    DEBUT_MESURE();
+
+    for (int i = 0; i < NB_DES; i++)
+        des[i] = lancer_de(alea);
+    FIN_MESURE(PHASE_LANCER);
+    noter_lancer(&mot_tour, 0, des);
+
+    for (int lancer = 1; lancer < NB_LANCERS; lancer++) {
+        garde = strategie->choisir_garde(strategie, feuille, adversaire, des, NB_LANCERS - lancer, alea);
+        if ((garde & GARDER_TOUT) == GARDER_TOUT)
+            break;
+
+        DEBUT_MESURE();
+        for (int i = 0; i < NB_DES; i++) {
+            if ((garde & (1 << i)) == 0)
+                des[i] = lancer_de(alea);
+        }
+        FIN_MESURE(PHASE_LANCER);
+        noter_garde(&mot_tour, lancer, garde);
+        noter_lancer(&mot_tour, lancer, des);
+    }
+
+    indice = strategie->choisir_case(strategie, feuille, adversaire, des, alea);
+
+    // une stratégie qui choisit une case impossible perd son choix
+    if (indice < 0 || indice >= TAILLE_FEUILLE || !case_libre(feuille, indice))
+        indice = premiere_case_vide(feuille);
+
+    *points = points_case(des, indice);
+    *mot = mot_tour;
+    COMPTER_TOUR(indice, *points, nb_lancers_mot(mot_tour));
+    return indice;
+}
+
+/**
+ * \fn void jouer_partie_auto(const t_strategie *const strategies[], int nb_joueurs, t_alea *alea, int totaux[], uint64_t mots[])
+ * \brief Joue une partie complète de 13 tours autour d'une table, sans entrée ni affichage
+ * \param strategies La stratégie de chaque joueur
+ * \param nb_joueurs Le nombre de joueurs, au plus MAX_JOUEURS
+ * \param alea Le générateur utilisé pour lancer les dés
+ * \param totaux Le total final de chaque joueur
+ * \param mots Les 1 + 13 * nb_joueurs mots de la partie pour le journal, NULL si elle n'est pas journalisée
+ */
+void jouer_partie_auto(const t_strategie *const strategies[], int nb_joueurs, t_alea *alea,
+        int totaux[], uint64_t mots[]) {
+    t_table_joueurs table;
+    t_feuille_compacte feuille, adversaire;
+    int indice, points;
+    uint64_t mot;
+
+    initialiser_table_joueurs(&table, nb_joueurs);
+    if (mots != NULL)
+        *mots++ = mot_partie(nb_joueurs);
+
+    for (int tour = 0; tour < TAILLE_FEUILLE; tour++) {
+        for (int j = 0; j < nb_joueurs; j++) {
+            feuille_table(&table, j, &feuille);
+            if (nb_joueurs == 2)
+                feuille_table(&table, 1 - j, &adversaire);
+            indice = jouer_tour_auto(strategies[j], &feuille, nb_joueurs == 2 ? &adversaire : NULL, alea, &points, &mot);
+            inscrire_table(&table, j, indice, points);
+            if (mots != NULL) {
+                noter_case(&mot, j, indice);
+                *mots++ = mot;
+            }
+        }
+    }
+
+    totaux_table(&table, totaux);
+}
+
+/**
+ * \fn int gagnant_partie(const int totaux[], int nb_joueurs)
+ * \brief Recherche le joueur au meilleur total
+ * \param totaux Le total final de chaque joueur
+ * \param nb_joueurs Le nombre de joueurs
+ * \return Le gagnant, ou -1 si plusieurs joueurs partagent le meilleur total
+ */
+int gagnant_partie(const int totaux[], int nb_joueurs) {
+    int gagnant = 0;
+    bool egalite = false;
+
+    for (int j = 1; j < nb_joueurs; j++) {
+        if (totaux[j] > totaux[gagnant]) {
+            gagnant = j;
+            egalite = false;
+        }
+        else if (totaux[j] == totaux[gagnant]) {
+            egalite = true;
+        }
+    }
+
+    return egalite ? -1 : gagnant;
+}
+
+/**
+ * \struct t_statistiques
+ * \brief Résultats cumulés d'une série de parties simulées
+ */
+typedef struct {
+    int nb_joueurs;                         /**< Nombre de joueurs de chaque partie */
+    long nb_parties;                        /**< Nombre de parties jouées */
+    long egalites;                          /**< Nombre de parties sans gagnant */
+    long victoires[MAX_JOUEURS];            /**< Nombre de victoires de chaque joueur */
+    long long somme[MAX_JOUEURS];           /**< Somme des totaux de chaque joueur */
+    long long somme_carres[MAX_JOUEURS];    /**< Somme des carrés des totaux, pour l'écart type */
+    int minimum[MAX_JOUEURS];               /**< Plus petit total de chaque joueur */
+    int maximum[MAX_JOUEURS];               /**< Plus grand total de chaque joueur */
+} t_statistiques;
+
+/**
+ * \fn void initialiser_statistiques(t_statistiques *stats, int nb_joueurs)
+ * \brief Remet à zéro des statistiques
+ * \param stats Les statistiques
+ * \param nb_joueurs Le nombre de joueurs de chaque partie
+ */
+void initialiser_statistiques(t_statistiques *stats, int nb_joueurs) {
+    memset(stats, 0, sizeof(t_statistiques));
+    stats->nb_joueurs = nb_joueurs;
+    for (int j = 0; j < MAX_JOUEURS; j++) {
+        stats->minimum[j] = INT_MAX;
+        stats->maximum[j] = 0;
+    }
+}
+
+/**
+ * \fn void ajouter_partie(t_statistiques *stats, const int totaux[])
+ * \brief Ajoute le résultat d'une partie aux statistiques
+ * \param stats Les statistiques
+ * \param totaux Le total final de chaque joueur
+ */
+void ajouter_partie(t_statistiques *stats, const int totaux[]) {
+    int gagnant;
+
+    stats->nb_parties++;
+    for (int j = 0; j < stats->nb_joueurs; j++) {
+        stats->somme[j] += totaux[j];
+        stats->somme_carres[j] += (long long)totaux[j] * totaux[j];
+        if (totaux[j] < stats->minimum[j])
+            stats->minimum[j] = totaux[j];
+        if (totaux[j] > stats->maximum[j])
+            stats->maximum[j] = totaux[j];
+    }
+
+    gagnant = gagnant_partie(totaux, stats->nb_joueurs);
+    if (gagnant >= 0)
+        stats->victoires[gagnant]++;
+    else
+        stats->egalites++;
+}
+
+/**
+ * \fn void fusionner_statistiques(t_statistiques *stats, const t_statistiques *autres)
+ * \brief Ajoute les résultats d'une autre série de parties à des statistiques
+ * \param stats Les statistiques complétées
+ * \param autres Les statistiques à ajouter
+ */
+void fusionner_statistiques(t_statistiques *stats, const t_statistiques *autres) {
+    stats->nb_parties += autres->nb_parties;
+    stats->egalites += autres->egalites;
+    for (int j = 0; j < stats->nb_joueurs; j++) {
+        stats->victoires[j] += autres->victoires[j];
+        stats->somme[j] += autres->somme[j];
+        stats->somme_carres[j] += autres->somme_carres[j];
+        if (autres->minimum[j] < stats->minimum[j])
+            stats->minimum[j] = autres->minimum[j];
+        if (autres->maximum[j] > stats->maximum[j])
+            stats->maximum[j] = autres->maximum[j];
+    }
+}
+
+/**
+ * \fn void simuler_parties(long nb_parties, const t_strategie *const strategies[], t_alea *alea, t_statistiques *stats, t_journal *journal)
+ * \brief Joue une série de parties entre stratégies et cumule les résultats
+ * \param nb_parties Le nombre de parties à jouer
+ * \param strategies La stratégie de chaque joueur, autant que de joueurs dans les statistiques
+ * \param alea Le générateur utilisé pour lancer les dés
+ * \param stats Les statistiques, complétées par les parties jouées
+ * \param journal Le journal où ajouter les parties, NULL pour ne pas les garder
+ */
+void simuler_parties(long nb_parties, const t_strategie *const strategies[], t_alea *alea,
+        t_statistiques *stats, t_journal *journal) {
+    const int NB_MOTS = 1 + stats->nb_joueurs * TAILLE_FEUILLE;
+    int totaux[MAX_JOUEURS];
+    uint64_t mots[MAX_MOTS_PARTIE];
+
+    for (long i = 0; i < nb_parties; i++) {
+        jouer_partie_auto(strategies, stats->nb_joueurs, alea, totaux, journal != NULL ? mots : NULL);
+        ajouter_partie(stats, totaux);
+        if (journal != NULL)
+            journaliser_partie(journal, mots, NB_MOTS);
+    }
+
+    if (journal != NULL)
+        vider_journal(journal);
+}
+
+/**
+ * \struct t_travail_simulation
+ * \brief Part d'une simulation confiée à un fil d'exécution
+ */
+typedef struct {
+    _Alignas(64) long nb_parties;               /**< Nombre de parties à jouer, aligné sur une ligne de cache */
+    const t_strategie *const *strategies;       /**< Stratégie de chaque joueur */
+    t_alea alea;                                /**< Flux aléatoire propre au fil */
+    t_statistiques stats;                       /**< Résultats propres au fil */
+    t_journal *journal;                         /**< Tampon du journal propre au fil, NULL sans journal */
+} t_travail_simulation;
+
+/**
+ * \fn void *executer_travail_simulation(void *argument)
+ * \brief Point d'entrée d'un fil de simulation
+ * \param argument Le travail du fil (t_travail_simulation)
+ * \return NULL
+ */
+void *executer_travail_simulation(void *argument) {
+    t_travail_simulation *travail = argument;
+
+    simuler_parties(travail->nb_parties, travail->strategies, &travail->alea, &travail->stats, travail->journal);
+    return NULL;
+}
+
+/**
+ * \fn bool simuler_parties_paralleles(long nb_parties, const t_strategie *const strategies[], uint64_t graine, int nb_fils, int journal, t_statistiques *stats)
+ * \brief Répartit une série de parties entre plusieurs fils d'exécution
+ *
+ * Le fil i joue une part fixe des parties avec le flux aléatoire obtenu en sautant
+ * i fois le générateur initial. Chaque fil cumule ses propres statistiques, fusionnées
+ * dans l'ordre des fils à la fin : pour une même graine et un même nombre de fils,
+ * le résultat est identique d'une exécution à l'autre. Seul l'ordre des parties
+ * dans le journal, où chaque fil ajoute les siennes, peut changer.
+ * \param nb_parties Le nombre de parties à jouer
+ * \param strategies La stratégie de chaque joueur, autant que de joueurs dans les statistiques
+ * \param graine La graine de la simulation
+ * \param nb_fils Le nombre de fils d'exécution
+ * \param journal Le journal donné par ouvrir_ecriture_journal, -1 pour ne pas garder les parties
+ * \param stats Les statistiques, complétées par les parties jouées
+ * \return Vrai si toutes les parties ont été jouées et écrites dans le journal, faux sinon,
+ * sans aucune partie jouée si la mémoire manque
+ */
+bool simuler_parties_paralleles(long nb_parties, const t_strategie *const strategies[],
+        uint64_t graine, int nb_fils, int journal, t_statistiques *stats) {
+    t_travail_simulation *travaux;
+    pthread_t *fils;
+    t_alea alea;
+    bool correct = true;
+
+    // chaque travail occupe ses propres lignes de cache, pour que
+    // les fils ne se ralentissent pas en écrivant côte à côte
+    travaux = aligned_alloc(64, nb_fils * sizeof(t_travail_simulation));
+    fils = malloc(nb_fils * sizeof(pthread_t));
+    for (int i = 0; travaux != NULL && i < nb_fils; i++) {
+        travaux[i].journal = NULL;
+        if (journal >= 0) {
+            travaux[i].journal = malloc(sizeof(t_journal));
+            correct = correct && travaux[i].journal != NULL;
+        }
+    }
+
+    // sans la mémoire de tous les fils, aucune partie n'est jouée
+    if (travaux == NULL || fils == NULL || !correct) {
+        fprintf(stderr, "Pas assez de mémoire pour %d fils d'exécution\n", nb_fils);
+        for (int i = 0; travaux != NULL && i < nb_fils; i++)
+            free(travaux[i].journal);
+        free(fils);
+        free(travaux);
+        return false;
+    }
+
+    initialiser_alea(&alea, graine);
+    for (int i = 0; i < nb_fils; i++) {
+        travaux[i].nb_parties = nb_parties / nb_fils + (i < nb_parties % nb_fils);
+        travaux[i].strategies = strategies;
+        travaux[i].alea = alea;
+        initialiser_statistiques(&travaux[i].stats, stats->nb_joueurs);
+        if (travaux[i].journal != NULL)
+            initialiser_journal(travaux[i].journal, journal);
+        sauter_alea(&alea);
+    }
+
+    attendre_fils(fils, lancer_fils(fils, nb_fils, executer_travail_simulation, travaux, sizeof(t_travail_simulation)));
+    for (int i = 0; i < nb_fils; i++) {
+        fusionner_statistiques(stats, &travaux[i].stats);
+        if (travaux[i].journal != NULL) {
+            correct = correct && !travaux[i].journal->erreur;
+            free(travaux[i].journal);
+        }
+    }
+
+    free(fils);
+    free(travaux);
+
+    return correct;
+}
+
+/**
+ * \fn void afficher_statistiques(const t_statistiques *stats, const t_strategie *const strategies[], double duree)
+ * \brief Affiche le bilan d'une simulation
+ * \param stats Les statistiques de la simulation
+ * \param strategies La stratégie de chaque joueur
+ * \param duree La durée de la simulation, en secondes
+ */
+void afficher_statistiques(const t_statistiques *stats, const t_strategie *const strategies[], double duree) {
+    double moyenne, variance;
+
+    printf("%ld parties simulées en %.3f s (%.0f parties/s)\n",
+        stats->nb_parties, duree, stats->nb_parties / duree);
+
+    for (int j = 0; j < stats->nb_joueurs; j++) {
+        moyenne = (double)stats->somme[j] / stats->nb_parties;
+        variance = (double)stats->somme_carres[j] / stats->nb_parties - moyenne * moyenne;
+        printf("Joueur %d (%s) : moyenne %.2f, écart type %.2f, min %d, max %d, victoires %.2f %%\n",
+            j+1, strategies[j]->nom, moyenne, sqrt(variance), stats->minimum[j], stats->maximum[j],
+            100.0 * stats->victoires[j] / stats->nb_parties);
+    }
+    printf("Egalités : %.2f %%\n", 100.0 * stats->egalites / stats->nb_parties);
+}
+
+/**
+ * \fn double horloge()
+ * \brief Donne le temps écoulé depuis une origine fixe, pour mesurer des durées
+ * \return Le temps en secondes
+ */
+double horloge() {
+    struct timespec instant;
+
+    clock_gettime(CLOCK_MONOTONIC, &instant);
+    return instant.tv_sec + instant.tv_nsec * 1e-9;
+}
+
+/**
+ * \def MAX_PARTICIPANTS
+ * \brief Nombre maximum de participants d'un tournoi
+ */
+#define MAX_PARTICIPANTS 64
+
+/**
+ * \enum t_format_tournoi
+ * \brief Manière d'apparier les participants d'un tournoi
+ */
+typedef enum {
+    TOURNOI_TOUTES_RONDES,  /**< Chaque participant rencontre tous les autres */
+    TOURNOI_SUISSE          /**< A chaque ronde, les participants de même score se rencontrent */
+} t_format_tournoi;
+
+/**
+ * \struct t_participant
+ * \brief Participant d'un tournoi et ses résultats cumulés
+ */
+typedef struct {
+    const t_strategie *strategie;   /**< Stratégie qui joue pour le participant */
+    double points;                  /**< 1 par rencontre gagnée ou exemptée, 0,5 par rencontre nulle */
+    bool exempte;                   /**< Le participant a déjà été exempté d'une ronde suisse */
+    long nb_parties;                /**< Nombre de parties jouées */
+    long victoires;                 /**< Nombre de parties gagnées */
+    long egalites;                  /**< Nombre de parties nulles */
+    long long somme;                /**< Somme des totaux */
+    long long somme_carres;         /**< Somme des carrés des totaux */
+} t_participant;
+
+/**
+ * \struct t_rencontre
+ * \brief Série de parties entre deux participants d'un tournoi
+ */
+typedef struct {
+    int participants[2];                /**< Indices des deux participants */
+    const t_strategie *strategies[2];   /**< Leurs stratégies */
+    long nb_parties;                    /**< Nombre de parties de la rencontre */
+    uint64_t graine;                    /**< Graine propre à la rencontre */
+    t_statistiques stats;               /**< Résultats, le joueur j étant participants[j] */
+} t_rencontre;
+
+/**
+ * \fn void jouer_rencontre(t_rencontre *rencontre)
+ * \brief Joue toutes les parties d'une rencontre
+ *
+ * Les participants échangent leur place à chaque partie, pour que l'ordre de
+ * jeu ne favorise aucun d'eux.
+ * \param rencontre La rencontre
+ */
+void jouer_rencontre(t_rencontre *rencontre) {
+    const t_strategie *places[2];
+    int totaux[2], resultat[2];
+    int premier;
+    t_alea alea;
+
+    initialiser_alea(&alea, rencontre->graine);
+    initialiser_statistiques(&rencontre->stats, 2);
+
+    for (long i = 0; i < rencontre->nb_parties; i++) {
+        premier = i % 2;
+        places[0] = rencontre->strategies[premier];
+        places[1] = rencontre->strategies[1 - premier];
+        jouer_partie_auto(places, 2, &alea, totaux, NULL);
+
+        resultat[premier] = totaux[0];
+        resultat[1 - premier] = totaux[1];
+        ajouter_partie(&rencontre->stats, resultat);
+    }
+}
+
+/**
+ * \struct t_ronde_tournoi
+ * \brief Rencontres d'une ronde, jouées en parallèle
+ */
+typedef struct {
+    t_rencontre *rencontres;    /**< Les rencontres de la ronde */
+    int nb_rencontres;          /**< Le nombre de rencontres */
+    int prochaine;              /**< La prochaine rencontre à jouer, partagée entre les fils */
+} t_ronde_tournoi;
+
+/**
+ * \fn void *executer_ronde_tournoi(void *argument)
+ * \brief Point d'entrée d'un fil du tournoi : joue des rencontres tant qu'il en reste
+ * \param argument La ronde à jouer (t_ronde_tournoi)
+ * \return NULL
+ */
+void *executer_ronde_tournoi(void *argument) {
+    t_ronde_tournoi *ronde = argument;
+    int i;
+
+    while ((i = __atomic_fetch_add(&ronde->prochaine, 1, __ATOMIC_RELAXED)) < ronde->nb_rencontres)
+        jouer_rencontre(&ronde->rencontres[i]);
+
+    return NULL;
+}
+
+/**
+ * \fn void jouer_ronde_tournoi(t_rencontre rencontres[], int nb_rencontres, int nb_fils)
+ * \brief Joue les rencontres d'une ronde sur plusieurs fils d'exécution
+ *
+ * Chaque rencontre a sa propre graine, si bien que les résultats ne dépendent
+ * ni du nombre de fils ni de l'ordre dans lequel ils prennent les rencontres.
+ * \param rencontres Les rencontres
+ * \param nb_rencontres Le nombre de rencontres
+ * \param nb_fils Le nombre de fils d'exécution
+ */
+void jouer_ronde_tournoi(t_rencontre rencontres[], int nb_rencontres, int nb_fils) {
+    t_ronde_tournoi ronde;
+    pthread_t *fils;
+
+    if (nb_fils > nb_rencontres)
+        nb_fils = nb_rencontres;
+    fils = malloc(nb_fils * sizeof(pthread_t));
+
+    ronde.rencontres = rencontres;
+    ronde.nb_rencontres = nb_rencontres;
+    ronde.prochaine = 0;
+    attendre_fils(fils, lancer_fils(fils, nb_fils, executer_ronde_tournoi, &ronde, 0));
+
+    free(fils);
+}
+
+/**
+ * \fn void compter_rencontre(t_participant participants[], const t_rencontre *rencontre)
+ * \brief Ajoute les résultats d'une rencontre jouée à ses deux participants
+ * \param participants Les participants du tournoi
+ * \param rencontre La rencontre
+ */
+void compter_rencontre(t_participant participants[], const t_rencontre *rencontre) {
+    const t_statistiques *stats = &rencontre->stats;
+    t_participant *participant;
+
+    for (int j = 0; j < 2; j++) {
+        participant = &participants[rencontre->participants[j]];
+        participant->nb_parties += stats->nb_parties;
+        participant->victoires += stats->victoires[j];
+        participant->egalites += stats->egalites;
+        participant->somme += stats->somme[j];
+        participant->somme_carres += stats->somme_carres[j];
+
+        // la rencontre revient à celui qui a gagné le plus de parties
+        if (stats->victoires[j] > stats->victoires[1 - j])
+            participant->points += 1;
+        else if (stats->victoires[j] == stats->victoires[1 - j])
+            participant->points += 0.5;
+    }
+}
+
+/**
+ * \fn double taux_victoires(const t_participant *participant)
+ * \brief Donne la part des parties gagnées, une partie nulle comptant pour moitié
+ * \param participant Le participant
+ * \return La part des parties gagnées, entre 0 et 1
+ */
+double taux_victoires(const t_participant *participant) {
+    return (participant->victoires + 0.5 * participant->egalites) / participant->nb_parties;
+}
+
+/**
+ * \fn void classer_participants(const t_participant participants[], int nb_participants, int classement[])
+ * \brief Range les participants par points, puis par part de parties gagnées
+ * \param participants Les participants
+ * \param nb_participants Le nombre de participants
+ * \param classement Les indices des participants, du premier au dernier
+ */
+void classer_participants(const t_participant participants[], int nb_participants, int classement[]) {
+    int courant, j;
+
+    // tri par insertion, stable pour que l'ordre de départ départage les ex aequo
+    for (int i = 0; i < nb_participants; i++) {
+        courant = i;
+        for (j = i; j > 0; j--) {
+            const t_participant *a = &participants[classement[j - 1]];
+            const t_participant *b = &participants[courant];
+            bool avant = b->points > a->points;
+            if (b->points == a->points && b->nb_parties > 0 && a->nb_parties > 0)
+                avant = taux_victoires(b) > taux_victoires(a);
+            if (!avant)
+                break;
+            classement[j] = classement[j - 1];
+        }
+        classement[j] = courant;
+    }
+}
+
+/**
+ * \fn int apparier_suisse(t_participant participants[], int nb_participants, bool deja_rencontres[MAX_PARTICIPANTS][MAX_PARTICIPANTS], int paires[][2])
+ * \brief Apparie les participants d'une ronde suisse
+ *
+ * Dans l'ordre du classement, chaque participant rencontre le suivant qu'il
+ * n'a pas encore rencontré, ou à défaut le suivant libre. Avec un nombre
+ * impair de participants, le dernier classé qui n'a jamais été exempté gagne
+ * la ronde sans jouer.
+ * \param participants Les participants
+ * \param nb_participants Le nombre de participants
+ * \param deja_rencontres Vrai pour chaque paire de participants qui se sont déjà rencontrés
+ * \param paires Les paires de la ronde
+ * \return Le nombre de paires
+ */
+int apparier_suisse(t_participant participants[], int nb_participants,
+        bool deja_rencontres[MAX_PARTICIPANTS][MAX_PARTICIPANTS], int paires[][2]) {
+    int classement[MAX_PARTICIPANTS];
+    bool apparie[MAX_PARTICIPANTS] = {false};
+    int nb_paires = 0;
+    int i, j, adversaire, exempt;
+
+    classer_participants(participants, nb_participants, classement);
+
+    if (nb_participants % 2 == 1) {
+        exempt = classement[nb_participants - 1];
+        for (i = nb_participants - 1; i >= 0; i--) {
+            if (!participants[classement[i]].exempte) {
+                exempt = classement[i];
+                break;
+            }
+        }
+        apparie[exempt] = true;
+        participants[exempt].exempte = true;
+        participants[exempt].points += 1;
+    }
+
+    for (i = 0; i < nb_participants; i++) {
+        if (apparie[classement[i]])
+            continue;
+
+        adversaire = -1;
+        for (j = i + 1; j < nb_participants; j++) {
+            if (apparie[classement[j]])
+                continue;
+            if (adversaire == -1)
+                adversaire = j;
+            if (!deja_rencontres[classement[i]][classement[j]]) {
+                adversaire = j;
+                break;
+            }
+        }
+
+        apparie[classement[i]] = true;
+        apparie[classement[adversaire]] = true;
+        paires[nb_paires][0] = classement[i];
+        paires[nb_paires][1] = classement[adversaire];
+        nb_paires++;
+    }
+
+    return nb_paires;
+}
+
+/**
+ * \enum t_mode
+ * \brief Mode de fonctionnement du programme
+ */
+typedef enum {
+    MODE_INTERACTIF,    /**< Partie au clavier */
+    MODE_SIMULATION,    /**< Parties entre stratégies, sans affichage */
+    MODE_SOLVEUR,       /**< Calcul de la stratégie optimale */
+    MODE_BENCHMARK,     /**< Mesure des performances */
+    MODE_SERVEUR,       /**< Parties servies sur une socket */
+    MODE_CHARGE,        /**< Générateur de charge pour le serveur */
+    MODE_TOURNOI,       /**< Tournoi entre stratégies */
+    MODE_JOURNAL,       /**< Lecture d'un journal de parties */
+    MODE_VERIFICATION,  /**< Vérification d'un journal de parties */
+    MODE_ANALYSE,       /**< Analyse des décisions des joueurs d'un journal */
+    MODE_DISTRIBUTION,  /**< Loi exacte du total d'une stratégie */
+    MODE_FINALE,        /**< Construction de la table de fin de partie */
+    MODE_SPECTATEUR,    /**< Suivi des parties diffusées par un autre processus */
+    MODE_PROTOCOLE      /**< Parties du protocole du serveur sur l'entrée et la sortie standard */
+} t_mode;
+
+/**
+ * \struct t_options
+ * \brief Options de la ligne de commande
+ */
+typedef struct {
+    t_mode mode;                                /**< Mode de fonctionnement */
+    long nb_simulations;                        /**< Nombre de parties à simuler */
+    int nb_joueurs;                             /**< Nombre de joueurs de chaque partie */
+    const t_strategie *strategies[MAX_JOUEURS]; /**< Stratégie de chaque joueur simulé */
+    int nb_fils;                                /**< Nombre de fils d'exécution */
+    uint64_t graine;                            /**< Graine du générateur aléatoire */
+    const char *fichier_table;                  /**< Table optimale à projeter, NULL pour la calculer */
+    const char *fichier_sortie;                 /**< Fichier où enregistrer la table ou les mesures */
+    const char *filtre;                         /**< Texte du nom des mesures à faire, NULL pour toutes */
+    double duree_min;                           /**< Durée minimale de chaque mesure, en secondes */
+    const char *adresse;                        /**< Socket du serveur : chemin Unix ou [hote:]port TCP */
+    int nb_sessions;                            /**< Nombre d'emplacements de session du serveur */
+    int nb_clients;                             /**< Nombre de connexions du générateur de charge */
+    int nb_parties;                             /**< Nombre de parties par connexion ou par rencontre */
+    int nb_participants;                        /**< Nombre de participants du tournoi */
+    const t_strategie *participants[MAX_PARTICIPANTS]; /**< Stratégie de chaque participant */
+    t_format_tournoi format_tournoi;            /**< Appariement des participants */
+    int nb_rondes;                              /**< Nombre de rondes du tournoi, 0 pour le choisir */
+    const char *fichier_journal;                /**< Journal où ajouter les parties, ou à lire, NULL sans journal */
+    const char *fichier_finale;                 /**< Table de fin de partie à projeter, NULL sans table */
+    int nb_plis;                                /**< Nombre de plis de fin de partie à résoudre */
+    const char *nom_diffusion;                  /**< Anneau de diffusion à créer ou à suivre, NULL sans diffusion */
+    const char *fichier_compteurs;              /**< Fichier des compteurs de l'instrumentation, NULL sans compteurs */
+    double periode_compteurs;                   /**< Période d'écriture des compteurs en secondes, 0 sur SIGUSR1 seulement */
+} t_options;
+
+/**
+ * \fn void afficher_usage(const char programme[])
+ * \brief Affiche les options de la ligne de commande
+ * \param programme Le nom du programme
+ */
+void afficher_usage(const char programme[]) {
+    fprintf(stderr, "Usage : %s [--players N] [--log FICHIER] [--broadcast NOM]        partie au clavier\n", programme);
+    fprintf(stderr, "        %s --simulate N [--players N] [--strategy S1[,S2...]] [--threads T] [--seed G] [--table FICHIER]\n", programme);
+    fprintf(stderr, "           [--endgame FICHIER] [--log FICHIER]\n");
+    fprintf(stderr, "        %s --tournament S1,S2[,S3...] [--format round-robin|swiss] [--rounds R] [--games N]\n", programme);
+    fprintf(stderr, "           [--threads T] [--seed G] [--table FICHIER] [--endgame FICHIER]\n");
+    fprintf(stderr, "        %s --solve [--threads T] [--output FICHIER]\n", programme);
+    fprintf(stderr, "        %s --distribution [--strategy S] [--threads T] [--table FICHIER] [--output FICHIER]\n", programme);
+    fprintf(stderr, "        %s --build-endgame --output FICHIER [--plies N] [--threads T] [--table FICHIER]\n", programme);
+    fprintf(stderr, "        %s --benchmark [--filter TEXTE] [--min-time S] [--output FICHIER.json]\n", programme);
+    fprintf(stderr, "        %s --serve ADRESSE [--sessions N] [--seed G] [--log FICHIER] [--broadcast NOM]\n", programme);
+    fprintf(stderr, "        %s --stdio [--seed G] [--log FICHIER] [--broadcast NOM]\n", programme);
+    fprintf(stderr, "        %s --watch NOM\n", programme);
+    fprintf(stderr, "        %s --load ADRESSE [--clients N] [--games N] [--strategy S] [--seed G]\n", programme);
+    fprintf(stderr, "        %s --read-log FICHIER\n", programme);
+    fprintf(stderr, "        %s --verify-log FICHIER [--threads T]\n", programme);
+    fprintf(stderr, "        %s --analyze-log FICHIER[,FICHIER...] [--threads T] [--table FICHIER]\n", programme);
+    fprintf(stderr, "Avec -DYAMS_INSTRUMENTATION, tous les modes acceptent [--counters FICHIER.json [--counters-every S]]\n");
+    fprintf(stderr, "Adresse : chemin d'une socket Unix, ou [hote:]port TCP (127.0.0.1 par défaut)\n");
+    fprintf(stderr, "Stratégies :");
+    for (size_t i = 0; i < sizeof(STRATEGIES) / sizeof(STRATEGIES[0]); i++)
+        fprintf(stderr, " %s", STRATEGIES[i].nom);
+    fprintf(stderr, "\n");
+}
+
+/**
+ * \fn int lire_strategies(const char texte[], const t_strategie *strategies[], int max)
+ * \brief Lit une liste de stratégies séparées par des virgules
+ * \param texte Le texte de l'option
+ * \param strategies Les stratégies lues, dans l'ordre
+ * \param max Le nombre maximum de stratégies
+ * \return Le nombre de stratégies lues, 0 si l'une n'existe pas ou s'il y en a trop
+ */
+int lire_strategies(const char texte[], const t_strategie *strategies[], int max) {
+    char copie[512];
+    char *nom_strategie, *suite;
+    int nb_strategies = 0;
+
+    if (strlen(texte) >= sizeof(copie))
+        return 0;
+    strcpy(copie, texte);
+
+    nom_strategie = strtok_r(copie, ",", &suite);
+    while (nom_strategie != NULL) {
+        if (nb_strategies == max)
+            return 0;
+        strategies[nb_strategies] = rechercher_strategie(nom_strategie);
+        if (strategies[nb_strategies] == NULL)
+            return 0;
+        nb_strategies++;
+        nom_strategie = strtok_r(NULL, ",", &suite);
+    }
+
+    return nb_strategies;
+}
+
+/**
+ * \fn bool lire_options(int argc, char *argv[], t_options *options)
+ * \brief Lit les options de la ligne de commande
+ * \param argc Le nombre d'arguments
+ * \param argv Les arguments
+ * \param options Les options lues
+ * \return Vrai si les options sont correctes, faux sinon
+ */
+bool lire_options(int argc, char *argv[], t_options *options) {
+    bool correct = true;
+    int nb_strategies = 1;
+    char *fin;
+
+    options->mode = MODE_INTERACTIF;
+    options->nb_simulations = 0;
+    options->nb_joueurs = 0;
+    options->strategies[0] = &STRATEGIES[0];
+    options->nb_fils = sysconf(_SC_NPROCESSORS_ONLN);
+    if (options->nb_fils < 1)
+        options->nb_fils = 1;
+    options->graine = time(NULL);
+    options->fichier_table = NULL;
+    options->fichier_sortie = NULL;
+    options->filtre = NULL;
+    options->duree_min = 0.5;
+    options->adresse = NULL;
+    options->nb_sessions = 1024;
+    options->nb_clients = 100;
+    options->nb_parties = 0;
+    options->nb_participants = 0;
+    options->format_tournoi = TOURNOI_TOUTES_RONDES;
+    options->nb_rondes = 0;
+    options->fichier_journal = NULL;
+    options->fichier_finale = NULL;
+    options->nb_plis = 2;
+    options->nom_diffusion = NULL;
+    options->fichier_compteurs = NULL;
+    options->periode_compteurs = 0;
+
+    for (int i = 1; i < argc && correct; i++) {
+        if (strcmp(argv[i], "--solve") == 0) {
+            options->mode = MODE_SOLVEUR;
+        }
+        else if (strcmp(argv[i], "--benchmark") == 0) {
+            options->mode = MODE_BENCHMARK;
+        }
+        else if (strcmp(argv[i], "--stdio") == 0) {
+            options->mode = MODE_PROTOCOLE;
+        }
+        // les autres options attendent une valeur
+        else if (i + 1 >= argc) {
+            correct = false;
+        }
+        else if (strcmp(argv[i], "--simulate") == 0) {
+            options->mode = MODE_SIMULATION;
+            options->nb_simulations = strtol(argv[++i], &fin, 10);
+            correct = (*fin == '\0' && options->nb_simulations > 0);
+        }
+        else if (strcmp(argv[i], "--strategy") == 0) {
+            nb_strategies = lire_strategies(argv[++i], options->strategies, MAX_JOUEURS);
+            correct = nb_strategies > 0;
+        }
+        else if (strcmp(argv[i], "--players") == 0) {
+            options->nb_joueurs = strtol(argv[++i], &fin, 10);
+            correct = (*fin == '\0' && options->nb_joueurs > 0 && options->nb_joueurs <= MAX_JOUEURS);
+        }
+        else if (strcmp(argv[i], "--tournament") == 0) {
+            options->mode = MODE_TOURNOI;
+            options->nb_participants = lire_strategies(argv[++i], options->participants, MAX_PARTICIPANTS);
+            correct = options->nb_participants >= 2;
+        }
+        else if (strcmp(argv[i], "--format") == 0) {
+            i++;
+            if (strcmp(argv[i], "round-robin") == 0)
+                options->format_tournoi = TOURNOI_TOUTES_RONDES;
+            else if (strcmp(argv[i], "swiss") == 0)
+                options->format_tournoi = TOURNOI_SUISSE;
+            else
+                correct = false;
+        }
+        else if (strcmp(argv[i], "--log") == 0) {
+            options->fichier_journal = argv[++i];
+        }
+        else if (strcmp(argv[i], "--read-log") == 0) {
+            options->mode = MODE_JOURNAL;
+            options->fichier_journal = argv[++i];
+        }
+        else if (strcmp(argv[i], "--verify-log") == 0) {
+            options->mode = MODE_VERIFICATION;
+            options->fichier_journal = argv[++i];
+        }
+        else if (strcmp(argv[i], "--build-endgame") == 0) {
+            options->mode = MODE_FINALE;
+        }
+        else if (strcmp(argv[i], "--plies") == 0) {
+            options->nb_plis = strtol(argv[++i], &fin, 10);
+            correct = (*fin == '\0' && options->nb_plis >= 1 && options->nb_plis <= MAX_PLIS_FINALE);
+        }
+        else if (strcmp(argv[i], "--endgame") == 0) {
+            options->fichier_finale = argv[++i];
+        }
+        else if (strcmp(argv[i], "--distribution") == 0) {
+            options->mode = MODE_DISTRIBUTION;
+        }
+        else if (strcmp(argv[i], "--analyze-log") == 0) {
+            options->mode = MODE_ANALYSE;
+            options->fichier_journal = argv[++i];
+        }
+        else if (strcmp(argv[i], "--rounds") == 0) {
+            options->nb_rondes = strtol(argv[++i], &fin, 10);
+            correct = (*fin == '\0' && options->nb_rondes > 0);
+        }
+        else if (strcmp(argv[i], "--threads") == 0) {
+            options->nb_fils = strtol(argv[++i], &fin, 10);
+            correct = (*fin == '\0' && options->nb_fils > 0);
+        }
+        else if (strcmp(argv[i], "--table") == 0) {
+            options->fichier_table = argv[++i];
+        }
+        else if (strcmp(argv[i], "--output") == 0) {
+            options->fichier_sortie = argv[++i];
+        }
+        else if (strcmp(argv[i], "--filter") == 0) {
+            options->filtre = argv[++i];
+        }
+        else if (strcmp(argv[i], "--min-time") == 0) {
+            options->duree_min = strtod(argv[++i], &fin);
+            correct = (*fin == '\0' && options->duree_min > 0);
+        }
+        else if (strcmp(argv[i], "--serve") == 0) {
+            options->mode = MODE_SERVEUR;
+            options->adresse = argv[++i];
+        }
+        else if (strcmp(argv[i], "--load") == 0) {
+            options->mode = MODE_CHARGE;
+            options->adresse = argv[++i];
+        }
+        else if (strcmp(argv[i], "--broadcast") == 0) {
+            options->nom_diffusion = argv[++i];
+        }
+        else if (strcmp(argv[i], "--watch") == 0) {
+            options->mode = MODE_SPECTATEUR;
+            options->nom_diffusion = argv[++i];
+        }
+        else if (strcmp(argv[i], "--counters") == 0) {
+            options->fichier_compteurs = argv[++i];
+        }
+        else if (strcmp(argv[i], "--counters-every") == 0) {
+            options->periode_compteurs = strtod(argv[++i], &fin);
+            correct = (*fin == '\0' && options->periode_compteurs > 0);
+        }
+        else if (strcmp(argv[i], "--sessions") == 0) {
+            options->nb_sessions = strtol(argv[++i], &fin, 10);
+            correct = (*fin == '\0' && options->nb_sessions > 0);
+        }
+        else if (strcmp(argv[i], "--clients") == 0) {
+            options->nb_clients = strtol(argv[++i], &fin, 10);
+            correct = (*fin == '\0' && options->nb_clients > 0);
+        }
+        else if (strcmp(argv[i], "--games") == 0) {
+            options->nb_parties = strtol(argv[++i], &fin, 10);
+            correct = (*fin == '\0' && options->nb_parties > 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0) {
+            options->graine = strtoull(argv[++i], &fin, 10);
+            correct = (*fin == '\0');
+        }
+        else {
+            correct = false;
+        }
+    }
+
+    // une seule stratégie joue pour tous les joueurs,
+    // une liste donne le nombre de joueurs s'il n'est pas précisé
+    if (nb_strategies == 1) {
+        if (options->nb_joueurs == 0)
+            options->nb_joueurs = NB_JOUEURS;
+        for (int j = 1; j < options->nb_joueurs; j++)
+            options->strategies[j] = options->strategies[0];
+    }
+    else if (options->nb_joueurs == 0) {
+        options->nb_joueurs = nb_strategies;
+    }
+    else if (options->nb_joueurs != nb_strategies) {
+        correct = false;
+    }
+
+    if (options->nb_parties == 0)
+        options->nb_parties = options->mode == MODE_TOURNOI ? 1000 : 10;
+
+    // les compteurs ne sont écrits que dans un fichier
+    if (options->periode_compteurs > 0 && options->fichier_compteurs == NULL)
+        correct = false;
+
+    // la table de fin de partie construite doit être enregistrée
+    if (options->mode == MODE_FINALE && options->fichier_sortie == NULL)
+        correct = false;
+
+    // seules les parties menées par t_machine_partie sont diffusées
+    if (options->nom_diffusion != NULL && options->mode != MODE_SPECTATEUR
+            && options->mode != MODE_INTERACTIF && options->mode != MODE_SERVEUR && options->mode != MODE_PROTOCOLE)
+        correct = false;
+
+    if (!correct)
+        afficher_usage(argv[0]);
+
+    return correct;
+}
+
+/**
+ * \fn float *calculer_table_optimale(int nb_fils)
+ * \brief Alloue et résout la table des espérances de la stratégie optimale
+ * \param nb_fils Le nombre de fils d'exécution du solveur
+ * \return La table, à libérer avec free, ou NULL si la mémoire manque
+ */
+float *calculer_table_optimale(int nb_fils) {
+    float *esperances;
+
+    esperances = malloc(NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float));
+    if (esperances != NULL && !resoudre_strategie_optimale(esperances, nb_fils)) {
+        free(esperances);
+        esperances = NULL;
+    }
+    if (esperances == NULL)
+        fprintf(stderr, "Pas assez de mémoire pour la table optimale (%.1f Mo)\n",
+            NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float) / 1e6);
+
+    return esperances;
+}
+
+/**
+ * \fn bool mode_solveur(const t_options *options)
+ * \brief Calcule la stratégie optimale et affiche l'espérance d'une partie
+ * \param options Les options de la ligne de commande
+ * \return Vrai si la table est résolue, faux si la mémoire manque
+ */
+bool mode_solveur(const t_options *options) {
+    float *esperances;
+    double debut;
+
+    debut = horloge();
+    esperances = calculer_table_optimale(options->nb_fils);
+    if (esperances == NULL)
+        return false;
+
+    printf("Espérance de la stratégie optimale : %.4f points\n", esperances[0]);
+    printf("Résolu en %.2f s avec %d fils d'exécution\n", horloge() - debut, options->nb_fils);
+
+    if (options->fichier_sortie != NULL && enregistrer_table_optimale(options->fichier_sortie, esperances))
+        printf("Table enregistrée dans %s\n", options->fichier_sortie);
+
+    free(esperances);
+    return true;
+}
+
+/**
+ * \fn bool preparer_strategie_optimale(const t_options *options, const t_strategie *const strategies[], int nb_strategies, t_table_optimale *table)
+ * \brief Donne à la stratégie optimale la table du solveur, si l'une des stratégies l'utilise
+ *
+ * La table est projetée depuis le fichier de l'option --table, ou calculée sur place.
+ * \param options Les options de la ligne de commande
+ * \param strategies Les stratégies qui vont jouer
+ * \param nb_strategies Le nombre de stratégies
+ * \param table La table projetée, à rendre avec liberer_strategie_optimale
+ * \return Vrai si la stratégie optimale est prête ou inutile, faux si la table est inutilisable
+ */
+bool preparer_strategie_optimale(const t_options *options, const t_strategie *const strategies[],
+        int nb_strategies, t_table_optimale *table) {
+    t_strategie *optimale;
+    bool utilisee = false;
+
+    table->projection = NULL;
+    optimale = rechercher_strategie("optimal");
+    for (int j = 0; j < nb_strategies; j++)
+        utilisee = utilisee || strategies[j] == optimale;
+
+    if (!utilisee)
+        return true;
+    if (options->fichier_table == NULL)
+        optimale->contexte = calculer_table_optimale(options->nb_fils);
+    else if (ouvrir_table_optimale(options->fichier_table, table))
+        optimale->contexte = (void *)table->esperances;
+
+    return optimale->contexte != NULL;
+}
+
+/**
+ * \fn void liberer_strategie_optimale(t_table_optimale *table)
+ * \brief Rend la table de la stratégie optimale, projetée ou calculée
+ * \param table La table donnée par preparer_strategie_optimale
+ */
+void liberer_strategie_optimale(t_table_optimale *table) {
+    t_strategie *optimale = rechercher_strategie("optimal");
+
+    if (table->projection != NULL)
+        fermer_table_optimale(table);
+    else
+        free(optimale->contexte);
+    optimale->contexte = NULL;
+}
+
+/**
+ * \fn bool preparer_strategie_victoire(const t_options *options, const t_strategie *const strategies[], int nb_strategies, t_finale *finale)
+ * \brief Donne à la stratégie win la table de fin de partie de l'option --endgame, si l'une des stratégies l'utilise
+ * \param options Les options de la ligne de commande
+ * \param strategies Les stratégies qui vont jouer
+ * \param nb_strategies Le nombre de stratégies
+ * \param finale La table projetée, à rendre avec liberer_strategie_victoire
+ * \return Vrai si la stratégie win est prête ou inutile, faux si la table manque ou est inutilisable
+ */
+bool preparer_strategie_victoire(const t_options *options, const t_strategie *const strategies[],
+        int nb_strategies, t_finale *finale) {
+    t_strategie *victoire;
+    bool utilisee = false;
+
+    finale->bloc = NULL;
+    victoire = rechercher_strategie("win");
+    for (int j = 0; j < nb_strategies; j++)
+        utilisee = utilisee || strategies[j] == victoire;
+
+    if (!utilisee)
+        return true;
+    if (options->fichier_finale == NULL) {
+        fprintf(stderr, "La stratégie win demande une table de fin de partie (--endgame FICHIER)\n");
+        return false;
+    }
+    if (!ouvrir_finale(options->fichier_finale, finale))
+        return false;
+
+    victoire->contexte = finale;
+    return true;
+}
+
+/**
+ * \fn void liberer_strategie_victoire(t_finale *finale)
+ * \brief Rend la table de fin de partie de la stratégie win
+ * \param finale La table donnée par preparer_strategie_victoire
+ */
+void liberer_strategie_victoire(t_finale *finale) {
+    if (finale->bloc != NULL)
+        fermer_finale(finale);
+    rechercher_strategie("win")->contexte = NULL;
+}
+
+/**
+ * \fn bool mode_simulation(const t_options *options)
+ * \brief Simule des parties entre stratégies et affiche le bilan
+ * \param options Les options de la ligne de commande
+ * \return Vrai si la simulation a eu lieu, faux si la table optimale ou le journal sont inutilisables
+ */
+bool mode_simulation(const t_options *options) {
+    t_statistiques stats;
+    t_table_optimale table;
+    t_finale finale;
+    int journal = -1;
+    bool journal_complet;
+    double debut;
+
+    if (options->fichier_journal != NULL) {
+        journal = ouvrir_ecriture_journal(options->fichier_journal);
+        if (journal < 0)
+            return false;
+    }
+
+    if (!preparer_strategie_optimale(options, options->strategies, options->nb_joueurs, &table)) {
+        if (journal >= 0)
+            close(journal);
+        return false;
+    }
+    if (!preparer_strategie_victoire(options, options->strategies, options->nb_joueurs, &finale)) {
+        liberer_strategie_optimale(&table);
+        if (journal >= 0)
+            close(journal);
+        return false;
+    }
+
+    initialiser_statistiques(&stats, options->nb_joueurs);
+
+    debut = horloge();
+    journal_complet = simuler_parties_paralleles(options->nb_simulations, options->strategies,
+        options->graine, options->nb_fils, journal, &stats);
+    if (stats.nb_parties == 0) {
+        liberer_strategie_victoire(&finale);
+        liberer_strategie_optimale(&table);
+        if (journal >= 0)
+            close(journal);
+        return false;
+    }
+
+    printf("Graine %llu, %d fils d'exécution\n", (unsigned long long)options->graine, options->nb_fils);
+    afficher_statistiques(&stats, options->strategies, horloge() - debut);
+
+    liberer_strategie_victoire(&finale);
+    liberer_strategie_optimale(&table);
+    if (journal >= 0) {
+        close(journal);
+        if (!journal_complet)
+            fprintf(stderr, "Erreur d'écriture de %s, des parties manquent\n", options->fichier_journal);
+    }
+
+    return journal_complet;
+}
+
+/**
+ * \fn void afficher_classement(const t_participant participants[], int nb_participants)
+ * \brief Affiche le classement d'un tournoi avec les intervalles de confiance à 95 %
+ *
+ * L'intervalle de la part de victoires est celui de Wilson, qui reste juste
+ * près de 0 et de 1 ; celui de la moyenne suppose les totaux de loi normale.
+ * \param participants Les participants
+ * \param nb_participants Le nombre de participants
+ */
+void afficher_classement(const t_participant participants[], int nb_participants) {
+    const double z = 1.96;
+    int classement[MAX_PARTICIPANTS];
+    const t_participant *participant;
+    double n, taux, centre, marge, moyenne, ecart_type;
+
+    classer_participants(participants, nb_participants, classement);
+
+    printf("Rang  N°  Stratégie   Points   Parties  Victoires (IC 95 %%)        Moyenne (IC 95 %%)\n");
+    for (int i = 0; i < nb_participants; i++) {
+        participant = &participants[classement[i]];
+        n = participant->nb_parties;
+        if (n == 0) {
+            printf("%4d  %2d  %-10s %7.1f %9d\n", i+1, classement[i]+1, participant->strategie->nom,
+                participant->points, 0);
+            continue;
+        }
+
+        taux = taux_victoires(participant);
+        centre = (taux + z * z / (2 * n)) / (1 + z * z / n);
+        marge = z * sqrt(taux * (1 - taux) / n + z * z / (4 * n * n)) / (1 + z * z / n);
+
+        moyenne = participant->somme / n;
+        ecart_type = sqrt(fmax(participant->somme_carres / n - moyenne * moyenne, 0));
+
+        printf("%4d  %2d  %-10s %7.1f %9.0f  %6.2f %% [%6.2f ; %6.2f]  %7.2f [%7.2f ; %7.2f]\n",
+            i+1, classement[i]+1, participant->strategie->nom, participant->points, n,
+            100 * taux, 100 * (centre - marge), 100 * (centre + marge),
+            moyenne, moyenne - z * ecart_type / sqrt(n), moyenne + z * ecart_type / sqrt(n));
+    }
+}
+
+/**
+ * \fn bool mode_tournoi(const t_options *options)
+ * \brief Fait s'affronter des stratégies en tournoi et affiche le classement
+ *
+ * Chaque rencontre oppose deux participants sur --games parties. En toutes
+ * rondes, chaque ronde fait se rencontrer tous les participants deux à deux ;
+ * en suisse, chaque ronde les apparie d'après le classement de la précédente.
+ * \param options Les options de la ligne de commande
+ * \return Vrai si le tournoi a eu lieu, faux si la table optimale est inutilisable
+ */
+bool mode_tournoi(const t_options *options) {
+    static bool deja_rencontres[MAX_PARTICIPANTS][MAX_PARTICIPANTS];
+    const int nb_participants = options->nb_participants;
+    t_participant participants[MAX_PARTICIPANTS];
+    int paires[MAX_PARTICIPANTS * (MAX_PARTICIPANTS - 1) / 2][2];
+    t_rencontre *rencontres;
+    t_table_optimale table;
+    t_finale finale;
+    t_alea alea;
+    int nb_rondes, nb_paires, a, b;
+    double debut;
+
+    if (!preparer_strategie_optimale(options, options->participants, nb_participants, &table))
+        return false;
+    if (!preparer_strategie_victoire(options, options->participants, nb_participants, &finale)) {
+        liberer_strategie_optimale(&table);
+        return false;
+    }
+
+    memset(participants, 0, sizeof(participants));
+    memset(deja_rencontres, 0, sizeof(deja_rencontres));
+    for (int i = 0; i < nb_participants; i++)
+        participants[i].strategie = options->participants[i];
+
+    // en toutes rondes, une ronde par défaut ; en suisse, assez pour départager les participants
+    nb_rondes = options->nb_rondes;
+    if (nb_rondes == 0)
+        nb_rondes = options->format_tournoi == TOURNOI_SUISSE ? ceil(log2(nb_participants)) : 1;
+
+    rencontres = malloc(sizeof(paires) / sizeof(paires[0]) * sizeof(t_rencontre));
+    initialiser_alea(&alea, options->graine);
+    debut = horloge();
+
+    for (int ronde = 0; ronde < nb_rondes; ronde++) {
+        if (options->format_tournoi == TOURNOI_SUISSE) {
+            nb_paires = apparier_suisse(participants, nb_participants, deja_rencontres, paires);
+        }
+        else {
+            nb_paires = 0;
+            for (a = 0; a < nb_participants; a++) {
+                for (b = a + 1; b < nb_participants; b++) {
+                    paires[nb_paires][0] = a;
+                    paires[nb_paires][1] = b;
+                    nb_paires++;
+                }
+            }
+        }
+
+        // les graines sont tirées dans l'ordre des rencontres, avant de les jouer
+        for (int i = 0; i < nb_paires; i++) {
+            for (int j = 0; j < 2; j++) {
+                rencontres[i].participants[j] = paires[i][j];
+                rencontres[i].strategies[j] = participants[paires[i][j]].strategie;
+            }
+            rencontres[i].nb_parties = options->nb_parties;
+            rencontres[i].graine = alea_suivant(&alea);
+            deja_rencontres[paires[i][0]][paires[i][1]] = true;
+            deja_rencontres[paires[i][1]][paires[i][0]] = true;
+        }
+
+        jouer_ronde_tournoi(rencontres, nb_paires, options->nb_fils);
+        for (int i = 0; i < nb_paires; i++)
+            compter_rencontre(participants, &rencontres[i]);
+    }
+
+    printf("Tournoi %s, %d ronde%s, %d parties par rencontre, graine %llu\n",
+        options->format_tournoi == TOURNOI_SUISSE ? "suisse" : "toutes rondes",
+        nb_rondes, nb_rondes > 1 ? "s" : "", options->nb_parties, (unsigned long long)options->graine);
+    printf("Joué en %.3f s avec %d fils d'exécution\n", horloge() - debut, options->nb_fils);
+    afficher_classement(participants, nb_participants);
+
+    free(rencontres);
+    liberer_strategie_victoire(&finale);
+    liberer_strategie_optimale(&table);
+
+    return true;
+}
+
+/**
+ * \struct t_bilan_journal
+ * \brief Résumé des parties d'un journal
+ */
+typedef struct {
+    long nb_parties;            /**< Nombre de parties */
+    long nb_tours;              /**< Nombre de tours */
+    long nb_lancers;            /**< Nombre de lancers, tous tours confondus */
+    long nb_totaux;             /**< Nombre de totaux finaux, un par joueur de chaque partie */
+    long long somme_totaux;     /**< Somme des totaux finaux */
+    long nb_mots_incorrects;    /**< Mots ignorés : hors partie, case ou joueur impossibles, dés hors de 1 à 6 */
+} t_bilan_journal;
+
+/**
+ * \fn void terminer_partie_journal(int sous_totaux[][2], int nb_joueurs, t_bilan_journal *bilan)
+ * \brief Ajoute les totaux d'une partie relue au bilan, et les remet à zéro
+ * \param sous_totaux Les totaux supérieur et inférieur de chaque joueur, sans le bonus
+ * \param nb_joueurs Le nombre de joueurs de la partie
+ * \param bilan Le bilan
+ */
+void terminer_partie_journal(int sous_totaux[][2], int nb_joueurs, t_bilan_journal *bilan) {
+    for (int j = 0; j < nb_joueurs; j++) {
+        bilan->somme_totaux += sous_totaux[j][0] + sous_totaux[j][1];
+        if (sous_totaux[j][0] > BORNE_BONUS)
+            bilan->somme_totaux += BONUS;
+        sous_totaux[j][0] = 0;
+        sous_totaux[j][1] = 0;
+    }
+    bilan->nb_totaux += nb_joueurs;
+}
+
+/**
+ * \fn void analyser_journal(const uint64_t mots[], size_t nb_mots, t_bilan_journal *bilan)
+ * \brief Relit les mots d'un journal et recompte les points de chaque tour pour en faire le bilan
+ *
+ * Les points se retrouvent par deux lectures de table, sans décoder les dés :
+ * indice_paquets donne la main du dernier lancer, points_mains ses points.
+ * \param mots Les mots
+ * \param nb_mots Le nombre de mots
+ * \param bilan Le bilan, remis à zéro
+ */
+void analyser_journal(const uint64_t mots[], size_t nb_mots, t_bilan_journal *bilan) {
+    int sous_totaux[MAX_JOUEURS][2] = {{0}};
+    int nb_joueurs = 0;
+    int lancers, main, indice, joueur;
+    uint64_t mot;
+
+    memset(bilan, 0, sizeof(t_bilan_journal));
+
+    for (size_t i = 0; i < nb_mots; i++) {
+        mot = mots[i];
+
+        if (type_mot(mot) != MOT_TOUR) {
+            if (bilan->nb_parties > 0)
+                terminer_partie_journal(sous_totaux, nb_joueurs, bilan);
+            nb_joueurs = mot & (MAX_JOUEURS * 2 - 1);
+            if (type_mot(mot) != MOT_PARTIE || nb_joueurs > MAX_JOUEURS) {
+                nb_joueurs = 0;
+                bilan->nb_mots_incorrects++;
+            }
+            bilan->nb_parties++;
+            continue;
+        }
+
+        lancers = nb_lancers_mot(mot);
+        main = indice_paquets[paquet_mot(mot, lancers - 1)];
+        indice = case_mot(mot);
+        joueur = joueur_mot(mot);
+        if (main == MAIN_INCORRECTE || indice >= TAILLE_FEUILLE || joueur >= nb_joueurs) {
+            bilan->nb_mots_incorrects++;
+            continue;
+        }
+
+        sous_totaux[joueur][indice >= I_BRELAN] += points_mains[main][indice];
+        bilan->nb_tours++;
+        bilan->nb_lancers += lancers;
+    }
+
+    if (bilan->nb_parties > 0)
+        terminer_partie_journal(sous_totaux, nb_joueurs, bilan);
+}
+
+/**
+ * \def MAX_DIVERGENCES
+ * \brief Nombre de divergences gardées par tranche de journal pour les afficher
+ */
+#define MAX_DIVERGENCES 20
+
+/**
+ * \struct t_divergence
+ * \brief Tour d'un journal où la vérification a échoué
+ */
+typedef struct {
+    size_t mot;             /**< Position du mot dans le journal */
+    long partie;            /**< Numéro de la partie dans la tranche, puis dans le journal */
+    int tour;               /**< Numéro du tour, de 1 à 13, 0 pour la partie entière */
+    int joueur;             /**< Numéro du joueur, à partir de 1, 0 pour la partie entière */
+    const char *raison;     /**< Ce qui diverge */
+    int reference;          /**< Valeur attendue, pour les points et les totaux */
+    int rapide;             /**< Valeur obtenue */
+} t_divergence;
+
+/**
+ * \struct t_tranche_journal
+ * \brief Parties consécutives d'un journal, vérifiées par un même fil d'exécution
+ */
+typedef struct {
+    const uint64_t *mots;                       /**< Les mots du journal entier */
+    size_t debut;                               /**< Premier mot de la tranche, un début de partie sauf en tête du journal */
+    size_t fin;                                 /**< Fin de la tranche, début de la tranche suivante */
+    long nb_parties;                            /**< Nombre de parties vérifiées */
+    long nb_tours;                              /**< Nombre de tours rejoués */
+    long nb_divergences;                        /**< Nombre de divergences trouvées */
+    t_divergence divergences[MAX_DIVERGENCES];  /**< Les premières divergences */
+} t_tranche_journal;
+
+/**
+ * \fn void signaler_divergence(t_tranche_journal *tranche, size_t mot, int tour, int joueur, const char raison[], int reference, int rapide)
+ * \brief Note une divergence dans la partie en cours d'une tranche
+ * \param tranche La tranche
+ * \param mot La position du mot en cause
+ * \param tour Le numéro du tour, 0 pour la partie entière
+ * \param joueur Le numéro du joueur, 0 pour la partie entière
+ * \param raison Ce qui diverge
+ * \param reference La valeur attendue
+ * \param rapide La valeur obtenue
+ */
+void signaler_divergence(t_tranche_journal *tranche, size_t mot, int tour, int joueur,
+        const char raison[], int reference, int rapide) {
+    t_divergence *divergence;
+
+    if (tranche->nb_divergences < MAX_DIVERGENCES) {
+        divergence = &tranche->divergences[tranche->nb_divergences];
+        divergence->mot = mot;
+        divergence->partie = tranche->nb_parties;
+        divergence->tour = tour;
+        divergence->joueur = joueur;
+        divergence->raison = raison;
+        divergence->reference = reference;
+        divergence->rapide = rapide;
+    }
+    tranche->nb_divergences++;
+}
+
+/**
+ * \fn const char *verifier_mot_tour(uint64_t mot, int joueur, const t_feuille feuille)
+ * \brief Vérifie qu'un tour enregistré a pu être joué : joueur, lancers, dés gardés et case
+ * \param mot Le mot du tour
+ * \param joueur Le joueur dont c'était le tour
+ * \param feuille La feuille de ce joueur avant le tour
+ * \return NULL si le tour est possible, la raison sinon
+ */
+const char *verifier_mot_tour(uint64_t mot, int joueur, const t_feuille feuille) {
+    const int lancers = nb_lancers_mot(mot);
+    int garde, bits_gardes;
+
+    if (type_mot(mot) != MOT_TOUR)
+        return "mot inconnu";
+    if (joueur_mot(mot) != joueur)
+        return "joueur inattendu";
+    if (case_mot(mot) >= TAILLE_FEUILLE)
+        return "case inexistante";
+    if (feuille[case_mot(mot)] != CASE_VIDE)
+        return "case déjà remplie";
+
+    // nb_lancers_mot compte les lancers non nuls : un lancer nul parmi eux
+    // signale un lancer qui n'a pas eu lieu suivi d'un lancer fait
+    for (int lancer = 0; lancer < lancers; lancer++) {
+        if (paquet_mot(mot, lancer) == 0)
+            return "lancer manquant";
+        if (indice_paquets[paquet_mot(mot, lancer)] == MAIN_INCORRECTE)
+            return "dé hors de 1 à 6";
+    }
+
+    for (int lancer = 1; lancer < NB_LANCERS; lancer++) {
+        garde = garde_mot(mot, lancer);
+        if (lancer >= lancers) {
+            if (garde != 0)
+                return "dés gardés sans lancer";
+            continue;
+        }
+
+        // les bits des dés gardés ne changent pas d'un lancer à l'autre
+        bits_gardes = 0;
+        for (int i = 0; i < NB_DES; i++)
+            bits_gardes |= (garde >> i & 1) * (((1 << BITS_DE) - 1) << (i * BITS_DE));
+        if ((paquet_mot(mot, lancer - 1) ^ paquet_mot(mot, lancer)) & bits_gardes)
+            return "dé gardé modifié";
+    }
+
+    return NULL;
+}
+
+/**
+ * \fn void verifier_partie_journal(t_tranche_journal *tranche, size_t debut, size_t fin)
+ * \brief Rejoue une partie d'un journal par deux calculs des points et compare les feuilles
+ *
+ * Le calcul de référence est celui de l'affichage : rechercher_combinaisons sur
+ * les dés triés, puis calculer_totaux sur chaque feuille. Le calcul rapide est
+ * celui des parties automatiques et de la lecture du journal : indice_paquets,
+ * points_mains et t_table_joueurs. Les deux doivent donner les mêmes points à
+ * chaque tour et les mêmes totaux.
+ * \param tranche La tranche de la partie
+ * \param debut La position du début de la partie
+ * \param fin La position du début de la partie suivante
+ */
+void verifier_partie_journal(t_tranche_journal *tranche, size_t debut, size_t fin) {
+    const uint64_t *mots = tranche->mots;
+    const int nb_joueurs = mots[debut] & (MAX_JOUEURS * 2 - 1);
+    const long nb_tours = fin - debut - 1;
+    t_feuille feuilles[MAX_JOUEURS];
+    t_feuille possibles;
+    t_table_joueurs table;
+    t_des des;
+    int totaux[MAX_JOUEURS];
+    int joueur, indice, lancers, reference, rapide, total_sup, total_inf, bonus;
+    const char *raison;
+    uint64_t mot;
+
+    if (type_mot(mots[debut]) != MOT_PARTIE || nb_joueurs < 1 || nb_joueurs > MAX_JOUEURS) {
+        signaler_divergence(tranche, debut, 0, 0, "début de partie incorrect", 0, 0);
+        return;
+    }
+    if (nb_tours != nb_joueurs * TAILLE_FEUILLE) {
+        signaler_divergence(tranche, debut, 0, 0, "nombre de tours incorrect",
+            nb_joueurs * TAILLE_FEUILLE, nb_tours);
+        return;
+    }
+
+    for (int j = 0; j < nb_joueurs; j++) {
+        for (int i = 0; i < TAILLE_FEUILLE; i++)
+            feuilles[j][i] = CASE_VIDE;
+    }
+    initialiser_table_joueurs(&table, nb_joueurs);
+
+    for (long t = 0; t < nb_tours; t++) {
+        mot = mots[debut + 1 + t];
+        joueur = t % nb_joueurs;
+
+        // après un tour impossible, la suite de la partie n'a plus de sens
+        raison = verifier_mot_tour(mot, joueur, feuilles[joueur]);
+        if (raison != NULL) {
+            signaler_divergence(tranche, debut + 1 + t, t / nb_joueurs + 1, joueur + 1, raison, 0, 0);
+            return;
+        }
+
+        lancers = nb_lancers_mot(mot);
+        indice = case_mot(mot);
+
+        des_mot(mot, lancers - 1, des);
+        trier_des(des);
+        rechercher_combinaisons(feuilles[joueur], des, possibles);
+        reference = possibles[indice];
+        feuilles[joueur][indice] = reference;
+
+        rapide = points_mains[indice_paquets[paquet_mot(mot, lancers - 1)]][indice];
+        inscrire_table(&table, joueur, indice, rapide);
+
+        if (reference != rapide)
+            signaler_divergence(tranche, debut + 1 + t, t / nb_joueurs + 1, joueur + 1,
+                "points différents", reference, rapide);
+    }
+
+    totaux_table(&table, totaux);
+    for (int j = 0; j < nb_joueurs; j++) {
+        calculer_totaux(feuilles[j], &total_sup, &total_inf, &reference, &bonus);
+        if (reference != totaux[j])
+            signaler_divergence(tranche, debut, 0, j + 1, "total différent", reference, totaux[j]);
+    }
+
+    tranche->nb_tours += nb_tours;
+}
+
+/**
+ * \fn void *verifier_tranche_journal(void *argument)
+ * \brief Point d'entrée d'un fil de vérification : rejoue toutes les parties d'une tranche
+ * \param argument La tranche (t_tranche_journal)
+ * \return NULL
+ */
+void *verifier_tranche_journal(void *argument) {
+    t_tranche_journal *tranche = argument;
+    size_t debut = tranche->debut, fin;
+
+    // des mots avant la première partie du journal n'appartiennent à aucune partie
+    if (debut < tranche->fin && type_mot(tranche->mots[debut]) != MOT_PARTIE) {
+        signaler_divergence(tranche, debut, 0, 0, "mots hors partie", 0, 0);
+        while (debut < tranche->fin && type_mot(tranche->mots[debut]) != MOT_PARTIE)
+            debut++;
+    }
+
+    while (debut < tranche->fin) {
+        fin = debut + 1;
+        while (fin < tranche->fin && type_mot(tranche->mots[fin]) != MOT_PARTIE)
+            fin++;
+
+        verifier_partie_journal(tranche, debut, fin);
+        tranche->nb_parties++;
+        debut = fin;
+    }
+
+    return NULL;
+}
+
+/**
+ * \fn void verifier_journal(const uint64_t mots[], size_t nb_mots, t_tranche_journal tranches[], int nb_fils)
+ * \brief Vérifie un journal entier, découpé en tranches de parties entières vérifiées en parallèle
+ *
+ * Les tranches commencent chacune sur un début de partie et se suivent dans
+ * l'ordre du journal : les divergences trouvées ne dépendent pas du nombre de fils.
+ * \param mots Les mots du journal
+ * \param nb_mots Le nombre de mots
+ * \param tranches Les nb_fils tranches, remplies par la vérification
+ * \param nb_fils Le nombre de fils d'exécution
+ */
+void verifier_journal(const uint64_t mots[], size_t nb_mots, t_tranche_journal tranches[], int nb_fils) {
+    pthread_t *fils;
+    size_t debut;
+
+    fils = malloc(nb_fils * sizeof(pthread_t));
+
+    for (int i = 0; i < nb_fils; i++) {
+        debut = 0;
+        if (i > 0) {
+            debut = nb_mots / nb_fils * i;
+            if (debut < tranches[i - 1].debut)
+                debut = tranches[i - 1].debut;
+            while (debut < nb_mots && type_mot(mots[debut]) != MOT_PARTIE)
+                debut++;
+        }
+
+        memset(&tranches[i], 0, sizeof(t_tranche_journal));
+        tranches[i].mots = mots;
+        tranches[i].debut = debut;
+        if (i > 0)
+            tranches[i - 1].fin = debut;
+    }
+    tranches[nb_fils - 1].fin = nb_mots;
+
+    attendre_fils(fils, lancer_fils(fils, nb_fils, verifier_tranche_journal, tranches, sizeof(t_tranche_journal)));
+
+    free(fils);
+}
+
+/**
+ * \fn bool mode_lecture_journal(const t_options *options)
+ * \brief Relit un journal de parties et affiche son bilan
+ * \param options Les options de la ligne de commande
+ * \return Vrai si le journal a été lu, faux sinon
+ */
+bool mode_lecture_journal(const t_options *options) {
+    t_lecture_journal lecture;
+    t_bilan_journal bilan;
+    double debut, duree;
+
+    if (!ouvrir_lecture_journal(options->fichier_journal, &lecture))
+        return false;
+
+    debut = horloge();
+    analyser_journal(lecture.mots, lecture.nb_mots, &bilan);
+    duree = horloge() - debut;
+
+    printf("%ld parties, %ld tours lus en %.3f s (%.0f tours/s, %.0f Mo/s)\n", bilan.nb_parties, bilan.nb_tours,
+        duree, bilan.nb_tours / duree, lecture.nb_mots * sizeof(uint64_t) / duree / 1e6);
+    if (bilan.nb_tours > 0) {
+        printf("Lancers par tour : %.3f\n", (double)bilan.nb_lancers / bilan.nb_tours);
+        printf("Total moyen d'un joueur : %.2f\n", (double)bilan.somme_totaux / bilan.nb_totaux);
+    }
+    if (bilan.nb_mots_incorrects > 0)
+        printf("Mots incorrects ignorés : %ld\n", bilan.nb_mots_incorrects);
+
+    fermer_lecture_journal(&lecture);
+
+    return true;
+}
+
+/**
+ * \fn bool mode_verification_journal(const t_options *options)
+ * \brief Rejoue toutes les parties d'un journal et affiche les divergences entre les calculs des points
+ * \param options Les options de la ligne de commande
+ * \return Vrai si le journal est lu sans divergence, faux sinon
+ */
+bool mode_verification_journal(const t_options *options) {
+    t_lecture_journal lecture;
+    t_tranche_journal *tranches;
+    const t_divergence *divergence;
+    long nb_parties = 0, nb_tours = 0, nb_divergences = 0, premiere = 0;
+    double debut, duree;
+
+    if (!ouvrir_lecture_journal(options->fichier_journal, &lecture))
+        return false;
+
+    tranches = malloc(options->nb_fils * sizeof(t_tranche_journal));
+    debut = horloge();
+    verifier_journal(lecture.mots, lecture.nb_mots, tranches, options->nb_fils);
+    duree = horloge() - debut;
+
+    for (int i = 0; i < options->nb_fils; i++) {
+        nb_parties += tranches[i].nb_parties;
+        nb_tours += tranches[i].nb_tours;
+        nb_divergences += tranches[i].nb_divergences;
+    }
+    printf("%ld parties, %ld tours rejoués en %.3f s (%.0f tours/s) avec %d fils d'exécution\n",
+        nb_parties, nb_tours, duree, nb_tours / duree, options->nb_fils);
+
+    // les parties sont numérotées dans tout le journal, à partir de 1
+    for (int i = 0; i < options->nb_fils; i++) {
+        for (int k = 0; k < tranches[i].nb_divergences && k < MAX_DIVERGENCES; k++) {
+            divergence = &tranches[i].divergences[k];
+            printf("Partie %ld (mot %zu)", premiere + divergence->partie + 1, divergence->mot);
+            if (divergence->tour > 0)
+                printf(", tour %d", divergence->tour);
+            if (divergence->joueur > 0)
+                printf(", joueur %d", divergence->joueur);
+            printf(" : %s", divergence->raison);
+            if (divergence->reference != divergence->rapide)
+                printf(" (attendu %d, obtenu %d)", divergence->reference, divergence->rapide);
+            printf("\n");
+        }
+        if (tranches[i].nb_divergences > MAX_DIVERGENCES)
+            printf("... et %ld autres divergences dans les parties %ld à %ld\n",
+                tranches[i].nb_divergences - MAX_DIVERGENCES, premiere + 1, premiere + tranches[i].nb_parties);
+        premiere += tranches[i].nb_parties;
+    }
+
+    if (nb_divergences == 0)
+        printf("Aucune divergence : les deux calculs donnent les mêmes feuilles de marque\n");
+    else
+        printf("%ld divergences\n", nb_divergences);
+
+    free(tranches);
+    fermer_lecture_journal(&lecture);
+
+    return nb_divergences == 0;
+}
+
+/**
+ * \def TAILLE_CACHE_EVALUATIONS
+ * \brief Nombre d'évaluations de tour gardées par fil d'analyse, rangées selon l'état de la feuille
+ */
+/**
+ * \def MICRO_POINTS
+ * \brief Unité des pertes cumulées : en entiers, leur somme ne dépend pas de l'ordre des parties
+ */
+/**
+ * \def SEUIL_ERREUR
+ * \brief Perte au-delà de laquelle une décision compte comme une erreur, en deçà des écarts d'arrondi
+ */
+#define TAILLE_CACHE_EVALUATIONS 256
+#define MICRO_POINTS 1e6
+#define SEUIL_ERREUR 1e-3
+
+/**
+ * \struct t_qualite
+ * \brief Pertes cumulées d'un type de décision, par rapport à la stratégie optimale
+ */
+typedef struct {
+    long nb_decisions;      /**< Nombre de décisions */
+    long nb_erreurs;        /**< Nombre de décisions qui perdent plus que SEUIL_ERREUR */
+    long long perte;        /**< Somme des pertes d'espérance, en MICRO_POINTS */
+} t_qualite;
+
+/**
+ * \struct t_qualite_decisions
+ * \brief Pertes cumulées des gardes et des choix de case
+ */
+typedef struct {
+    t_qualite gardes;       /**< Dés gardés après le premier et le deuxième lancer */
+    t_qualite cases;        /**< Case remplie à la fin du tour */
+} t_qualite_decisions;
+
+/**
+ * \struct t_analyse_decisions
+ * \brief Bilan de l'analyse des décisions d'un ou plusieurs journaux
+ */
+typedef struct {
+    long nb_parties;                                /**< Parties analysées */
+    long nb_parties_ignorees;                       /**< Parties incomplètes ou impossibles, non analysées */
+    long nb_parties_joueurs[MAX_JOUEURS];           /**< Parties analysées où chaque place était occupée */
+    long nb_evaluations;                            /**< Evaluations de tour demandées */
+    long nb_evaluations_cache;                      /**< Evaluations trouvées dans le cache */
+    t_qualite_decisions joueurs[MAX_JOUEURS];       /**< Pertes de chaque place à la table */
+    t_qualite_decisions tours[TAILLE_FEUILLE];      /**< Pertes à chaque numéro de tour */
+} t_analyse_decisions;
+
+/**
+ * \fn void compter_decision(t_qualite *qualite, float meilleure, float choisie)
+ * \brief Ajoute une décision et sa perte d'espérance aux pertes cumulées
+ * \param qualite Les pertes cumulées
+ * \param meilleure L'espérance de la meilleure décision
+ * \param choisie L'espérance de la décision prise
+ */
+void compter_decision(t_qualite *qualite, float meilleure, float choisie) {
+    double perte = (double)meilleure - choisie;
+
+    qualite->nb_decisions++;
+    qualite->nb_erreurs += perte > SEUIL_ERREUR;
+    qualite->perte += llround(perte * MICRO_POINTS);
+}
+
+/**
+ * \fn void fusionner_qualite(t_qualite *qualite, const t_qualite *autre)
+ * \brief Ajoute des pertes cumulées à d'autres
+ * \param qualite Les pertes complétées
+ * \param autre Les pertes ajoutées
+ */
+void fusionner_qualite(t_qualite *qualite, const t_qualite *autre) {
+    qualite->nb_decisions += autre->nb_decisions;
+    qualite->nb_erreurs += autre->nb_erreurs;
+    qualite->perte += autre->perte;
+}
+
+/**
+ * \fn void fusionner_analyses(t_analyse_decisions *analyse, const t_analyse_decisions *autre)
+ * \brief Ajoute le bilan d'un fil d'analyse au bilan général
+ * \param analyse Le bilan complété
+ * \param autre Le bilan ajouté
+ */
+void fusionner_analyses(t_analyse_decisions *analyse, const t_analyse_decisions *autre) {
+    analyse->nb_parties += autre->nb_parties;
+    analyse->nb_parties_ignorees += autre->nb_parties_ignorees;
+    analyse->nb_evaluations += autre->nb_evaluations;
+    analyse->nb_evaluations_cache += autre->nb_evaluations_cache;
+
+    for (int j = 0; j < MAX_JOUEURS; j++) {
+        analyse->nb_parties_joueurs[j] += autre->nb_parties_joueurs[j];
+        fusionner_qualite(&analyse->joueurs[j].gardes, &autre->joueurs[j].gardes);
+        fusionner_qualite(&analyse->joueurs[j].cases, &autre->joueurs[j].cases);
+    }
+    for (int t = 0; t < TAILLE_FEUILLE; t++) {
+        fusionner_qualite(&analyse->tours[t].gardes, &autre->tours[t].gardes);
+        fusionner_qualite(&analyse->tours[t].cases, &autre->tours[t].cases);
+    }
+}
+
+/**
+ * \fn const t_evaluation_tour *evaluation_en_cache(t_evaluation_tour cache[], const float *esperances, int masque, int sous_total, t_analyse_decisions *analyse)
+ * \brief Donne l'évaluation du tour d'un état de la feuille, préparée au besoin
+ *
+ * Le cache est à correspondance directe : un état remplace celui qui occupait
+ * sa place. Les premiers tours, où les états sont peu nombreux, n'y sont
+ * presque jamais recalculés.
+ * \param cache Les TAILLE_CACHE_EVALUATIONS évaluations du fil, de masque -1 si la place est vide
+ * \param esperances La table du solveur
+ * \param masque Les cases remplies
+ * \param sous_total Le sous-total supérieur plafonné
+ * \param analyse Le bilan, pour compter les évaluations
+ * \return L'évaluation, valable jusqu'au prochain appel
+ */
+const t_evaluation_tour *evaluation_en_cache(t_evaluation_tour cache[], const float *esperances,
+        int masque, int sous_total, t_analyse_decisions *analyse) {
+    uint32_t etat = masque * NB_SOUS_TOTAUX + sous_total;
+    t_evaluation_tour *evaluation = &cache[(etat * 2654435761u) >> 24 & (TAILLE_CACHE_EVALUATIONS - 1)];
+
+    analyse->nb_evaluations++;
+    if (evaluation->masque == masque && evaluation->sous_total == sous_total)
+        analyse->nb_evaluations_cache++;
+    else
+        preparer_evaluation_tour(esperances, masque, sous_total, evaluation);
+
+    return evaluation;
+}
+
+/**
+ * \fn void analyser_partie_decisions(const uint64_t mots[], int nb_mots, const float *esperances, t_evaluation_tour cache[], t_analyse_decisions *analyse)
+ * \brief Mesure la perte d'espérance de chaque décision d'une partie, par rapport à la stratégie optimale
+ *
+ * Chaque joueur est jugé comme s'il jouait seul, d'après l'espérance de son
+ * score final. Ne plus relancer revient à garder tous les dés à chaque relance
+ * restante : ces gardes sont jugées comme les autres.
+ * \param mots Les mots de la partie, son mot MOT_PARTIE en premier
+ * \param nb_mots Le nombre de mots
+ * \param esperances La table du solveur
+ * \param cache Le cache d'évaluations du fil
+ * \param analyse Le bilan, complété
+ */
+void analyser_partie_decisions(const uint64_t mots[], int nb_mots, const float *esperances,
+        t_evaluation_tour cache[], t_analyse_decisions *analyse) {
+    const int nb_joueurs = mots[0] & (MAX_JOUEURS * 2 - 1);
+    const t_evaluation_tour *evaluation;
+    t_feuille feuilles[MAX_JOUEURS];
+    float valeurs[1 << NB_DES];
+    const unsigned char *points;
+    t_des des;
+    int joueur, tour, lancers, garde, indice, masque, sous_total;
+    float meilleure, valeur;
+
+    // la partie entière est vérifiée avant d'en juger les décisions
+    bool correct = type_mot(mots[0]) == MOT_PARTIE && nb_joueurs >= 1 && nb_joueurs <= MAX_JOUEURS
+        && nb_mots == 1 + nb_joueurs * TAILLE_FEUILLE;
+    for (int j = 0; correct && j < nb_joueurs; j++) {
+        for (int i = 0; i < TAILLE_FEUILLE; i++)
+            feuilles[j][i] = CASE_VIDE;
+    }
+    for (int t = 0; correct && t < nb_mots - 1; t++) {
+        correct = verifier_mot_tour(mots[1 + t], t % nb_joueurs, feuilles[t % nb_joueurs]) == NULL;
+
+        // la case d'un mot refusé peut être hors de la feuille
+        if (correct)
+            feuilles[t % nb_joueurs][case_mot(mots[1 + t])] = 0;
+    }
+    if (!correct) {
+        analyse->nb_parties_ignorees++;
+        return;
+    }
+
+    for (int j = 0; j < nb_joueurs; j++) {
+        for (int i = 0; i < TAILLE_FEUILLE; i++)
+            feuilles[j][i] = CASE_VIDE;
+        analyse->nb_parties_joueurs[j]++;
+    }
+
+    for (int t = 0; t < nb_mots - 1; t++) {
+        joueur = t % nb_joueurs;
+        tour = t / nb_joueurs;
+        lancers = nb_lancers_mot(mots[1 + t]);
+
+        etat_feuille(feuilles[joueur], &masque, &sous_total);
+        evaluation = evaluation_en_cache(cache, esperances, masque, sous_total, analyse);
+
+        for (int lancer = 1; lancer < NB_LANCERS; lancer++) {
+            des_mot(mots[1 + t], (lancer < lancers ? lancer : lancers) - 1, des);
+            garde = lancer < lancers ? garde_mot(mots[1 + t], lancer) : GARDER_TOUT;
+
+            evaluer_gardes(evaluation, des, NB_LANCERS - lancer, valeurs);
+            meilleure = valeurs[0];
+            for (int g = 1; g <= GARDER_TOUT; g++)
+                meilleure = fmaxf(meilleure, valeurs[g]);
+
+            compter_decision(&analyse->joueurs[joueur].gardes, meilleure, valeurs[garde]);
+            compter_decision(&analyse->tours[tour].gardes, meilleure, valeurs[garde]);
+        }
+
+        des_mot(mots[1 + t], lancers - 1, des);
+        points = points_mains[indice_main(des)];
+        indice = case_mot(mots[1 + t]);
+
+        meilleure = -INFINITY;
+        for (int i = 0; i < TAILLE_FEUILLE; i++) {
+            if (feuilles[joueur][i] == CASE_VIDE)
+                meilleure = fmaxf(meilleure, valeur_case(esperances, masque, sous_total, i, points[i]));
+        }
+        valeur = valeur_case(esperances, masque, sous_total, indice, points[indice]);
+
+        compter_decision(&analyse->joueurs[joueur].cases, meilleure, valeur);
+        compter_decision(&analyse->tours[tour].cases, meilleure, valeur);
+        feuilles[joueur][indice] = points[indice];
+    }
+
+    analyse->nb_parties++;
+}
+
+/**
+ * \struct t_flux_journal
+ * \brief Lecture d'un journal par morceaux, pour en parcourir une partie en mémoire bornée
+ */
+typedef struct {
+    int descripteur;                        /**< Fichier du journal, partagé entre les fils */
+    off_t position;                         /**< Position dans le fichier du prochain morceau */
+    int nb_mots;                            /**< Nombre de mots du morceau en tampon */
+    int suivant;                            /**< Prochain mot du tampon à rendre */
+    uint64_t mots[TAILLE_TAMPON_JOURNAL];   /**< Le morceau en tampon */
+} t_flux_journal;
+
+/**
+ * \fn bool lire_flux_journal(t_flux_journal *flux, uint64_t *mot)
+ * \brief Rend le mot suivant d'un journal, en lisant le morceau suivant quand le tampon est épuisé
+ * \param flux La lecture
+ * \param mot Le mot lu
+ * \return Vrai si un mot a été lu, faux à la fin du fichier
+ */
+bool lire_flux_journal(t_flux_journal *flux, uint64_t *mot) {
+    ssize_t lus;
+
+    if (flux->suivant == flux->nb_mots) {
+        lus = pread(flux->descripteur, flux->mots, sizeof(flux->mots), flux->position);
+        if (lus < (ssize_t)sizeof(uint64_t))
+            return false;
+        flux->nb_mots = lus / sizeof(uint64_t);
+        flux->position += flux->nb_mots * sizeof(uint64_t);
+        flux->suivant = 0;
+    }
+
+    *mot = flux->mots[flux->suivant++];
+    return true;
+}
+
+/**
+ * \struct t_travail_analyse
+ * \brief Part d'un journal confiée à un fil d'analyse : les parties qui commencent entre debut et fin
+ */
+typedef struct {
+    int descripteur;                /**< Fichier du journal */
+    off_t debut;                    /**< Début de la part, en octets, aligné sur un mot */
+    off_t fin;                      /**< Fin de la part : la dernière partie peut la dépasser */
+    const float *esperances;        /**< La table du solveur */
+    t_analyse_decisions analyse;    /**< Bilan propre au fil */
+} t_travail_analyse;
+
+/**
+ * \fn void *executer_travail_analyse(void *argument)
+ * \brief Point d'entrée d'un fil d'analyse : lit sa part du journal partie par partie
+ * \param argument Le travail du fil (t_travail_analyse)
+ * \return NULL
+ */
+void *executer_travail_analyse(void *argument) {
+    t_travail_analyse *travail = argument;
+    t_evaluation_tour *cache;
+    t_flux_journal *flux;
+    uint64_t mots[MAX_MOTS_PARTIE];
+    uint64_t mot;
+    int nb_mots = 0;
+    off_t position;
+    bool suite;
+
+    cache = malloc(TAILLE_CACHE_EVALUATIONS * sizeof(t_evaluation_tour));
+    for (int i = 0; i < TAILLE_CACHE_EVALUATIONS; i++)
+        cache[i].masque = -1;
+    flux = malloc(sizeof(t_flux_journal));
+    flux->descripteur = travail->descripteur;
+    flux->position = travail->debut;
+    flux->nb_mots = 0;
+    flux->suivant = 0;
+
+    // la part commence à la première partie qui débute après travail->debut
+    position = travail->debut;
+    suite = lire_flux_journal(flux, &mot);
+    while (suite && type_mot(mot) != MOT_PARTIE && position < travail->fin) {
+        suite = lire_flux_journal(flux, &mot);
+        position += sizeof(uint64_t);
+    }
+
+    suite = suite && position < travail->fin;
+
+    // la dernière partie est lue jusqu'au bout, au-delà de la fin de la part
+    while (suite) {
+        // une partie trop longue est gardée tronquée, et sera ignorée
+        if (nb_mots < MAX_MOTS_PARTIE)
+            mots[nb_mots] = mot;
+        nb_mots++;
+
+        suite = lire_flux_journal(flux, &mot);
+        position += sizeof(uint64_t);
+        if (!suite || type_mot(mot) == MOT_PARTIE) {
+            analyser_partie_decisions(mots, nb_mots, travail->esperances, cache, &travail->analyse);
+            nb_mots = 0;
+            suite = suite && position < travail->fin;
+        }
+    }
+
+    free(flux);
+    free(cache);
+    return NULL;
+}
+
+/**
+ * \fn bool analyser_decisions_journal(const char fichier[], const float *esperances, int nb_fils, t_analyse_decisions *analyse)
+ * \brief Analyse les décisions de toutes les parties d'un journal, réparti en parts égales entre plusieurs fils
+ *
+ * Chaque fil lit sa part par morceaux de TAILLE_TAMPON_JOURNAL mots, sans
+ * projeter le fichier : la mémoire utilisée ne dépend pas de la taille du journal.
+ * \param fichier Le nom du journal
+ * \param esperances La table du solveur
+ * \param nb_fils Le nombre de fils d'exécution
+ * \param analyse Le bilan, complété
+ * \return Vrai si le journal a été lu, faux sinon
+ */
+bool analyser_decisions_journal(const char fichier[], const float *esperances, int nb_fils, t_analyse_decisions *analyse) {
+    t_entete_journal entete;
+    t_travail_analyse *travaux;
+    pthread_t *fils;
+    struct stat infos;
+    int descripteur;
+    off_t taille_mots;
+
+    descripteur = open(fichier, O_RDONLY);
+    if (descripteur < 0) {
+        fprintf(stderr, "Impossible d'ouvrir %s\n", fichier);
+        return false;
+    }
+    if (fstat(descripteur, &infos) != 0 || pread(descripteur, &entete, sizeof(entete), 0) != sizeof(entete)
+            || !entete_journal_valide(&entete, infos.st_size)) {
+        fprintf(stderr, "%s n'est pas un journal de parties\n", fichier);
+        close(descripteur);
+        return false;
+    }
+
+    // la lecture commencée sur un mot continue sur des mots : les parts en sont des multiples
+    taille_mots = (infos.st_size - entete.taille_entete) / sizeof(uint64_t);
+    travaux = malloc(nb_fils * sizeof(t_travail_analyse));
+    fils = malloc(nb_fils * sizeof(pthread_t));
+
+    for (int i = 0; i < nb_fils; i++) {
+        memset(&travaux[i], 0, sizeof(t_travail_analyse));
+        travaux[i].descripteur = descripteur;
+        travaux[i].debut = entete.taille_entete + taille_mots * i / nb_fils * sizeof(uint64_t);
+        travaux[i].fin = entete.taille_entete + taille_mots * (i + 1) / nb_fils * sizeof(uint64_t);
+        travaux[i].esperances = esperances;
+    }
+
+    attendre_fils(fils, lancer_fils(fils, nb_fils, executer_travail_analyse, travaux, sizeof(t_travail_analyse)));
+    for (int i = 0; i < nb_fils; i++) {
+        fusionner_analyses(analyse, &travaux[i].analyse);
+    }
+
+    free(fils);
+    free(travaux);
+    close(descripteur);
+
+    return true;
+}
+
+/**
+ * \fn void afficher_qualite(const t_qualite *qualite)
+ * \brief Affiche le nombre de décisions d'un type, leur perte moyenne et leur taux d'erreur
+ * \param qualite Les pertes cumulées
+ */
+void afficher_qualite(const t_qualite *qualite) {
+    if (qualite->nb_decisions == 0)
+        printf(" %10d %10s %8s", 0, "-", "-");
+    else
+        printf(" %10ld %10.4f %7.2f%%", qualite->nb_decisions,
+            qualite->perte / MICRO_POINTS / qualite->nb_decisions,
+            100.0 * qualite->nb_erreurs / qualite->nb_decisions);
+}
+
+/**
+ * \fn bool mode_analyse_decisions(const t_options *options)
+ * \brief Compare les décisions des parties d'un ou plusieurs journaux à celles de la stratégie optimale
+ *
+ * Les journaux, séparés par des virgules, sont lus l'un après l'autre,
+ * chacun par tous les fils d'exécution.
+ * \param options Les options de la ligne de commande
+ * \return Vrai si tous les journaux ont été lus, faux sinon
+ */
+bool mode_analyse_decisions(const t_options *options) {
+    const t_strategie *optimale = rechercher_strategie("optimal");
+    t_analyse_decisions analyse;
+    t_table_optimale table;
+    char *fichiers, *fichier, *reste;
+    const t_qualite_decisions *qualite;
+    double debut, duree;
+    long nb_tours;
+    bool correct = true;
+
+    if (!preparer_strategie_optimale(options, &optimale, 1, &table))
+        return false;
+
+    memset(&analyse, 0, sizeof(analyse));
+    fichiers = strdup(options->fichier_journal);
+    debut = horloge();
+    for (fichier = strtok_r(fichiers, ",", &reste); fichier != NULL && correct; fichier = strtok_r(NULL, ",", &reste))
+        correct = analyser_decisions_journal(fichier, optimale->contexte, options->nb_fils, &analyse);
+    duree = horloge() - debut;
+    free(fichiers);
+
+    if (!correct) {
+        liberer_strategie_optimale(&table);
+        return false;
+    }
+
+    nb_tours = 0;
+    for (int t = 0; t < TAILLE_FEUILLE; t++)
+        nb_tours += analyse.tours[t].cases.nb_decisions;
+    printf("%ld parties, %ld tours analysés en %.3f s (%.0f tours/s) avec %d fils d'exécution\n",
+        analyse.nb_parties, nb_tours, duree, nb_tours / duree, options->nb_fils);
+    if (analyse.nb_parties_ignorees > 0)
+        printf("Parties incomplètes ou impossibles ignorées : %ld\n", analyse.nb_parties_ignorees);
+    if (analyse.nb_evaluations > 0)
+        printf("Evaluations de tour trouvées en cache : %.1f %%\n",
+            100.0 * analyse.nb_evaluations_cache / analyse.nb_evaluations);
+
+    printf("\nPerte d'espérance par rapport à la stratégie optimale, en points (erreur : perte > %g)\n", SEUIL_ERREUR);
+    printf("%-7s %10s %10s %8s %10s %10s %8s %12s\n", "Joueur", "Gardes", "Perte moy", "Erreurs",
+        "Cases", "Perte moy", "Erreurs", "Perte/partie");
+    for (int j = 0; j < MAX_JOUEURS; j++) {
+        if (analyse.nb_parties_joueurs[j] == 0)
+            continue;
+        qualite = &analyse.joueurs[j];
+        printf("%-7d", j + 1);
+        afficher_qualite(&qualite->gardes);
+        afficher_qualite(&qualite->cases);
+        printf(" %12.3f\n", (qualite->gardes.perte + qualite->cases.perte) / MICRO_POINTS / analyse.nb_parties_joueurs[j]);
+    }
+
+    printf("\n%-7s %10s %10s %8s %10s %10s %8s %12s\n", "Tour", "Gardes", "Perte moy", "Erreurs",
+        "Cases", "Perte moy", "Erreurs", "Perte/tour");
+    for (int t = 0; t < TAILLE_FEUILLE; t++) {
+        qualite = &analyse.tours[t];
+        if (qualite->cases.nb_decisions == 0)
+            continue;
+        printf("%-7d", t + 1);
+        afficher_qualite(&qualite->gardes);
+        afficher_qualite(&qualite->cases);
+        printf(" %12.4f\n", (qualite->gardes.perte + qualite->cases.perte) / MICRO_POINTS / qualite->cases.nb_decisions);
+    }
+
+    liberer_strategie_optimale(&table);
+
+    return true;
+}
+
+/**
+ * \fn void repartir_relances(const double gardes[NB_GARDES], double mains[NB_MAINS])
+ * \brief Répartit la probabilité de chaque garde entre les mains que peut donner la relance des autres dés
+ *
+ * Même parcours que esperance_garde, les probabilités allant des gardes vers
+ * les mains. Les gardes que la stratégie ne choisit jamais sont sautées.
+ * \param gardes La probabilité de chaque garde
+ * \param mains La probabilité de chaque main après la relance, complétée
+ */
+void repartir_relances(const double gardes[NB_GARDES], double mains[NB_MAINS]) {
+    const unsigned char *cibles;
+    int taille, nb, relances;
+
+    for (int g = 0; g < NB_GARDES; g++) {
+        if (gardes[g] == 0)
+            continue;
+
+        taille = taille_gardes[g];
+        nb = debut_taille_gardes[taille + 1] - debut_taille_gardes[taille];
+        relances = NB_DES - taille;
+
+        // les cibles de cette garde sont espacées du nombre de gardes de même taille
+        cibles = cible_transitions + debut_transitions[taille] + (g - debut_taille_gardes[taille]);
+        for (int r = debut_taille_gardes[relances]; r < debut_taille_gardes[relances + 1]; r++) {
+            mains[*cibles] += gardes[g] * proba_exacte_tirages[r];
+            cibles += nb;
+        }
+    }
+}
+
+/**
+ * \fn void distribution_tour(const t_strategie *strategie, const t_feuille_compacte *feuille, t_alea *alea, double issues[TAILLE_FEUILLE][POINTS_CASE_MAX + 1])
+ * \brief Calcule la probabilité de chaque issue d'un tour joué par une stratégie : case remplie et points inscrits
+ *
+ * Au lieu de tirer les dés, le tour suit la probabilité de chacune des 252 mains
+ * triées, lancer après lancer, en demandant à la stratégie sa décision pour chaque
+ * main possible. Les règles sont celles de jouer_tour_auto.
+ * \param strategie La stratégie, qui ne doit pas dépendre du hasard
+ * \param feuille La feuille de marque
+ * \param alea Générateur passé à la stratégie, qui ne s'en sert pas
+ * \param issues issues[i][p] : probabilité de finir le tour en inscrivant p points dans la case i
+ */
+void distribution_tour(const t_strategie *strategie, const t_feuille_compacte *feuille, t_alea *alea,
+        double issues[TAILLE_FEUILLE][POINTS_CASE_MAX + 1]) {
+    double mains[NB_MAINS], finales[NB_MAINS], gardes[NB_GARDES];
+    int garde, indice;
+
+    memset(issues, 0, TAILLE_FEUILLE * sizeof(issues[0]));
+    memset(mains, 0, sizeof(mains));
+    memset(finales, 0, sizeof(finales));
+    memset(gardes, 0, sizeof(gardes));
+
+    // le premier lancer est une relance des 5 dés, sans aucun dé gardé
+    gardes[0] = 1;
+    repartir_relances(gardes, mains);
+
+    for (int lancer = 1; lancer < NB_LANCERS; lancer++) {
+        memset(gardes, 0, sizeof(gardes));
+        for (int h = 0; h < NB_MAINS; h++) {
+            if (mains[h] == 0)
+                continue;
+            garde = strategie->choisir_garde(strategie, feuille, NULL, mains_triees[h], NB_LANCERS - lancer, alea);
+            if ((garde & GARDER_TOUT) == GARDER_TOUT)
+                finales[h] += mains[h];
+            else
+                gardes[indice_garde(mains_triees[h], garde)] += mains[h];
+        }
+        memset(mains, 0, sizeof(mains));
+        repartir_relances(gardes, mains);
+    }
+
+    for (int h = 0; h < NB_MAINS; h++) {
+        finales[h] += mains[h];
+        if (finales[h] == 0)
+            continue;
+
+        indice = strategie->choisir_case(strategie, feuille, NULL, mains_triees[h], alea);
+        if (indice < 0 || indice >= TAILLE_FEUILLE || !case_libre(feuille, indice))
+            indice = premiere_case_vide(feuille);
+        issues[indice][points_mains[h][indice]] += finales[h];
+    }
+}
+
+/**
+ * \struct t_lois_scores
+ * \brief Loi des points restant à marquer depuis chaque état de la feuille, pour une stratégie
+ *
+ * La loi d'un état est indicée par les points marqués d'ici la fin de partie,
+ * bonus compris, de 0 au plus grand total encore possible. Seules les lois du
+ * niveau en cours de calcul et du niveau suivant sont gardées en mémoire.
+ */
+typedef struct {
+    const t_strategie *strategie;   /**< La stratégie qui joue */
+    double **lois;                  /**< Loi de chaque état (masque * NB_SOUS_TOTAUX + sous-total), NULL hors des deux niveaux */
+    int *longueurs;                 /**< Nombre de probabilités de la loi de chaque état */
+    const int *etats;               /**< Les états du niveau en cours */
+    int nb_etats;                   /**< Le nombre d'états du niveau en cours */
+    int prochain;                   /**< Le prochain état à calculer, partagé entre les fils */
+} t_lois_scores;
+
+/**
+ * \fn int longueur_loi(int masque, int sous_total)
+ * \brief Donne le nombre de probabilités de la loi d'un état : le plus grand total encore possible, plus un
+ * \param masque Les cases remplies
+ * \param sous_total Le sous-total supérieur plafonné
+ * \return La longueur de la loi
+ */
+int longueur_loi(int masque, int sous_total) {
+    int longueur = 1;
+
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        if ((masque & (1 << i)) == 0)
+            longueur += points_max[i];
+    }
+    if (sous_total <= BORNE_BONUS && (masque & 0x3F) != 0x3F)
+        longueur += BONUS;
+
+    return longueur;
+}
+
+/**
+ * \fn void calculer_loi_etat(t_lois_scores *lois, int etat, t_alea *alea)
+ * \brief Calcule la loi d'un état à partir des lois du niveau suivant
+ *
+ * Chaque issue du tour décale la loi de l'état qu'elle atteint de ses points,
+ * bonus compris, pondérée par sa probabilité : la boucle de convolution est
+ * contiguë, ce que le compilateur peut vectoriser.
+ * \param lois Les lois, dont celle de l'état, déjà allouée à zéro
+ * \param etat L'état (masque * NB_SOUS_TOTAUX + sous-total)
+ * \param alea Générateur passé à la stratégie
+ */
+void calculer_loi_etat(t_lois_scores *lois, int etat, t_alea *alea) {
+    const int MASQUE = etat / NB_SOUS_TOTAUX;
+    const int SOUS_TOTAL = etat % NB_SOUS_TOTAUX;
+    double issues[TAILLE_FEUILLE][POINTS_CASE_MAX + 1];
+    t_feuille_compacte feuille;
+    double *loi = lois->lois[etat];
+    const double *suite;
+    int suivant, decalage, longueur;
+    double proba;
+
+    // la stratégie ne voit de la feuille que les cases remplies et le total supérieur
+    initialiser_feuille_compacte(&feuille);
+    feuille.remplies = MASQUE;
+    feuille.total_sup = SOUS_TOTAL;
+    feuille.bonus = SOUS_TOTAL > BORNE_BONUS ? BONUS : 0;
+
+    distribution_tour(lois->strategie, &feuille, alea, issues);
+
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        if (MASQUE & (1 << i))
+            continue;
+        for (int points = 0; points <= POINTS_CASE_MAX; points++) {
+            proba = issues[i][points];
+            if (proba == 0)
+                continue;
+
+            decalage = points;
+            suivant = (MASQUE | (1 << i)) * NB_SOUS_TOTAUX + SOUS_TOTAL;
+            if (i < 6) {
+                if (SOUS_TOTAL <= BORNE_BONUS && SOUS_TOTAL + points > BORNE_BONUS)
+                    decalage += BONUS;
+                suivant += plafonner_sous_total(SOUS_TOTAL + points) - SOUS_TOTAL;
+            }
+
+            suite = lois->lois[suivant];
+            longueur = lois->longueurs[suivant];
+            for (int total = 0; total < longueur; total++)
+                loi[decalage + total] += proba * suite[total];
+        }
+    }
+}
+
+/**
+ * \fn void *executer_niveau_lois(void *argument)
+ * \brief Point d'entrée d'un fil du calcul des lois : calcule des états tant qu'il en reste
+ * \param argument Les lois (t_lois_scores)
+ * \return NULL
+ */
+void *executer_niveau_lois(void *argument) {
+    t_lois_scores *lois = argument;
+    t_alea alea;
+    int i;
+
+    initialiser_alea(&alea, 0);
+    while ((i = __atomic_fetch_add(&lois->prochain, 1, __ATOMIC_RELAXED)) < lois->nb_etats)
+        calculer_loi_etat(lois, lois->etats[i], &alea);
+
+    return NULL;
+}
+
+/**
+ * \fn void moments_loi(const double loi[], int longueur, float *moyenne, float *variance)
+ * \brief Calcule la moyenne et la variance d'une loi de points
+ * \param loi La probabilité de chaque total
+ * \param longueur Le nombre de totaux
+ * \param moyenne La moyenne
+ * \param variance La variance
+ */
+void moments_loi(const double loi[], int longueur, float *moyenne, float *variance) {
+    double somme = 0, somme_carres = 0;
+
+    for (int total = 0; total < longueur; total++) {
+        somme += total * loi[total];
+        somme_carres += (double)total * total * loi[total];
+    }
+
+    *moyenne = somme;
+    *variance = fmax(somme_carres - somme * somme, 0);
+}
+
+/**
+ * \fn double *calculer_loi_scores(const t_strategie *strategie, int nb_fils, int *longueur, int *nb_etats, size_t *memoire, float *moyennes, float *variances)
+ * \brief Calcule la loi exacte du total final d'une stratégie, sans simuler de partie
+ *
+ * Comme le solveur, le calcul remonte du niveau le plus rempli au moins rempli,
+ * les états d'un niveau étant répartis entre les fils. Seuls les sous-totaux
+ * atteignables sont calculés, et les lois d'un niveau sont libérées dès que le
+ * niveau précédent est calculé.
+ * \param strategie La stratégie, qui ne doit pas dépendre du hasard
+ * \param nb_fils Le nombre de fils d'exécution
+ * \param longueur Le nombre de probabilités de la loi rendue
+ * \param nb_etats Le nombre d'états calculés
+ * \param memoire La plus grande place prise par les lois de deux niveaux, en octets
+ * \param moyennes La moyenne des points restant à marquer de chaque état atteignable, NULL pour ne pas la garder
+ * \param variances Leur variance, NULL pour ne pas la garder
+ * \return La probabilité de chaque total de 0 à longueur - 1, à libérer avec free
+ */
+double *calculer_loi_scores(const t_strategie *strategie, int nb_fils, int *longueur, int *nb_etats, size_t *memoire,
+        float *moyennes, float *variances) {
+    t_lois_scores lois;
+    double *niveaux[TAILLE_FEUILLE + 1];
+    size_t tailles[TAILLE_FEUILLE + 1];
+    pthread_t *fils;
+    int *etats;
+    double *loi;
+    size_t taille;
+
+    lois.strategie = strategie;
+    lois.lois = calloc(NB_MASQUES * NB_SOUS_TOTAUX, sizeof(double *));
+    lois.longueurs = calloc(NB_MASQUES * NB_SOUS_TOTAUX, sizeof(int));
+    etats = malloc(NB_MASQUES * NB_SOUS_TOTAUX * sizeof(int));
+    fils = malloc(nb_fils * sizeof(pthread_t));
+    *nb_etats = 0;
+    *memoire = 0;
+
+    for (int remplies = TAILLE_FEUILLE; remplies >= 0; remplies--) {
+        // les lois du niveau sont prises dans un seul bloc, à zéro
+        lois.nb_etats = 0;
+        taille = 0;
+        for (int masque = 0; masque < NB_MASQUES; masque++) {
+            if (__builtin_popcount(masque) != remplies)
+                continue;
+            for (int st = 0; st < NB_SOUS_TOTAUX; st++) {
+                if (sous_totaux_possibles[masque & 0x3F] & (1ULL << st)) {
+                    etats[lois.nb_etats++] = masque * NB_SOUS_TOTAUX + st;
+                    lois.longueurs[masque * NB_SOUS_TOTAUX + st] = longueur_loi(masque, st);
+                    taille += longueur_loi(masque, st);
+                }
+            }
+        }
+        niveaux[remplies] = calloc(taille, sizeof(double));
+        tailles[remplies] = taille * sizeof(double);
+        taille = 0;
+        for (int i = 0; i < lois.nb_etats; i++) {
+            lois.lois[etats[i]] = niveaux[remplies] + taille;
+            taille += lois.longueurs[etats[i]];
+        }
+        *nb_etats += lois.nb_etats;
+
+        // une feuille remplie ne rapporte plus rien
+        if (remplies == TAILLE_FEUILLE) {
+            for (int i = 0; i < lois.nb_etats; i++)
+                lois.lois[etats[i]][0] = 1;
+        }
+        else {
+            if (tailles[remplies] + tailles[remplies + 1] > *memoire)
+                *memoire = tailles[remplies] + tailles[remplies + 1];
+
+            lois.etats = etats;
+            lois.prochain = 0;
+            attendre_fils(fils, lancer_fils(fils, nb_fils, executer_niveau_lois, &lois, 0));
+
+            free(niveaux[remplies + 1]);
+        }
+
+        if (moyennes != NULL && variances != NULL) {
+            for (int i = 0; i < lois.nb_etats; i++)
+                moments_loi(lois.lois[etats[i]], lois.longueurs[etats[i]], &moyennes[etats[i]], &variances[etats[i]]);
+        }
+    }
+
+    *longueur = lois.longueurs[0];
+    loi = malloc(*longueur * sizeof(double));
+    memcpy(loi, lois.lois[0], *longueur * sizeof(double));
+
+    free(niveaux[0]);
+    free(fils);
+    free(etats);
+    free(lois.longueurs);
+    free(lois.lois);
+
+    return loi;
+}
+
+/**
+ * \fn bool mode_distribution(const t_options *options)
+ * \brief Calcule et affiche la loi exacte du total final d'une stratégie jouant seule
+ * \param options Les options de la ligne de commande
+ * \return Vrai si la loi a été calculée, faux si la stratégie dépend du hasard ou si le fichier de sortie est inutilisable
+ */
+bool mode_distribution(const t_options *options) {
+    const double CENTILES[] = {0.001, 0.01, 0.05, 0.10, 0.25, 0.50, 0.75, 0.90, 0.95, 0.99, 0.999};
+    const int SEUILS[] = {150, 200, 250, 300, 350};
+    const t_strategie *strategie = options->strategies[0];
+    t_table_optimale table;
+    t_finale finale;
+    double *loi;
+    int longueur, nb_etats, minimum, maximum, c;
+    size_t memoire;
+    double debut, duree, moyenne, variance, cumul;
+    FILE *sortie;
+
+    if (strategie->aleatoire) {
+        fprintf(stderr, "La stratégie %s dépend du hasard : sa loi ne se calcule pas état par état\n", strategie->nom);
+        return false;
+    }
+    if (!preparer_strategie_optimale(options, &strategie, 1, &table))
+        return false;
+    if (!preparer_strategie_victoire(options, &strategie, 1, &finale)) {
+        liberer_strategie_optimale(&table);
+        return false;
+    }
+
+    debut = horloge();
+    loi = calculer_loi_scores(strategie, options->nb_fils, &longueur, &nb_etats, &memoire, NULL, NULL);
+    duree = horloge() - debut;
+
+    liberer_strategie_victoire(&finale);
+    liberer_strategie_optimale(&table);
+
+    moyenne = 0;
+    variance = 0;
+    cumul = 0;
+    minimum = -1;
+    maximum = 0;
+    for (int total = 0; total < longueur; total++) {
+        moyenne += total * loi[total];
+        variance += (double)total * total * loi[total];
+        cumul += loi[total];
+        if (loi[total] > 0) {
+            if (minimum < 0)
+                minimum = total;
+            maximum = total;
+        }
+    }
+    variance -= moyenne * moyenne;
+
+    printf("Loi exacte du total de la stratégie %s : %d états calculés en %.3f s avec %d fils d'exécution (%.0f Mo)\n",
+        strategie->nom, nb_etats, duree, options->nb_fils, memoire / 1e6);
+    printf("Moyenne %.4f, écart type %.4f, somme des probabilités %.12f\n", moyenne, sqrt(variance), cumul);
+    printf("Total minimum %d (probabilité %.3e), maximum %d (probabilité %.3e)\n",
+        minimum, loi[minimum], maximum, loi[maximum]);
+
+    printf("\n%-10s %6s\n", "Centile", "Total");
+    cumul = 0;
+    c = 0;
+    for (int total = 0; total < longueur && c < (int)(sizeof(CENTILES) / sizeof(CENTILES[0])); total++) {
+        cumul += loi[total];
+        while (c < (int)(sizeof(CENTILES) / sizeof(CENTILES[0])) && cumul >= CENTILES[c]) {
+            printf("%8.1f %% %6d\n", 100 * CENTILES[c], total);
+            c++;
+        }
+    }
+
+    printf("\n%-10s %12s\n", "Total", "Probabilité");
+    for (size_t s = 0; s < sizeof(SEUILS) / sizeof(SEUILS[0]); s++) {
+        cumul = 0;
+        for (int total = SEUILS[s]; total < longueur; total++)
+            cumul += loi[total];
+        printf(">= %-7d %12.4e\n", SEUILS[s], cumul);
+    }
+
+    if (options->fichier_sortie != NULL) {
+        sortie = fopen(options->fichier_sortie, "w");
+        if (sortie == NULL) {
+            fprintf(stderr, "Impossible de créer %s\n", options->fichier_sortie);
+            free(loi);
+            return false;
+        }
+        cumul = 0;
+        fprintf(sortie, "total probabilite cumul\n");
+        for (int total = 0; total < longueur; total++) {
+            cumul += loi[total];
+            fprintf(sortie, "%d %.17g %.17g\n", total, loi[total], cumul);
+        }
+        fclose(sortie);
+        printf("\nLoi enregistrée dans %s\n", options->fichier_sortie);
+    }
+
+    free(loi);
+
+    return true;
+}
+
+/**
+ * \struct t_construction_finale
+ * \brief Pli de la table de fin de partie en construction, réparti entre les fils par masque du joueur au trait
+ */
+typedef struct {
+    const t_finale *finale;         /**< La table, dont les plis précédents sont construits */
+    uint16_t *pli;                  /**< Le pli en construction */
+    int plis;                       /**< Le nombre de plis restants des positions du pli */
+    const int *masques;             /**< Les masques du joueur au trait */
+    int nb_masques;                 /**< Le nombre de masques du joueur au trait */
+    const int *masques_adversaire;  /**< Les masques de l'adversaire */
+    int nb_masques_adversaire;      /**< Le nombre de masques de l'adversaire */
+    int prochain;                   /**< Le prochain masque du joueur au trait, partagé entre les fils */
+} t_construction_finale;
+
+/**
+ * \fn int sous_total_besoin(int besoin)
+ * \brief Donne un sous-total qui laisse un besoin donné pour le bonus, représentant de l'état réduit
+ * \param besoin Les points qui manquent pour le bonus, 0 s'il n'est plus en jeu
+ * \return Le sous-total plafonné
+ */
+int sous_total_besoin(int besoin) {
+    return BORNE_BONUS + 1 - besoin;
+}
+
+/**
+ * \fn void construire_masque_finale(const t_construction_finale *construction, int masque)
+ * \brief Calcule la probabilité de victoire de toutes les positions d'un pli où le joueur au trait a un masque donné
+ *
+ * Les positions déjà jouées, où l'un des joueurs ne peut plus être rattrapé,
+ * sont écrites sans calcul.
+ * \param construction Le pli en construction
+ * \param masque Les cases remplies du joueur au trait
+ */
+void construire_masque_finale(const t_construction_finale *construction, int masque) {
+    const t_finale *finale = construction->finale;
+    const int LIBRES = (construction->plis + 1) / 2;
+    const int LIBRES_ADVERSAIRE = construction->plis / 2;
+    const int LARGEUR = largeur_pli(construction->plis);
+    t_evaluation_tour evaluation;
+    uint16_t *probas;
+    int masque_adversaire, sous_total, sous_total_adversaire, gain, gain_adversaire, etat, etat_adversaire;
+    double proba;
+
+    for (int besoin = 0; besoin <= reste_superieur(masque); besoin++) {
+        sous_total = sous_total_besoin(besoin);
+        gain = longueur_loi(masque, sous_total) - 1;
+        etat = finale->debut_etats[masque] + besoin;
+
+        for (int m = 0; m < construction->nb_masques_adversaire; m++) {
+            masque_adversaire = construction->masques_adversaire[m];
+            for (int besoin_adversaire = 0; besoin_adversaire <= reste_superieur(masque_adversaire); besoin_adversaire++) {
+                sous_total_adversaire = sous_total_besoin(besoin_adversaire);
+                gain_adversaire = longueur_loi(masque_adversaire, sous_total_adversaire) - 1;
+                etat_adversaire = finale->debut_etats[masque_adversaire] + besoin_adversaire;
+                probas = construction->pli + ((size_t)etat * finale->nb_etats[LIBRES_ADVERSAIRE] + etat_adversaire) * LARGEUR;
+
+                for (int avance = -gain_max(LIBRES); avance <= gain_max(LIBRES_ADVERSAIRE); avance++) {
+                    if (avance > gain_adversaire)
+                        proba = 1;
+                    else if (avance + gain < 0)
+                        proba = 0;
+                    else {
+                        preparer_evaluation_victoire(finale, masque, sous_total, masque_adversaire,
+                            sous_total_adversaire, avance, &evaluation);
+                        proba = fmin(fmax(evaluation.esperance, 0), 1);
+                    }
+                    probas[avance + gain_max(LIBRES)] = lround(proba * ECHELLE_FINALE);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * \fn void *executer_construction_finale(void *argument)
+ * \brief Point d'entrée d'un fil de la construction : calcule des masques tant qu'il en reste
+ * \param argument Le pli en construction (t_construction_finale)
+ * \return NULL
+ */
+void *executer_construction_finale(void *argument) {
+    t_construction_finale *construction = argument;
+    int i;
+
+    while ((i = __atomic_fetch_add(&construction->prochain, 1, __ATOMIC_RELAXED)) < construction->nb_masques)
+        construire_masque_finale(construction, construction->masques[i]);
+
+    return NULL;
+}
+
+/**
+ * \fn void construire_pli_finale(t_finale *finale, uint16_t *pli, int plis, int nb_fils)
+ * \brief Résout un pli de la table de fin de partie, à partir du pli précédent
+ * \param finale La table, dont les plis précédents sont construits, complétée de ce pli
+ * \param pli La place du pli dans le bloc de la table
+ * \param plis Le nombre de plis restants
+ * \param nb_fils Le nombre de fils d'exécution
+ */
+void construire_pli_finale(t_finale *finale, uint16_t *pli, int plis, int nb_fils) {
+    t_construction_finale construction;
+    pthread_t *fils;
+    int *masques, *masques_adversaire;
+
+    masques = malloc(NB_MASQUES * sizeof(int));
+    masques_adversaire = malloc(NB_MASQUES * sizeof(int));
+    fils = malloc(nb_fils * sizeof(pthread_t));
+
+    construction.finale = finale;
+    construction.pli = pli;
+    construction.plis = plis;
+    construction.masques = masques;
+    construction.masques_adversaire = masques_adversaire;
+    construction.nb_masques = 0;
+    construction.nb_masques_adversaire = 0;
+    construction.prochain = 0;
+    for (int masque = 0; masque < NB_MASQUES; masque++) {
+        if (TAILLE_FEUILLE - __builtin_popcount(masque) == (plis + 1) / 2)
+            masques[construction.nb_masques++] = masque;
+        if (TAILLE_FEUILLE - __builtin_popcount(masque) == plis / 2)
+            masques_adversaire[construction.nb_masques_adversaire++] = masque;
+    }
+
+    attendre_fils(fils, lancer_fils(fils, nb_fils, executer_construction_finale, &construction, 0));
+
+    finale->plis[plis] = pli;
+    finale->nb_plis = plis;
+
+    free(fils);
+    free(masques_adversaire);
+    free(masques);
+}
+
+/**
+ * \fn bool enregistrer_finale(const char fichier[], t_finale *finale)
+ * \brief Complète l'en-tête d'une table de fin de partie construite, puis l'enregistre d'un bloc
+ *
+ * Comme la table optimale, elle est écrite dans un fichier temporaire renommé une fois complet.
+ * \param fichier Le nom du fichier
+ * \param finale La table construite
+ * \return Vrai si le fichier est écrit, faux sinon
+ */
+bool enregistrer_finale(const char fichier[], t_finale *finale) {
+    t_entete_finale *entete = finale->bloc;
+    char temporaire[PATH_MAX];
+    FILE *flux;
+    bool correct;
+
+    memset(entete, 0, sizeof(*entete));
+    memcpy(entete->magie, MAGIE_FINALE, sizeof(entete->magie));
+    entete->version = VERSION_FINALE;
+    entete->taille_entete = sizeof(*entete);
+    entete->nb_plis = finale->nb_plis;
+    entete->nb_masques = NB_MASQUES;
+    entete->nb_sous_totaux = NB_SOUS_TOTAUX;
+    entete->bonus = BONUS;
+    entete->borne_bonus = BORNE_BONUS;
+    entete->taille_donnees = finale->taille - sizeof(*entete);
+    entete->somme_donnees = somme_controle(entete + 1, entete->taille_donnees);
+    entete->somme_entete = somme_controle(entete, offsetof(t_entete_finale, somme_entete));
+
+    snprintf(temporaire, sizeof(temporaire), "%s.tmp", fichier);
+    flux = fopen(temporaire, "wb");
+    if (flux == NULL) {
+        fprintf(stderr, "Impossible de créer %s\n", temporaire);
+        return false;
+    }
+
+    correct = fwrite(finale->bloc, finale->taille, 1, flux) == 1;
+    correct = (fclose(flux) == 0) && correct;
+    correct = correct && rename(temporaire, fichier) == 0;
+
+    if (!correct) {
+        fprintf(stderr, "Erreur d'écriture de %s\n", fichier);
+        remove(temporaire);
+    }
+
+    return correct;
+}
+
+/**
+ * \fn bool mode_construction_finale(const t_options *options)
+ * \brief Construit la table de fin de partie en tête à tête et l'enregistre
+ *
+ * Les moyennes et variances des points restant à marquer viennent de la loi
+ * exacte de la stratégie optimale (calculer_loi_scores). Les plis sont ensuite
+ * résolus du dernier au premier, chacun d'après le précédent.
+ * \param options Les options de la ligne de commande
+ * \return Vrai si la table est enregistrée, faux sinon
+ */
+bool mode_construction_finale(const t_options *options) {
+    const t_strategie *optimale = rechercher_strategie("optimal");
+    t_table_optimale table;
+    t_finale finale;
+    char *donnees;
+    double *loi;
+    double debut;
+    size_t memoire;
+    int longueur, nb_etats;
+    bool correct;
+
+    if (!preparer_strategie_optimale(options, &optimale, 1, &table))
+        return false;
+
+    // tout est pris d'un bloc, dans l'ordre du fichier
+    initialiser_finale(&finale);
+    finale.projete = false;
+    finale.taille = sizeof(t_entete_finale) + taille_donnees_finale(&finale, options->nb_plis);
+    finale.bloc = calloc(1, finale.taille);
+    if (finale.bloc == NULL) {
+        fprintf(stderr, "Pas assez de mémoire pour %d plis (%.0f Mo)\n", options->nb_plis, finale.taille / 1e6);
+        liberer_strategie_optimale(&table);
+        return false;
+    }
+    placer_donnees_finale(&finale, 0);
+    donnees = (char *)finale.bloc + sizeof(t_entete_finale);
+
+    debut = horloge();
+    loi = calculer_loi_scores(optimale, options->nb_fils, &longueur, &nb_etats, &memoire,
+        (float *)donnees, (float *)(donnees + NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float)));
+    free(loi);
+    liberer_strategie_optimale(&table);
+    printf("Moyenne et variance de %d états en %.3f s\n", nb_etats, horloge() - debut);
+
+    donnees += 2 * NB_MASQUES * NB_SOUS_TOTAUX * sizeof(float);
+    for (int plis = 1; plis <= options->nb_plis; plis++) {
+        debut = horloge();
+        construire_pli_finale(&finale, (uint16_t *)donnees, plis, options->nb_fils);
+        printf("Pli %d : %zu positions en %.3f s (%.1f Mo)\n", plis, taille_pli(&finale, plis),
+            horloge() - debut, taille_pli(&finale, plis) * sizeof(uint16_t) / 1e6);
+        donnees += taille_pli(&finale, plis) * sizeof(uint16_t);
+    }
+
+    correct = enregistrer_finale(options->fichier_sortie, &finale);
+    if (correct)
+        printf("Table de fin de partie enregistrée dans %s (%.1f Mo)\n", options->fichier_sortie, finale.taille / 1e6);
+    fermer_finale(&finale);
+
+    return correct;
+}
+
+/**
+ * \def YAMS_API
+ * \brief Rend visible une fonction de l'interface binaire, quand la bibliothèque est compilée avec -fvisibility=hidden
+ */
+/**
+ * \def ACTION_CASE
+ * \brief Première action qui inscrit la main dans une case : l'action ACTION_CASE + i remplit la case i
+ *
+ * Les actions 0 à GARDER_TOUT - 1 gardent les dés dont le bit est à 1 et
+ * relancent les autres ; garder tous les dés n'est pas une action, il suffit
+ * de choisir une case.
+ */
+/**
+ * \def NB_ACTIONS
+ * \brief Nombre d'actions de l'environnement
+ */
+/**
+ * \def PARTIES_MIN_FIL
+ * \brief Nombre minimum de parties avancées par un fil, en dessous duquel un fil de plus coûte plus qu'il ne rapporte
+ */
+#define YAMS_API __attribute__((visibility("default")))
+#define ACTION_CASE (GARDER_TOUT + 1)
+#define NB_ACTIONS (ACTION_CASE + TAILLE_FEUILLE)
+#define PARTIES_MIN_FIL 4096
+
+/**
+ * \struct t_environnement
+ * \brief Lot de parties solitaires avancées au même pas, pour l'entraînement de joueurs
+ *
+ * Chaque partie a son propre générateur : une partie ne dépend que de la
+ * graine et de ses actions, pas du nombre de fils ni des autres parties.
+ * Déclaré dans yams.h, où t_vue_environnement décrit ses tableaux.
+ */
+struct s_environnement {
+    int nb_parties;             /**< Nombre de parties */
+    int nb_fils;                /**< Nombre maximum de fils d'un pas */
+    uint8_t *des;               /**< Voir t_vue_environnement */
+    uint8_t *lancers_restants;  /**< Voir t_vue_environnement */
+    int8_t *feuilles;           /**< Voir t_vue_environnement */
+    uint8_t *totaux_sup;        /**< Voir t_vue_environnement */
+    int16_t *totaux;            /**< Voir t_vue_environnement */
+    uint64_t *masques_actions;  /**< Voir t_vue_environnement */
+    float *recompenses;         /**< Voir t_vue_environnement */
+    uint8_t *terminees;         /**< Voir t_vue_environnement */
+    int16_t *scores_finals;     /**< Voir t_vue_environnement */
+    uint16_t *remplies;         /**< Bit i à 1 si la case i de la partie est remplie */
+    t_alea *aleas;              /**< Le générateur de chaque partie */
+};
+
+/**
+ * \struct t_plage_environnement
+ * \brief Parties d'un environnement avancées par un même fil
+ */
+typedef struct {
+    t_environnement *environnement;     /**< L'environnement */
+    const uint8_t *actions;             /**< L'action de chaque partie de l'environnement */
+    int debut;                          /**< La première partie de la plage */
+    int fin;                            /**< La partie qui suit la dernière */
+    int invalides;                      /**< Le nombre d'actions refusées dans la plage */
+} t_plage_environnement;
+
+/**
+ * \fn uint64_t masque_actions(uint16_t remplies, int lancers_restants)
+ * \brief Donne les actions permises : les gardes tant qu'il reste une relance, et les cases vides
+ * \param remplies Les cases remplies
+ * \param lancers_restants Les relances restantes
+ * \return Bit a à 1 si l'action a est permise
+ */
+uint64_t masque_actions(uint16_t remplies, int lancers_restants) {
+    const uint64_t CASES = (1 << TAILLE_FEUILLE) - 1;
+    uint64_t masque = (CASES & ~(uint64_t)remplies) << ACTION_CASE;
+
+    if (lancers_restants > 0)
+        masque |= (1ULL << GARDER_TOUT) - 1;
+
+    return masque;
+}
+
+/**
+ * \fn void lancer_des_environnement(t_environnement *environnement, int k, int garde)
+ * \brief Relance les dés non gardés d'une partie
+ * \param environnement L'environnement
+ * \param k La partie
+ * \param garde Bit i à 1 si le dé i est gardé
+ */
+void lancer_des_environnement(t_environnement *environnement, int k, int garde) {
+    DEBUT_MESURE();
+
+    for (int i = 0; i < NB_DES; i++) {
+        if ((garde & (1 << i)) == 0)
+            environnement->des[i * environnement->nb_parties + k] = lancer_de(&environnement->aleas[k]);
+    }
+
+    FIN_MESURE(PHASE_LANCER);
+}
+
+/**
+ * \fn void commencer_partie_environnement(t_environnement *environnement, int k)
+ * \brief Vide la feuille d'une partie et lance les dés de son premier tour
+ * \param environnement L'environnement
+ * \param k La partie
+ */
+void commencer_partie_environnement(t_environnement *environnement, int k) {
+    const int N = environnement->nb_parties;
+
+    for (int i = 0; i < TAILLE_FEUILLE; i++)
+        environnement->feuilles[i * N + k] = CASE_VIDE;
+    environnement->remplies[k] = 0;
+    environnement->totaux_sup[k] = 0;
+    environnement->totaux[k] = 0;
+    environnement->lancers_restants[k] = NB_LANCERS - 1;
+    environnement->masques_actions[k] = masque_actions(0, NB_LANCERS - 1);
+    lancer_des_environnement(environnement, k, 0);
+}
+
+/**
+ * \fn int points_environnement(const t_environnement *environnement, int k, int indice)
+ * \brief Donne les points que rapportent les dés d'une partie dans une case
+ * \param environnement L'environnement
+ * \param k La partie
+ * \param indice L'indice de la case
+ * \return Les points
+ */
+int points_environnement(const t_environnement *environnement, int k, int indice) {
+    const int N = environnement->nb_parties;
+    int code = 0, points;
+    DEBUT_MESURE();
+
+    for (int i = NB_DES - 1; i >= 0; i--)
+        code = code * 6 + environnement->des[i * N + k] - 1;
+    points = points_mains[indice_tirages[code]][indice];
+
+    FIN_MESURE(PHASE_COMBINAISONS);
+    return points;
+}
+
+/**
+ * \fn int inscrire_environnement(t_environnement *environnement, int k, int indice, int points)
+ * \brief Inscrit des points dans une case libre d'une partie et met à jour ses totaux
+ * \param environnement L'environnement
+ * \param k La partie
+ * \param indice L'indice de la case
+ * \param points Les points inscrits
+ * \return Le bonus gagné par cette inscription, 0 sinon
+ */
+int inscrire_environnement(t_environnement *environnement, int k, int indice, int points) {
+    const int N = environnement->nb_parties;
+    int bonus = 0;
+    DEBUT_MESURE();
+
+    if (indice < 6) {
+        // le bonus est compté à l'inscription qui fait passer la borne
+        if (environnement->totaux_sup[k] <= BORNE_BONUS && environnement->totaux_sup[k] + points > BORNE_BONUS)
+            bonus = BONUS;
+        environnement->totaux_sup[k] += points;
+    }
+    environnement->feuilles[indice * N + k] = points;
+    environnement->remplies[k] |= 1 << indice;
+    environnement->totaux[k] += points + bonus;
+
+    FIN_MESURE(PHASE_TOTAUX);
+    return bonus;
+}
+
+/**
+ * \fn bool avancer_partie_environnement(t_environnement *environnement, int k, int action)
+ * \brief Joue une action dans une partie : relance ou inscription, puis tour ou partie suivante
+ *
+ * Une action refusée laisse la partie inchangée, sans récompense.
+ * \param environnement L'environnement
+ * \param k La partie
+ * \param action L'action, entre 0 et NB_ACTIONS - 1
+ * \return Vrai si l'action est permise, faux sinon
+ */
+bool avancer_partie_environnement(t_environnement *environnement, int k, int action) {
+    int points, bonus, indice;
+
+    environnement->recompenses[k] = 0;
+    environnement->terminees[k] = 0;
+    if (action >= NB_ACTIONS || (environnement->masques_actions[k] & (1ULL << action)) == 0)
+        return false;
+
+    if (action < ACTION_CASE) {
+        lancer_des_environnement(environnement, k, action);
+        environnement->lancers_restants[k]--;
+    }
+    else {
+        indice = action - ACTION_CASE;
+        points = points_environnement(environnement, k, indice);
+        bonus = inscrire_environnement(environnement, k, indice, points);
+        environnement->recompenses[k] = points + bonus;
+        COMPTER_TOUR(indice, points, NB_LANCERS - environnement->lancers_restants[k]);
+
+        if (environnement->remplies[k] == (1 << TAILLE_FEUILLE) - 1) {
+            environnement->terminees[k] = 1;
+            environnement->scores_finals[k] = environnement->totaux[k];
+            commencer_partie_environnement(environnement, k);
+            return true;
+        }
+
+        lancer_des_environnement(environnement, k, 0);
+        environnement->lancers_restants[k] = NB_LANCERS - 1;
+    }
+
+    environnement->masques_actions[k] = masque_actions(environnement->remplies[k], environnement->lancers_restants[k]);
+    return true;
+}
+
+/**
+ * \fn void *executer_plage_environnement(void *argument)
+ * \brief Point d'entrée d'un fil : avance les parties d'une plage
+ * \param argument La plage (t_plage_environnement)
+ * \return NULL
+ */
+void *executer_plage_environnement(void *argument) {
+    t_plage_environnement *plage = argument;
+
+    plage->invalides = 0;
+    for (int k = plage->debut; k < plage->fin; k++) {
+        if (!avancer_partie_environnement(plage->environnement, k, plage->actions[k]))
+            plage->invalides++;
+    }
+
+    return NULL;
+}
+
+/**
+ * \var initialisation_bibliotheque
+ * \brief Garantit que les tables de points sont construites une seule fois, quel que soit le fil appelant
+ */
+pthread_once_t initialisation_bibliotheque = PTHREAD_ONCE_INIT;
+
+/**
+ * \fn int yams_version_abi()
+ * \brief Donne la version de l'interface binaire, à comparer avec celle attendue par l'appelant
+ * \return VERSION_ABI
+ */
+YAMS_API int yams_version_abi() {
+    return VERSION_ABI;
+}
+
+/**
+ * \fn void yams_detruire_environnement(t_environnement *environnement)
+ * \brief Libère un environnement ; ses tableaux ne doivent plus être lus
+ * \param environnement L'environnement, ou NULL
+ */
+YAMS_API void yams_detruire_environnement(t_environnement *environnement) {
+    if (environnement == NULL)
+        return;
+
+    free(environnement->des);
+    free(environnement->lancers_restants);
+    free(environnement->feuilles);
+    free(environnement->totaux_sup);
+    free(environnement->totaux);
+    free(environnement->masques_actions);
+    free(environnement->recompenses);
+    free(environnement->terminees);
+    free(environnement->scores_finals);
+    free(environnement->remplies);
+    free(environnement->aleas);
+    free(environnement);
+}
+
+/**
+ * \fn void yams_vue_environnement(const t_environnement *environnement, t_vue_environnement *vue)
+ * \brief Donne les tableaux de l'environnement, valables jusqu'à sa destruction
+ * \param environnement L'environnement
+ * \param vue Les tableaux, mis à jour en place à chaque pas
+ */
+YAMS_API void yams_vue_environnement(const t_environnement *environnement, t_vue_environnement *vue) {
+    vue->nb_parties = environnement->nb_parties;
+    vue->nb_actions = NB_ACTIONS;
+    vue->des = environnement->des;
+    vue->lancers_restants = environnement->lancers_restants;
+    vue->feuilles = environnement->feuilles;
+    vue->totaux_sup = environnement->totaux_sup;
+    vue->totaux = environnement->totaux;
+    vue->masques_actions = environnement->masques_actions;
+    vue->recompenses = environnement->recompenses;
+    vue->terminees = environnement->terminees;
+    vue->scores_finals = environnement->scores_finals;
+}
+
+/**
+ * \fn void yams_reinitialiser(t_environnement *environnement)
+ * \brief Recommence toutes les parties, sans réinitialiser les générateurs
+ * \param environnement L'environnement
+ */
+YAMS_API void yams_reinitialiser(t_environnement *environnement) {
+    for (int k = 0; k < environnement->nb_parties; k++) {
+        commencer_partie_environnement(environnement, k);
+        environnement->recompenses[k] = 0;
+        environnement->terminees[k] = 0;
+        environnement->scores_finals[k] = 0;
+    }
+}
+
+/**
+ * \fn t_environnement *yams_creer_environnement(int nb_parties, int nb_fils, uint64_t graine)
+ * \brief Crée un environnement de parties toutes commencées
+ * \param nb_parties Le nombre de parties avancées à chaque pas
+ * \param nb_fils Le nombre maximum de fils d'un pas de yams_avancer
+ * \param graine La graine des générateurs des parties
+ * \return L'environnement, ou NULL si les paramètres sont incorrects ou la mémoire insuffisante
+ */
+YAMS_API t_environnement *yams_creer_environnement(int nb_parties, int nb_fils, uint64_t graine) {
+    t_environnement *environnement;
+    t_alea alea;
+    size_t n;
+
+    if (nb_parties < 1 || nb_fils < 1)
+        return NULL;
+    pthread_once(&initialisation_bibliotheque, initialiser_tables);
+
+    environnement = calloc(1, sizeof(t_environnement));
+    if (environnement == NULL)
+        return NULL;
+    environnement->nb_parties = nb_parties;
+    environnement->nb_fils = nb_fils;
+
+    // chaque tableau commence sur une ligne de cache, et les fils écrivent des plages contiguës
+#define ALLOUER_TABLEAU(champ, nb) \
+    environnement->champ = aligned_alloc(64, ((nb) * sizeof(*environnement->champ) + 63) / 64 * 64)
+    n = nb_parties;
+    ALLOUER_TABLEAU(des, NB_DES * n);
+    ALLOUER_TABLEAU(lancers_restants, n);
+    ALLOUER_TABLEAU(feuilles, TAILLE_FEUILLE * n);
+    ALLOUER_TABLEAU(totaux_sup, n);
+    ALLOUER_TABLEAU(totaux, n);
+    ALLOUER_TABLEAU(masques_actions, n);
+    ALLOUER_TABLEAU(recompenses, n);
+    ALLOUER_TABLEAU(terminees, n);
+    ALLOUER_TABLEAU(scores_finals, n);
+    ALLOUER_TABLEAU(remplies, n);
+    ALLOUER_TABLEAU(aleas, n);
+#undef ALLOUER_TABLEAU
+
+    if (environnement->des == NULL || environnement->lancers_restants == NULL || environnement->feuilles == NULL
+            || environnement->totaux_sup == NULL || environnement->totaux == NULL
+            || environnement->masques_actions == NULL || environnement->recompenses == NULL
+            || environnement->terminees == NULL || environnement->scores_finals == NULL
+            || environnement->remplies == NULL || environnement->aleas == NULL) {
+        yams_detruire_environnement(environnement);
+        return NULL;
+    }
+
+    initialiser_alea(&alea, graine);
+    for (int k = 0; k < nb_parties; k++) {
+        environnement->aleas[k] = alea;
+        sauter_alea(&alea);
+    }
+    yams_reinitialiser(environnement);
+
+    return environnement;
+}
+
+/**
+ * \fn int yams_avancer_plage(t_environnement *environnement, const uint8_t actions[], int debut, int fin)
+ * \brief Avance d'un pas les parties debut à fin - 1
+ *
+ * Des appels sur des plages disjointes peuvent être faits en même temps
+ * depuis les fils de l'appelant.
+ * \param environnement L'environnement
+ * \param actions L'action de chaque partie de l'environnement, indicée par la partie
+ * \param debut La première partie
+ * \param fin La partie qui suit la dernière
+ * \return Le nombre d'actions refusées, dont les parties restent inchangées, ou -1 si la plage est incorrecte
+ */
+YAMS_API int yams_avancer_plage(t_environnement *environnement, const uint8_t actions[], int debut, int fin) {
+    t_plage_environnement plage = {environnement, actions, debut, fin, 0};
+
+    if (debut < 0 || fin > environnement->nb_parties || debut > fin)
+        return -1;
+
+    executer_plage_environnement(&plage);
+    return plage.invalides;
+}
+
+/**
+ * \fn int yams_avancer(t_environnement *environnement, const uint8_t actions[])
+ * \brief Avance d'un pas toutes les parties, réparties entre les fils par plages contiguës
+ * \param environnement L'environnement
+ * \param actions L'action de chaque partie
+ * \return Le nombre d'actions refusées, dont les parties restent inchangées
+ */
+YAMS_API int yams_avancer(t_environnement *environnement, const uint8_t actions[]) {
+    const int N = environnement->nb_parties;
+    int nb_fils = environnement->nb_fils;
+    int invalides = 0;
+
+    if (nb_fils > N / PARTIES_MIN_FIL)
+        nb_fils = N / PARTIES_MIN_FIL > 0 ? N / PARTIES_MIN_FIL : 1;
+    if (nb_fils == 1)
+        return yams_avancer_plage(environnement, actions, 0, N);
+
+    t_plage_environnement plages[nb_fils];
+    pthread_t fils[nb_fils];
+
+    for (int i = 0; i < nb_fils; i++) {
+        plages[i].environnement = environnement;
+        plages[i].actions = actions;
+        plages[i].debut = (long)N * i / nb_fils;
+        plages[i].fin = (long)N * (i + 1) / nb_fils;
+    }
+
+    attendre_fils(fils, lancer_fils(fils, nb_fils, executer_plage_environnement, plages, sizeof(t_plage_environnement)));
+    for (int i = 0; i < nb_fils; i++) {
+        invalides += plages[i].invalides;
+    }
+
+    return invalides;
+}
+
+/**
+ * \fn bool verifier_environnement(uint64_t graine)
+ * \brief Vérifie qu'un environnement neuf permet chacune des gardes, et que chacune garde bien ses dés
+ *
+ * La partie k joue la garde k, de 0 à GARDER_TOUT - 1 : après le pas, ses dés
+ * gardés sont inchangés, et les gardes restent permises pour la dernière relance.
+ * \param graine La graine de l'environnement
+ * \return Vrai si l'environnement est correct, faux sinon
+ */
+bool verifier_environnement(uint64_t graine) {
+    const int N = GARDER_TOUT;                          // une partie par garde
+    const uint64_t GARDES = (1ULL << GARDER_TOUT) - 1;  // les actions de garde
+    t_environnement *environnement;
+    uint8_t actions[GARDER_TOUT], gardes[NB_DES][GARDER_TOUT];
+    bool correct = true;
+
+    environnement = yams_creer_environnement(N, 1, graine);
+    if (environnement == NULL) {
+        fprintf(stderr, "Pas assez de mémoire pour l'environnement\n");
+        return false;
+    }
+
+    for (int k = 0; k < N; k++) {
+        correct = correct && (environnement->masques_actions[k] & GARDES) == GARDES;
+        actions[k] = k;
+        for (int i = 0; i < NB_DES; i++)
+            gardes[i][k] = environnement->des[i * N + k];
+    }
+
+    correct = correct && yams_avancer(environnement, actions) == 0;
+    for (int k = 0; k < N; k++) {
+        correct = correct && environnement->lancers_restants[k] == NB_LANCERS - 2
+            && (environnement->masques_actions[k] & GARDES) == GARDES;
+        for (int i = 0; i < NB_DES; i++) {
+            if (k & (1 << i))
+                correct = correct && environnement->des[i * N + k] == gardes[i][k];
+        }
+    }
+
+    yams_detruire_environnement(environnement);
+    if (!correct)
+        fprintf(stderr, "L'environnement refuse ou altère des gardes permises\n");
+    return correct;
+}
+
+/**
+ * \def TAILLE_LOT_POINTS
+ * \brief Nombre de mains comptées ensemble par calculer_points_lot, une par octet d'un vecteur
+ *
+ * Comme pour TAILLE_LOT_TRI, 32 octets ne remplissent un registre qu'avec AVX2
+ * à la compilation : la version SSE4.1 d'un vecteur de 32 octets est découpée
+ * en comparaisons scalaires, et 16 octets restent natifs pour toutes les cibles.
+ */
+/**
+ * \def CIBLES_POINTS
+ * \brief Compile calculer_points_lot pour AVX2, SSE4.1 et la cible par défaut, la version utilisée étant choisie au chargement selon le processeur
+ *
+ * Hors x86-64, le compilateur traduit les vecteurs pour la cible (NEON...),
+ * ou en instructions scalaires.
+ */
+#ifdef __AVX2__
+#define TAILLE_LOT_POINTS 32
+#else
+#define TAILLE_LOT_POINTS 16
+#endif
+#if defined(__x86_64__) && !defined(__clang__)
+#define CIBLES_POINTS __attribute__((target_clones("avx2", "sse4.1", "default")))
+#else
+#define CIBLES_POINTS
+#endif
+
+/**
+ * \typedef uint8_t t_voies_octets
+ * \brief Même dé ou même compte de TAILLE_LOT_POINTS mains, un octet par main
+ */
+typedef uint8_t t_voies_octets __attribute__((vector_size(TAILLE_LOT_POINTS)));
+
+/**
+ * \fn void calculer_points_lot(const uint8_t des[], int nb_mains, uint8_t points[])
+ * \brief Calcule les points des 13 cases pour un lot de mains, rangées dé par dé
+ *
+ * Les mains sont traitées par TAILLE_LOT_POINTS : chaque octet d'un vecteur
+ * suit une main, et les comptes des six faces donnent toutes les cases sans
+ * un seul saut. Les mains qui restent sont lues dans points_mains. Les points
+ * sont ceux des fonctions de combinaisons (brelan, full_house...).
+ * \param des Le dé i de la main k à l'indice i * nb_mains + k, de 1 à 6
+ * \param nb_mains Le nombre de mains
+ * \param points Les points de la case c pour la main k à l'indice c * nb_mains + k
+ */
+CIBLES_POINTS
+void calculer_points_lot(const uint8_t des[], int nb_mains, uint8_t points[]) {
+    t_voies_octets d1, d2, d3, d4, d5, m1, m2, m3, m4, m5;
+    t_voies_octets c1, c2, c3, c4, c5, c6, somme, paires, triples, carres, yams, milieu;
+    t_des main_des;
+    int k;
+
+#define CHARGER_VOIES(i, de) memcpy(&(de), des + (size_t)(i) * nb_mains + k, sizeof(de))
+#define ECRIRE_VOIES(indice, valeur) do { \
+        t_voies_octets v = (valeur); \
+        memcpy(points + (size_t)(indice) * nb_mains + k, &v, sizeof(v)); \
+    } while (0)
+    // une comparaison vaut -1 par main dont le dé montre la face
+#define COMPTER_FACE(face, compte) do { \
+        m1 = (t_voies_octets)(d1 == (uint8_t)(face)); \
+        m2 = (t_voies_octets)(d2 == (uint8_t)(face)); \
+        m3 = (t_voies_octets)(d3 == (uint8_t)(face)); \
+        m4 = (t_voies_octets)(d4 == (uint8_t)(face)); \
+        m5 = (t_voies_octets)(d5 == (uint8_t)(face)); \
+        compte = -(m1 + m2 + m3 + m4 + m5); \
+        ECRIRE_VOIES((face) - 1, (m1 & (face)) + (m2 & (face)) + (m3 & (face)) + (m4 & (face)) + (m5 & (face))); \
+        paires |= (t_voies_octets)(compte == 2); \
+        triples |= (t_voies_octets)(compte == 3); \
+        carres |= (t_voies_octets)(compte == 4); \
+        yams |= (t_voies_octets)(compte == 5); \
+    } while (0)
+    // seules les égalités d'octets existent avant AVX-512 : une face présente a un compte non nul
+#define PRESENTE(compte) (~(t_voies_octets)((compte) == 0))
+
+    for (k = 0; k + TAILLE_LOT_POINTS <= nb_mains; k += TAILLE_LOT_POINTS) {
+        CHARGER_VOIES(0, d1);
+        CHARGER_VOIES(1, d2);
+        CHARGER_VOIES(2, d3);
+        CHARGER_VOIES(3, d4);
+        CHARGER_VOIES(4, d5);
+        somme = d1 + d2 + d3 + d4 + d5;
+
+        paires = triples = carres = yams = (t_voies_octets){0};
+        COMPTER_FACE(1, c1);
+        COMPTER_FACE(2, c2);
+        COMPTER_FACE(3, c3);
+        COMPTER_FACE(4, c4);
+        COMPTER_FACE(5, c5);
+        COMPTER_FACE(6, c6);
+
+        // les faces 3 et 4 sont dans toutes les suites
+        milieu = PRESENTE(c3) & PRESENTE(c4);
+        ECRIRE_VOIES(I_BRELAN, (triples | carres | yams) & somme);
+        ECRIRE_VOIES(I_CARRE, (carres | yams) & somme);
+        ECRIRE_VOIES(I_FULL_H, ((triples & paires) | yams) & 25);
+        ECRIRE_VOIES(I_P_SUITE, milieu & ((PRESENTE(c1) & PRESENTE(c2)) | (PRESENTE(c2) & PRESENTE(c5))
+            | (PRESENTE(c5) & PRESENTE(c6))) & 30);
+        ECRIRE_VOIES(I_G_SUITE, milieu & PRESENTE(c2) & PRESENTE(c5) & (PRESENTE(c1) | PRESENTE(c6)) & 40);
+        ECRIRE_VOIES(I_YAMS, yams & 50);
+        ECRIRE_VOIES(I_CHANCE, somme);
+    }
+
+#undef PRESENTE
+#undef COMPTER_FACE
+#undef CHARGER_VOIES
+#undef ECRIRE_VOIES
+
+    for (; k < nb_mains; k++) {
+        for (int i = 0; i < NB_DES; i++)
+            main_des[i] = des[(size_t)i * nb_mains + k];
+        for (int c = 0; c < TAILLE_FEUILLE; c++)
+            points[(size_t)c * nb_mains + k] = points_mains[indice_main(main_des)][c];
+    }
+}
+
+/**
+ * \fn void yams_calculer_points(const uint8_t des[], int nb_mains, uint8_t points[])
+ * \brief Calcule les points des 13 cases pour un lot de mains, comme calculer_points_lot
+ * \param des Le dé i de la main k à l'indice i * nb_mains + k, de 1 à 6
+ * \param nb_mains Le nombre de mains
+ * \param points Les points de la case c pour la main k à l'indice c * nb_mains + k
+ */
+YAMS_API void yams_calculer_points(const uint8_t des[], int nb_mains, uint8_t points[]) {
+    pthread_once(&initialisation_bibliotheque, initialiser_tables);
+    calculer_points_lot(des, nb_mains, points);
+}
+
+/**
+ * \def NB_DONNEES_BENCHMARK
+ * \brief Nombre de mains et de feuilles tirées pour les mesures, parcourues en boucle
+ */
+#define NB_DONNEES_BENCHMARK 4096
+
+/**
+ * \struct t_donnees_benchmark
+ * \brief Données tirées une fois pour toutes avant les mesures
+ */
+typedef struct {
+    t_des des[NB_DONNEES_BENCHMARK];                /**< Mains non triées */
+    t_des des_tries[NB_DONNEES_BENCHMARK];          /**< Les mêmes mains, triées */
+    t_voies_des voies[NB_DONNEES_BENCHMARK / TAILLE_LOT_TRI][NB_DES];  /**< Les mêmes mains, transposées par lots */
+    t_feuille feuilles[NB_DONNEES_BENCHMARK];       /**< Feuilles de marque à moitié remplies */
+    t_feuille_compacte compactes[NB_DONNEES_BENCHMARK]; /**< Les mêmes feuilles compactes, avec au moins une case vide */
+    t_alea alea;                                    /**< Générateur des parties mesurées */
+    t_environnement *environnement;                 /**< Environnement de NB_DONNEES_BENCHMARK parties */
+    uint8_t actions[NB_DONNEES_BENCHMARK];          /**< Les actions d'un pas de l'environnement */
+    uint8_t des_lot[NB_DES][NB_DONNEES_BENCHMARK];  /**< Les mains non triées, rangées dé par dé */
+    uint8_t points_lot[TAILLE_FEUILLE][NB_DONNEES_BENCHMARK];   /**< Les points de chaque case des mains */
+    int nb_fils;                                    /**< Nombre de fils du solveur */
+} t_donnees_benchmark;
+
+/**
+ * \var donnees_benchmark
+ * \brief Les données des mesures
+ */
+/**
+ * \var puits_benchmark
+ * \brief Reçoit les résultats des noyaux mesurés, pour que le compilateur ne les supprime pas
+ */
+t_donnees_benchmark donnees_benchmark;
+volatile long puits_benchmark;
+
+/**
+ * \fn void bm_trier_des(long iterations)
+ * \brief Trie une main non triée par itération
+ */
+void bm_trier_des(long iterations) {
+    t_des des;
+
+    for (long i = 0; i < iterations; i++) {
+        memcpy(des, donnees_benchmark.des[i % NB_DONNEES_BENCHMARK], sizeof(t_des));
+        trier_des(des);
+        puits_benchmark += des[0];
+    }
+}
+
+/**
+ * \fn void bm_trier_voies_des(long iterations)
+ * \brief Trie des mains déjà transposées, TAILLE_LOT_TRI mains par itération
+ */
+void bm_trier_voies_des(long iterations) {
+    const int NB_LOTS = NB_DONNEES_BENCHMARK / TAILLE_LOT_TRI;
+    t_voies_des lot[NB_DES];
+
+    for (long i = 0; i < iterations; i++) {
+        memcpy(lot, donnees_benchmark.voies[i % NB_LOTS], sizeof(lot));
+        trier_voies_des(lot);
+        puits_benchmark += lot[0][0];
+    }
+}
+
+/**
+ * \fn void bm_suite_identique(long iterations)
+ * \brief Recherche un brelan dans une main triée par itération
+ */
+void bm_suite_identique(long iterations) {
+    for (long i = 0; i < iterations; i++)
+        puits_benchmark += suite_identique(donnees_benchmark.des_tries[i % NB_DONNEES_BENCHMARK], 3);
+}
+
+/**
+ * \fn void bm_dedoublonner(long iterations)
+ * \brief Dédoublonne une main triée par itération
+ */
+void bm_dedoublonner(long iterations) {
+    t_des uniques;
+
+    for (long i = 0; i < iterations; i++) {
+        dedoublonner(donnees_benchmark.des_tries[i % NB_DONNEES_BENCHMARK], uniques);
+        puits_benchmark += uniques[1];
+    }
+}
+
+/**
+ * \fn void bm_petite_suite(long iterations)
+ * \brief Recherche une petite suite dans une main triée par itération
+ */
+void bm_petite_suite(long iterations) {
+    for (long i = 0; i < iterations; i++)
+        puits_benchmark += petite_suite(donnees_benchmark.des_tries[i % NB_DONNEES_BENCHMARK]);
+}
+
+/**
+ * \fn void bm_rechercher_combinaisons(long iterations)
+ * \brief Calcule les points de toutes les cases libres d'une feuille pour une main par itération
+ */
+void bm_rechercher_combinaisons(long iterations) {
+    t_feuille combi_possibles;
+
+    for (long i = 0; i < iterations; i++) {
+        int n = i % NB_DONNEES_BENCHMARK;
+        rechercher_combinaisons(donnees_benchmark.feuilles[n], donnees_benchmark.des_tries[n], combi_possibles);
+        puits_benchmark += combi_possibles[I_CHANCE];
+    }
+}
+
+/**
+ * \fn void bm_calculer_points_lot(long iterations)
+ * \brief Calcule les points des 13 cases d'une main par itération, par lots de NB_DONNEES_BENCHMARK mains
+ */
+void bm_calculer_points_lot(long iterations) {
+    int lot;
+
+    for (long fait = 0; fait < iterations; fait += lot) {
+        lot = iterations - fait < NB_DONNEES_BENCHMARK ? iterations - fait : NB_DONNEES_BENCHMARK;
+        calculer_points_lot(&donnees_benchmark.des_lot[0][0], lot, &donnees_benchmark.points_lot[0][0]);
+        puits_benchmark += donnees_benchmark.points_lot[I_CHANCE][0];
+    }
+}
+
+/**
+ * \fn void bm_calculer_totaux(long iterations)
+ * \brief Calcule les totaux d'une feuille par itération
+ */
+void bm_calculer_totaux(long iterations) {
+    int total_sup, total_inf, total, bonus;
+
+    for (long i = 0; i < iterations; i++) {
+        calculer_totaux(donnees_benchmark.feuilles[i % NB_DONNEES_BENCHMARK], &total_sup, &total_inf, &total, &bonus);
+        puits_benchmark += total;
+    }
+}
+
+/**
+ * \fn void mesurer_decisions(const char nom_strategie[], long iterations)
+ * \brief Fait prendre à une stratégie une garde et une case par itération, sur les mains et feuilles tirées
+ * \param nom_strategie Le nom de la stratégie
+ * \param iterations Le nombre d'itérations
+ */
+void mesurer_decisions(const char nom_strategie[], long iterations) {
+    const t_strategie *strategie = rechercher_strategie(nom_strategie);
+    const t_feuille_compacte *feuille;
+    const int *des;
+
+    for (long i = 0; i < iterations; i++) {
+        feuille = &donnees_benchmark.compactes[i % NB_DONNEES_BENCHMARK];
+        des = donnees_benchmark.des[i % NB_DONNEES_BENCHMARK];
+        puits_benchmark += strategie->choisir_garde(strategie, feuille, NULL, des, 1 + i % 2, &donnees_benchmark.alea);
+        puits_benchmark += strategie->choisir_case(strategie, feuille, NULL, des, &donnees_benchmark.alea);
+    }
+}
+
+/**
+ * \fn void bm_decision_greedy(long iterations)
+ * \brief Décisions de la stratégie greedy
+ */
+void bm_decision_greedy(long iterations) {
+    mesurer_decisions("greedy", iterations);
+}
+
+/**
+ * \fn void bm_decision_bonus(long iterations)
+ * \brief Décisions de la stratégie bonus
+ */
+void bm_decision_bonus(long iterations) {
+    mesurer_decisions("bonus", iterations);
+}
+
+/**
+ * \fn void bm_decision_straight(long iterations)
+ * \brief Décisions de la stratégie straight
+ */
+void bm_decision_straight(long iterations) {
+    mesurer_decisions("straight", iterations);
+}
+
+/**
+ * \fn void bm_decision_optimal(long iterations)
+ * \brief Décisions de la stratégie optimale, dont la table est préparée par mode_benchmark
+ *
+ * La feuille change à chaque itération : chaque garde prépare l'évaluation
+ * d'un nouveau tour, ce que la stratégie ne fait qu'une fois par tour en partie.
+ */
+void bm_decision_optimal(long iterations) {
+    mesurer_decisions("optimal", iterations);
+}
+
+/**
+ * \fn void bm_partie_greedy(long iterations)
+ * \brief Joue une partie complète à deux joueurs greedy, sans affichage, par itération
+ */
+void bm_partie_greedy(long iterations) {
+    const t_strategie *strategies[NB_JOUEURS];
+    int totaux[NB_JOUEURS];
+
+    strategies[0] = rechercher_strategie("greedy");
+    strategies[1] = strategies[0];
+    for (long i = 0; i < iterations; i++) {
+        jouer_partie_auto(strategies, NB_JOUEURS, &donnees_benchmark.alea, totaux, NULL);
+        puits_benchmark += totaux[0];
+    }
+}
+
+/**
+ * \fn void bm_environnement(long iterations)
+ * \brief Avance d'un pas une partie de l'environnement par itération, par lots de NB_DONNEES_BENCHMARK parties
+ *
+ * Chaque partie relance tant qu'elle le peut, avec une garde qui change
+ * d'une partie à l'autre, puis remplit sa première case vide.
+ */
+void bm_environnement(long iterations) {
+    t_environnement *environnement = donnees_benchmark.environnement;
+    uint8_t *actions = donnees_benchmark.actions;
+    int lot;
+
+    for (long fait = 0; fait < iterations; fait += lot) {
+        lot = iterations - fait < NB_DONNEES_BENCHMARK ? iterations - fait : NB_DONNEES_BENCHMARK;
+        for (int k = 0; k < lot; k++) {
+            actions[k] = environnement->lancers_restants[k] > 0 ? k % GARDER_TOUT
+                : ACTION_CASE + __builtin_ctzll(environnement->masques_actions[k] >> ACTION_CASE);
+        }
+        puits_benchmark += yams_avancer_plage(environnement, actions, 0, lot);
+    }
+}
+
+/**
+ * \fn void bm_solveur(long iterations)
+ * \brief Résout la stratégie optimale complète par itération
+ */
+void bm_solveur(long iterations) {
+    float *esperances;
+
+    for (long i = 0; i < iterations; i++) {
+        esperances = calculer_table_optimale(donnees_benchmark.nb_fils);
+        if (esperances != NULL)
+            puits_benchmark += esperances[0];
+        free(esperances);
+    }
+}
+
+/**
+ * \struct t_benchmark
+ * \brief Noyau mesuré : une fonction qui répète un nombre donné d'itérations
+ */
+typedef struct {
+    const char *nom;                    /**< Nom du noyau, repris dans le rapport */
+    void (*executer)(long iterations);  /**< Exécute les itérations */
+} t_benchmark;
+
+/**
+ * \var BENCHMARKS
+ * \brief Les noyaux mesurés, des plus petits aux plus longs
+ */
+const t_benchmark BENCHMARKS[] = {
+    {"BM_trier_des", bm_trier_des},
+    {"BM_trier_voies_des", bm_trier_voies_des},
+    {"BM_suite_identique", bm_suite_identique},
+    {"BM_dedoublonner", bm_dedoublonner},
+    {"BM_petite_suite", bm_petite_suite},
+    {"BM_rechercher_combinaisons", bm_rechercher_combinaisons},
+    {"BM_calculer_points_lot", bm_calculer_points_lot},
+    {"BM_calculer_totaux", bm_calculer_totaux},
+    {"BM_decision_greedy", bm_decision_greedy},
+    {"BM_decision_bonus", bm_decision_bonus},
+    {"BM_decision_straight", bm_decision_straight},
+    {"BM_partie_greedy", bm_partie_greedy},
+    {"BM_environnement", bm_environnement},
+    {"BM_decision_optimal", bm_decision_optimal},
+    {"BM_solveur", bm_solveur},
+};
+
+/**
+ * \fn double horloge_cpu()
+ * \brief Donne le temps processeur consommé par le processus, tous fils compris
+ * \return Le temps en secondes
+ */
+double horloge_cpu() {
+    struct timespec instant;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &instant);
+    return instant.tv_sec + instant.tv_nsec * 1e-9;
+}
+
+/**
+ * \fn void preparer_donnees_benchmark(uint64_t graine, int nb_fils)
+ * \brief Tire les mains et les feuilles utilisées par les mesures
+ * \param graine La graine du générateur
+ * \param nb_fils Le nombre de fils du solveur
+ */
+void preparer_donnees_benchmark(uint64_t graine, int nb_fils) {
+    t_donnees_benchmark *d = &donnees_benchmark;
+
+    initialiser_alea(&d->alea, graine);
+    d->nb_fils = nb_fils;
+    if (d->environnement == NULL)
+        d->environnement = yams_creer_environnement(NB_DONNEES_BENCHMARK, 1, graine);
+    for (int n = 0; n < NB_DONNEES_BENCHMARK; n++) {
+        for (int i = 0; i < NB_DES; i++)
+            d->des[n][i] = lancer_de(&d->alea);
+        memcpy(d->des_tries[n], d->des[n], sizeof(t_des));
+        trier_des(d->des_tries[n]);
+        for (int i = 0; i < NB_DES; i++) {
+            d->voies[n / TAILLE_LOT_TRI][i][n % TAILLE_LOT_TRI] = d->des[n][i];
+            d->des_lot[i][n] = d->des[n][i];
+        }
+
+        // une case sur deux est remplie avec les points d'une main tirée
+        for (int i = 0; i < TAILLE_FEUILLE; i++) {
+            d->feuilles[n][i] = CASE_VIDE;
+            if (alea_borne(&d->alea, 2) == 0)
+                d->feuilles[n][i] = points_mains[alea_borne(&d->alea, NB_MAINS)][i];
+        }
+
+        // les stratégies ne décident que tant qu'il reste une case à remplir
+        compacter_feuille(d->feuilles[n], &d->compactes[n]);
+        if (d->compactes[n].remplies == FEUILLE_REMPLIE) {
+            d->feuilles[n][I_CHANCE] = CASE_VIDE;
+            compacter_feuille(d->feuilles[n], &d->compactes[n]);
+        }
+    }
+}
+
+/**
+ * \fn void ecrire_chaine_json(FILE *flux, const char texte[])
+ * \brief Ecrit une chaine entre guillemets en échappant les caractères spéciaux du JSON
+ * \param flux Le fichier
+ * \param texte La chaine
+ */
+void ecrire_chaine_json(FILE *flux, const char texte[]) {
+    fputc('"', flux);
+    for (int i = 0; texte[i] != '\0'; i++) {
+        if (texte[i] == '"' || texte[i] == '\\')
+            fputc('\\', flux);
+        if ((unsigned char)texte[i] >= ' ')
+            fputc(texte[i], flux);
+    }
+    fputc('"', flux);
+}
+
+/**
+ * \fn bool mode_benchmark(const t_options *options, const char programme[])
+ * \brief Mesure les noyaux du jeu et écrit les résultats, au format JSON de Google Benchmark si demandé
+ *
+ * Comme Google Benchmark, chaque noyau est répété avec un nombre croissant
+ * d'itérations jusqu'à durer au moins la durée minimale ; le temps rapporté
+ * est le temps par itération.
+ * \param options Les options de la ligne de commande
+ * \param programme Le nom du programme, repris dans le contexte du rapport
+ * \return Vrai si le rapport est écrit, faux sinon
+ */
+bool mode_benchmark(const t_options *options, const char programme[]) {
+    const int NB_BENCHMARKS = sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]);
+    const long ITERATIONS_MAX = 1000000000;
+    const t_strategie *optimale = rechercher_strategie("optimal");
+    t_table_optimale table;
+    char date[64], hote[256];
+    double debut, debut_cpu, duree, duree_cpu;
+    long iterations;
+    bool premier;
+    FILE *json = NULL;
+    time_t maintenant;
+
+    if (options->fichier_sortie != NULL) {
+        json = fopen(options->fichier_sortie, "w");
+        if (json == NULL) {
+            fprintf(stderr, "Impossible de créer %s\n", options->fichier_sortie);
+            return false;
+        }
+    }
+
+    // les mesures ne portent que sur un environnement qui accepte toutes ses actions
+    if (!verifier_environnement(options->graine)) {
+        if (json != NULL)
+            fclose(json);
+        return false;
+    }
+    preparer_donnees_benchmark(options->graine, options->nb_fils);
+
+    // la table n'est calculée ou projetée que si les décisions optimales sont mesurées
+    table.projection = NULL;
+    if ((options->filtre == NULL || strstr("BM_decision_optimal", options->filtre) != NULL)
+            && !preparer_strategie_optimale(options, &optimale, 1, &table)) {
+        if (json != NULL)
+            fclose(json);
+        return false;
+    }
+
+    maintenant = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&maintenant));
+    if (gethostname(hote, sizeof(hote)) != 0)
+        strcpy(hote, "");
+
+    if (json != NULL) {
+        fprintf(json, "{\n  \"context\": {\n    \"date\": ");
+        ecrire_chaine_json(json, date);
+        fprintf(json, ",\n    \"host_name\": ");
+        ecrire_chaine_json(json, hote);
+        fprintf(json, ",\n    \"executable\": ");
+        ecrire_chaine_json(json, programme);
+        fprintf(json, ",\n    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+        fprintf(json, "    \"threads\": %d,\n", options->nb_fils);
+        fprintf(json, "    \"seed\": %llu,\n", (unsigned long long)options->graine);
+        fprintf(json, "    \"min_time\": %g\n  },\n  \"benchmarks\": [", options->duree_min);
+    }
+
+    printf("%-30s %15s %15s %12s\n", "Benchmark", "Temps (ns)", "CPU (ns)", "Itérations");
+    premier = true;
+    for (int b = 0; b < NB_BENCHMARKS; b++) {
+        if (options->filtre != NULL && strstr(BENCHMARKS[b].nom, options->filtre) == NULL)
+            continue;
+
+        // on augmente les itérations jusqu'à atteindre la durée minimale
+        iterations = 1;
+        while (true) {
+            debut = horloge();
+            debut_cpu = horloge_cpu();
+            BENCHMARKS[b].executer(iterations);
+            duree = horloge() - debut;
+            duree_cpu = horloge_cpu() - debut_cpu;
+
+            if (duree >= options->duree_min || iterations >= ITERATIONS_MAX)
+                break;
+
+            // on vise un peu plus que la durée minimale, sans multiplier par plus de 10
+            if (duree * 10 <= options->duree_min)
+                iterations *= 10;
+            else
+                iterations = iterations * options->duree_min * 1.4 / duree + 1;
+        }
+
+        printf("%-30s %15.1f %15.1f %12ld\n", BENCHMARKS[b].nom,
+            duree * 1e9 / iterations, duree_cpu * 1e9 / iterations, iterations);
+
+        if (json != NULL) {
+            fprintf(json, "%s\n    {\n      \"name\": ", premier ? "" : ",");
+            ecrire_chaine_json(json, BENCHMARKS[b].nom);
+            fprintf(json, ",\n      \"family_index\": %d,\n", b);
+            fprintf(json, "      \"per_family_instance_index\": 0,\n      \"run_name\": ");
+            ecrire_chaine_json(json, BENCHMARKS[b].nom);
+            fprintf(json, ",\n      \"run_type\": \"iteration\",\n");
+            fprintf(json, "      \"repetitions\": 1,\n      \"repetition_index\": 0,\n      \"threads\": 1,\n");
+            fprintf(json, "      \"iterations\": %ld,\n", iterations);
+            fprintf(json, "      \"real_time\": %.6e,\n", duree * 1e9 / iterations);
+            fprintf(json, "      \"cpu_time\": %.6e,\n", duree_cpu * 1e9 / iterations);
+            fprintf(json, "      \"time_unit\": \"ns\",\n");
+            fprintf(json, "      \"items_per_second\": %.6e\n    }", iterations / duree);
+        }
+        premier = false;
+    }
+
+    if (json != NULL) {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+    }
+    liberer_strategie_optimale(&table);
+
+    return true;
+}
+
+/**
+ * \fn bool ouvrir_instantanes(const char fichier[], double periode)
+ * \brief Démarre l'écriture des compteurs de l'instrumentation dans un fichier
+ *
+ * Le fichier est réécrit à chaque période, à chaque SIGUSR1 et à la fin du
+ * programme.
+ * \param fichier Le fichier JSON des compteurs
+ * \param periode La période d'écriture en secondes, 0 pour n'écrire qu'à la demande
+ * \return Vrai si l'écriture est prête, faux sinon
+ */
+/**
+ * \fn void fermer_instantanes()
+ * \brief Ecrit les derniers compteurs et arrête leur écriture, s'il y en a une
+ */
+#ifdef YAMS_INSTRUMENTATION
+/**
+ * \struct t_instantanes
+ * \brief Fil qui écrit les compteurs de tous les fils à intervalles réguliers ou sur SIGUSR1
+ */
+typedef struct {
+    const char *fichier;    /**< Fichier JSON des compteurs */
+    double periode;         /**< Période d'écriture en secondes, 0 pour n'écrire qu'à la demande */
+    pthread_t fil;          /**< Le fil qui attend les périodes et les signaux */
+    bool arret;             /**< Vrai quand le programme se termine */
+    double depart;          /**< Horloge au démarrage */
+    uint64_t tops_depart;   /**< Tops au démarrage, pour convertir les tops en secondes */
+} t_instantanes;
+
+/**
+ * \var instantanes
+ * \brief L'écriture des compteurs, NULL si elle n'est pas demandée
+ */
+t_instantanes *instantanes = NULL;
+
+/**
+ * \fn bool ecrire_instantane(const t_instantanes *ecriture)
+ * \brief Fusionne les compteurs de tous les fils et remplace le fichier par leur somme
+ *
+ * Le fichier est écrit à côté puis renommé : un lecteur ne voit jamais
+ * d'instantané à moitié écrit.
+ * \param ecriture L'écriture des compteurs
+ * \return Vrai si le fichier est écrit, faux sinon
+ */
+bool ecrire_instantane(const t_instantanes *ecriture) {
+    const char *NOMS_PHASES[NB_PHASES] = {"lancer", "combinaisons", "totaux", "affichage"};
+    char temporaire[PATH_MAX];
+    t_compteurs total;
+    combi nom_combinaison;
+    double duree;
+    uint64_t nb_tours = 0;
+    FILE *flux;
+
+    snprintf(temporaire, sizeof(temporaire), "%s.tmp", ecriture->fichier);
+    flux = fopen(temporaire, "w");
+    if (flux == NULL) {
+        fprintf(stderr, "Impossible d'écrire les compteurs dans %s\n", temporaire);
+        return false;
+    }
+
+    fusionner_compteurs(&total);
+    duree = horloge() - ecriture->depart;
+    for (int l = 0; l < NB_LANCERS; l++)
+        nb_tours += total.lancers_tour[l];
+
+    fprintf(flux, "{\n  \"duree\": %.3f,\n", duree);
+    fprintf(flux, "  \"tops_par_seconde\": %.0f,\n", duree > 0 ? (lire_tops() - ecriture->tops_depart) / duree : 0);
+    fprintf(flux, "  \"phases\": [\n");
+    for (int p = 0; p < NB_PHASES; p++) {
+        fprintf(flux, "    {\"nom\": \"%s\", \"appels\": %llu, \"tops\": %llu, \"tops_par_appel\": %.1f}%s\n",
+            NOMS_PHASES[p], (unsigned long long)total.appels[p], (unsigned long long)total.tops[p],
+            total.appels[p] > 0 ? (double)total.tops[p] / total.appels[p] : 0, p + 1 < NB_PHASES ? "," : "");
+    }
+    fprintf(flux, "  ],\n  \"cases\": [\n");
+    for (int i = 0; i < TAILLE_FEUILLE; i++) {
+        indice_vers_combi(i, nom_combinaison);
+        fprintf(flux, "    {\"nom\": ");
+        ecrire_chaine_json(flux, nom_combinaison);
+        fprintf(flux, ", \"remplies\": %llu, \"marquees\": %llu, \"taux_marquees\": %.4f}%s\n",
+            (unsigned long long)total.remplies[i], (unsigned long long)total.marquees[i],
+            total.remplies[i] > 0 ? (double)total.marquees[i] / total.remplies[i] : 0,
+            i + 1 < TAILLE_FEUILLE ? "," : "");
+    }
+    fprintf(flux, "  ],\n  \"tours\": %llu,\n  \"lancers_par_tour\": [", (unsigned long long)nb_tours);
+    for (int l = 0; l < NB_LANCERS; l++)
+        fprintf(flux, "%s%llu", l > 0 ? ", " : "", (unsigned long long)total.lancers_tour[l]);
+    fprintf(flux, "]\n}\n");
+
+    if (fclose(flux) != 0 || rename(temporaire, ecriture->fichier) != 0) {
+        fprintf(stderr, "Impossible d'écrire les compteurs dans %s\n", ecriture->fichier);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \fn void *executer_instantanes(void *argument)
+ * \brief Point d'entrée du fil d'écriture : attend la période ou SIGUSR1, puis écrit les compteurs
+ *
+ * SIGUSR1 est bloqué dans tous les fils et lu ici par sigtimedwait : le
+ * fichier est écrit hors de tout gestionnaire de signal.
+ * \param argument L'écriture des compteurs (t_instantanes)
+ * \return NULL
+ */
+void *executer_instantanes(void *argument) {
+    t_instantanes *ecriture = argument;
+    struct timespec attente;
+    sigset_t signaux;
+
+    sigemptyset(&signaux);
+    sigaddset(&signaux, SIGUSR1);
+    attente.tv_sec = (time_t)ecriture->periode;
+    attente.tv_nsec = (long)((ecriture->periode - attente.tv_sec) * 1e9);
+
+    do {
+        if (ecriture->periode > 0)
+            sigtimedwait(&signaux, NULL, &attente);
+        else
+            sigwaitinfo(&signaux, NULL);
+        ecrire_instantane(ecriture);
+    } while (!__atomic_load_n(&ecriture->arret, __ATOMIC_ACQUIRE));
+
+    return NULL;
+}
+
+bool ouvrir_instantanes(const char fichier[], double periode) {
+    t_instantanes *ecriture = calloc(1, sizeof(t_instantanes));
+    sigset_t signaux;
+
+    ecriture->fichier = fichier;
+    ecriture->periode = periode;
+    ecriture->depart = horloge();
+    ecriture->tops_depart = lire_tops();
+
+    // les fils créés ensuite héritent du masque : seul le fil d'écriture lit SIGUSR1
+    sigemptyset(&signaux);
+    sigaddset(&signaux, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signaux, NULL);
+
+    if (!ecrire_instantane(ecriture)) {
+        free(ecriture);
+        return false;
+    }
+    if (pthread_create(&ecriture->fil, NULL, executer_instantanes, ecriture) != 0) {
+        fprintf(stderr, "Impossible de lancer le fil d'écriture des compteurs\n");
+        pthread_sigmask(SIG_UNBLOCK, &signaux, NULL);
+        free(ecriture);
+        return false;
+    }
+
+    instantanes = ecriture;
+    return true;
+}
+
+void fermer_instantanes() {
+    if (instantanes == NULL)
+        return;
+
+    // le fil réveillé écrit une dernière fois avant de voir l'arrêt
+    __atomic_store_n(&instantanes->arret, true, __ATOMIC_RELEASE);
+    pthread_kill(instantanes->fil, SIGUSR1);
+    pthread_join(instantanes->fil, NULL);
+    free(instantanes);
+    instantanes = NULL;
+}
+#else
+bool ouvrir_instantanes(const char fichier[], double periode) {
+    fprintf(stderr, "Compteurs indisponibles : le programme est compilé sans -DYAMS_INSTRUMENTATION\n");
+    return false;
+}
+
+void fermer_instantanes() {
+}
+#endif
+
+/**
+ * \def TAILLE_LIGNE_PROTOCOLE
+ * \brief Longueur maximale d'une ligne du protocole, retour à la ligne compris
+ */
+/**
+ * \def TAILLE_ENVOI_SESSION
+ * \brief Taille du tampon des réponses en attente d'envoi d'une session
+ */
+/**
+ * \def NB_EVENEMENTS_EPOLL
+ * \brief Nombre d'évènements lus par appel à epoll_wait
+ */
+/**
+ * \def ECOUTE_EPOLL
+ * \brief Marque de la socket d'écoute parmi les évènements epoll, les sessions ayant leur indice
+ */
+#define TAILLE_LIGNE_PROTOCOLE 128
+#define TAILLE_ENVOI_SESSION 1024
+#define NB_EVENEMENTS_EPOLL 256
+#define ECOUTE_EPOLL UINT32_MAX
+
+/**
+ * \var arret_demande
+ * \brief Passe à 1 quand le serveur reçoit SIGINT ou SIGTERM
+ */
+volatile sig_atomic_t arret_demande = 0;
+
+/**
+ * \fn void demander_arret(int signal)
+ * \brief Gestionnaire de SIGINT et SIGTERM : la boucle d'évènements s'arrête au prochain réveil
+ * \param signal Le signal reçu
+ */
+void demander_arret(int signal) {
+    arret_demande = 1;
+}
+
+/**
+ * \fn bool lire_adresse(const char texte[], struct sockaddr_storage *adresse, socklen_t *taille)
+ * \brief Lit une adresse de socket : un chemin (avec un /) pour une socket Unix, sinon [hote:]port en TCP
+ *
+ * Sans hôte, l'adresse TCP est celle de la boucle locale, 127.0.0.1.
+ * \param texte L'adresse, par exemple /tmp/yams.sock ou 7777
+ * \param adresse L'adresse lue
+ * \param taille La taille de l'adresse lue
+ * \return Vrai si l'adresse est correcte, faux sinon
+ */
+bool lire_adresse(const char texte[], struct sockaddr_storage *adresse, socklen_t *taille) {
+    struct sockaddr_un *unix_ = (struct sockaddr_un *)adresse;
+    struct sockaddr_in *ipv4 = (struct sockaddr_in *)adresse;
+    char hote[64] = "127.0.0.1";
+    const char *deux_points;
+    char *fin;
+    long port;
+
+    memset(adresse, 0, sizeof(*adresse));
+
+    if (strchr(texte, '/') != NULL) {
+        if (strlen(texte) >= sizeof(unix_->sun_path))
+            return false;
+        unix_->sun_family = AF_UNIX;
+        strcpy(unix_->sun_path, texte);
+        *taille = sizeof(*unix_);
+        return true;
+    }
+
+    deux_points = strrchr(texte, ':');
+    if (deux_points != NULL) {
+        if (deux_points - texte >= (long)sizeof(hote))
+            return false;
+        memcpy(hote, texte, deux_points - texte);
+        hote[deux_points - texte] = '\0';
+        texte = deux_points + 1;
+    }
+
+    port = strtol(texte, &fin, 10);
+    if (*fin != '\0' || port <= 0 || port > 65535)
+        return false;
+
+    ipv4->sin_family = AF_INET;
+    ipv4->sin_port = htons(port);
+    *taille = sizeof(*ipv4);
+    return inet_pton(AF_INET, hote, &ipv4->sin_addr) == 1;
+}
+
+/**
+ * \struct t_session
+ * \brief Emplacement préalloué d'une connexion au serveur et de sa partie
+ */
+typedef struct {
+    int fd;                                 /**< Socket du client, -1 si l'emplacement est libre */
+    bool en_partie;                         /**< Une partie a été commencée par join */
+    bool attente_envoi;                     /**< epoll surveille aussi la possibilité d'écrire */
+    bool fermer_apres_envoi;                /**< La session se ferme une fois les réponses envoyées */
+    t_machine_partie machine;               /**< La partie en cours */
+    uint64_t mots_partie[1 + NB_JOUEURS * TAILLE_FEUILLE]; /**< Mots de la partie pour le journal */
+    int longueur_lue;                       /**< Octets reçus et pas encore traités */
+    int debut_envoi;                        /**< Premier octet à envoyer */
+    int fin_envoi;                          /**< Fin des octets à envoyer */
+    char lue[TAILLE_LIGNE_PROTOCOLE];       /**< Ligne en cours de réception */
+    char envoi[TAILLE_ENVOI_SESSION];       /**< Réponses en attente d'envoi */
+} t_session;
+
+/**
+ * \struct t_serveur
+ * \brief Boucle d'évènements du serveur et ses sessions
+ */
+typedef struct {
+    int epoll;                  /**< Descripteur epoll */
+    int ecoute;                 /**< Socket d'écoute */
+    t_session *sessions;        /**< Emplacements de session, alloués au démarrage */
+    int *libres;                /**< Pile des indices des emplacements libres */
+    int nb_sessions;            /**< Nombre d'emplacements */
+    int nb_libres;              /**< Nombre d'emplacements libres */
+    t_alea alea;                /**< Graines des parties commencées sans graine */
+    long nb_connexions;         /**< Connexions acceptées depuis le démarrage */
+    long nb_commandes;          /**< Lignes traitées depuis le démarrage */
+    t_journal *journal;         /**< Journal des parties terminées, NULL sans journal */
+} t_serveur;
+
+/**
+ * \fn void repondre_session(t_session *session, const char format[], ...)
+ * \brief Ajoute une ligne de réponse au tampon d'envoi d'une session
+ *
+ * Un client qui ne lit pas ses réponses finit par remplir le tampon : sa
+ * session est alors fermée plutôt que de grossir sans limite.
+ * \param session La session
+ * \param format Le format de la ligne, comme pour printf, sans le retour à la ligne
+ */
+void repondre_session(t_session *session, const char format[], ...) {
+    va_list arguments;
+    int longueur;
+
+    // on ramène les octets pas encore envoyés au début du tampon
+    if (session->debut_envoi > 0) {
+        memmove(session->envoi, session->envoi + session->debut_envoi, session->fin_envoi - session->debut_envoi);
+        session->fin_envoi -= session->debut_envoi;
+        session->debut_envoi = 0;
+    }
+
+    va_start(arguments, format);
+    longueur = vsnprintf(session->envoi + session->fin_envoi, TAILLE_ENVOI_SESSION - session->fin_envoi, format, arguments);
+    va_end(arguments);
+
+    if (session->fin_envoi + longueur + 1 >= TAILLE_ENVOI_SESSION) {
+        session->fermer_apres_envoi = true;
+        return;
+    }
+
+    session->fin_envoi += longueur;
+    session->envoi[session->fin_envoi++] = '\n';
+}
+
+/**
+ * \fn void repondre_des(t_session *session)
+ * \brief Répond par les dés du lancer en cours et les cases libres du joueur : dice joueur lancer d1 d2 d3 d4 d5 libres
+ *
+ * Les cases libres forment un masque, bit i à 1 si la case i peut être
+ * remplie : un programme n'a pas à tenir la feuille pour choisir.
+ * \param session La session
+ */
+void repondre_des(t_session *session) {
+    const t_machine_partie *machine = &session->machine;
+    int libres = 0;
+
+    for (int i = 0; i < TAILLE_FEUILLE; i++)
+        libres |= case_libre_table(&machine->table, machine->joueur, i) << i;
+
+    repondre_session(session, "dice %d %d %d %d %d %d %d %d", machine->joueur + 1, machine->lancer,
+        machine->des[0], machine->des[1], machine->des[2], machine->des[3], machine->des[4], libres);
+}
+
+/**
+ * \fn int lire_commande(const char ligne[], char commande[16], unsigned long long *argument)
+ * \brief Découpe une ligne du protocole en un mot de commande et au plus un argument numérique
+ *
+ * La ligne doit être entièrement lue : un argument qui n'est pas un entier
+ * décimal positif, ou un mot de plus, la rend invalide.
+ * \param ligne La ligne, sans le retour à la ligne
+ * \param commande Le mot de commande, de 15 caractères au plus
+ * \param argument L'argument, s'il y en a un
+ * \return 2 avec un argument, 1 sans argument, 0 si la ligne est invalide
+ */
+int lire_commande(const char ligne[], char commande[16], unsigned long long *argument) {
+    const char *suite;
+    char *fin;
+    int lus;
+
+    if (sscanf(ligne, " %15s%n", commande, &lus) != 1)
+        return 0;
+
+    suite = ligne + lus;
+    while (isspace((unsigned char)*suite))
+        suite++;
+    if (*suite == '\0')
+        return 1;
+    if (!isdigit((unsigned char)*suite))
+        return 0;
+
+    errno = 0;
+    *argument = strtoull(suite, &fin, 10);
+    while (isspace((unsigned char)*fin))
+        fin++;
+
+    return errno == 0 && *fin == '\0' ? 2 : 0;
+}
+
+/**
+ * \fn void traiter_commande(t_serveur *serveur, t_session *session, char ligne[])
+ * \brief Exécute une ligne du protocole et prépare sa réponse
+ *
+ * Commandes : join [graine], roll, keep masque (bit i à 1 pour garder le dé
+ * i + 1), score case (0 à 12, dans l'ordre de la feuille de marque) et quit.
+ * Une commande refusée reçoit err suivi de la raison, err syntax si la ligne
+ * n'est pas une commande connue avec exactement ses arguments.
+ * \param serveur Le serveur
+ * \param session La session qui a envoyé la ligne
+ * \param ligne La ligne, sans le retour à la ligne
+ */
+void traiter_commande(t_serveur *serveur, t_session *session, char ligne[]) {
+    t_machine_partie *machine = &session->machine;
+    char commande[16];
+    unsigned long long graine = 0;
+    int nb_lus, valeur, joueur, points, tour;
+    int totaux[MAX_JOUEURS];
+
+    serveur->nb_commandes++;
+    nb_lus = lire_commande(ligne, commande, &graine);
+    valeur = (int)graine;
+
+    if (nb_lus < 1) {
+        repondre_session(session, "err syntax");
+    }
+    else if (strcmp(commande, "join") == 0 && nb_lus <= 2) {
+        if (nb_lus == 1)
+            graine = alea_suivant(&serveur->alea);
+        initialiser_machine(machine, graine, NB_JOUEURS, NULL);
+        session->mots_partie[0] = mot_partie(NB_JOUEURS);
+        session->en_partie = true;
+        repondre_session(session, "ok");
+    }
+    else if (strcmp(commande, "quit") == 0 && nb_lus == 1) {
+        repondre_session(session, "bye");
+        session->fermer_apres_envoi = true;
+    }
+    else if (strcmp(commande, "roll") == 0 && nb_lus == 1) {
+        if (!session->en_partie || machine->etat != ATTENTE_LANCER) {
+            repondre_session(session, "err state");
+        }
+        else {
+            lancer_des_machine(machine);
+            repondre_des(session);
+        }
+    }
+    else if (strcmp(commande, "keep") == 0 && nb_lus == 2) {
+        if (!session->en_partie || machine->etat != ATTENTE_RELANCE) {
+            repondre_session(session, "err state");
+        }
+        else if (graine > GARDER_TOUT) {
+            repondre_session(session, "err mask");
+        }
+        else {
+            machine->a_relancer = ~valeur & GARDER_TOUT;
+            lancer_des_machine(machine);
+            repondre_des(session);
+        }
+    }
+    else if (strcmp(commande, "score") == 0 && nb_lus == 2) {
+        if (!session->en_partie || (machine->etat != ATTENTE_RELANCE && machine->etat != ATTENTE_CASE)) {
+            repondre_session(session, "err state");
+        }
+        else if (graine >= TAILLE_FEUILLE || !case_libre_table(&machine->table, machine->joueur, valeur)) {
+            repondre_session(session, "err category");
+        }
+        else {
+            joueur = machine->joueur;
+            tour = 1 + machine->tour * NB_JOUEURS + joueur;
+            points = remplir_case_machine(machine, valeur);
+            session->mots_partie[tour] = machine->mot_tour;
+            totaux_table(&machine->table, totaux);
+            repondre_session(session, "scored %d %d %d %d", joueur + 1, valeur, points, totaux[joueur]);
+
+            // seules les parties terminées entrent dans le journal
+            if (machine->etat == PARTIE_TERMINEE) {
+                repondre_session(session, "end %d %d", totaux[0], totaux[1]);
+                session->en_partie = false;
+                if (serveur->journal != NULL)
+                    journaliser_partie(serveur->journal, session->mots_partie, tour + 1);
+            }
+        }
+    }
+    else {
+        repondre_session(session, "err syntax");
+    }
+}
+
+/**
+ * \fn void surveiller_session(t_serveur *serveur, int indice)
+ * \brief Demande à epoll de signaler aussi la possibilité d'écrire, tant que des réponses attendent
+ * \param serveur Le serveur
+ * \param indice L'indice de la session
+ */
+void surveiller_session(t_serveur *serveur, int indice) {
+    t_session *session = &serveur->sessions[indice];
+    bool attente = session->fin_envoi > session->debut_envoi;
+    struct epoll_event evenement;
+
+    if (attente == session->attente_envoi)
+        return;
+
+    evenement.events = EPOLLIN | (attente ? EPOLLOUT : 0);
+    evenement.data.u32 = indice;
+    epoll_ctl(serveur->epoll, EPOLL_CTL_MOD, session->fd, &evenement);
+    session->attente_envoi = attente;
+}
+
+/**
+ * \fn void fermer_session(t_serveur *serveur, int indice)
+ * \brief Ferme la connexion d'une session et rend son emplacement
+ * \param serveur Le serveur
+ * \param indice L'indice de la session
+ */
+void fermer_session(t_serveur *serveur, int indice) {
+    t_session *session = &serveur->sessions[indice];
+
+    // fermer la socket la retire aussi d'epoll
+    close(session->fd);
+    session->fd = -1;
+    serveur->libres[serveur->nb_libres++] = indice;
+}
+
+/**
+ * \fn bool envoyer_session(t_session *session)
+ * \brief Envoie ce que la socket accepte des réponses en attente
+ * \param session La session
+ * \return Faux si la connexion est perdue, vrai sinon
+ */
+bool envoyer_session(t_session *session) {
+    ssize_t envoyes;
+
+    while (session->debut_envoi < session->fin_envoi) {
+        envoyes = send(session->fd, session->envoi + session->debut_envoi,
+            session->fin_envoi - session->debut_envoi, MSG_NOSIGNAL);
+        if (envoyes < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        session->debut_envoi += envoyes;
+    }
+
+    session->debut_envoi = 0;
+    session->fin_envoi = 0;
+    return true;
+}
+
+/**
+ * \fn bool recevoir_session(t_serveur *serveur, t_session *session)
+ * \brief Lit ce qui est arrivé sur la socket et exécute chaque ligne complète, jusqu'à quit
+ * \param serveur Le serveur
+ * \param session La session
+ * \return Faux si la connexion est fermée ou la ligne trop longue, vrai sinon
+ */
+bool recevoir_session(t_serveur *serveur, t_session *session) {
+    ssize_t recus;
+    char *debut, *fin_ligne;
+
+    recus = recv(session->fd, session->lue + session->longueur_lue,
+        TAILLE_LIGNE_PROTOCOLE - session->longueur_lue, 0);
+    if (recus == 0)
+        return false;
+    if (recus < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    session->longueur_lue += recus;
+
+    // après quit ou une erreur fatale, plus rien n'est exécuté : la session se ferme
+    if (session->fermer_apres_envoi) {
+        session->longueur_lue = 0;
+        return true;
+    }
+
+    // on exécute les lignes complètes, le reste attend la suite
+    debut = session->lue;
+    while (!session->fermer_apres_envoi
+            && (fin_ligne = memchr(debut, '\n', session->lue + session->longueur_lue - debut)) != NULL) {
+        *fin_ligne = '\0';
+        if (fin_ligne > debut && fin_ligne[-1] == '\r')
+            fin_ligne[-1] = '\0';
+        traiter_commande(serveur, session, debut);
+        debut = fin_ligne + 1;
+    }
+
+    session->longueur_lue -= debut - session->lue;
+    memmove(session->lue, debut, session->longueur_lue);
+
+    if (session->longueur_lue == TAILLE_LIGNE_PROTOCOLE) {
+        repondre_session(session, "err line");
+        session->fermer_apres_envoi = true;
+        session->longueur_lue = 0;
+    }
+
+    return true;
+}
+
+/**
+ * \fn void accepter_clients(t_serveur *serveur)
+ * \brief Accepte toutes les connexions en attente, chacune dans un emplacement libre
+ * \param serveur Le serveur
+ */
+void accepter_clients(t_serveur *serveur) {
+    const int UN = 1;
+    struct epoll_event evenement;
+    t_session *session;
+    int fd, indice;
+
+    while ((fd = accept4(serveur->ecoute, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        // sans emplacement libre, le client est prévenu puis déconnecté
+        if (serveur->nb_libres == 0) {
+            send(fd, "err full\n", 9, MSG_NOSIGNAL);
+            close(fd);
+            continue;
+        }
+
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &UN, sizeof(UN));
+
+        indice = serveur->libres[--serveur->nb_libres];
+        session = &serveur->sessions[indice];
+        session->fd = fd;
+        session->en_partie = false;
+        session->attente_envoi = false;
+        session->fermer_apres_envoi = false;
+        session->longueur_lue = 0;
+        session->debut_envoi = 0;
+        session->fin_envoi = 0;
+
+        evenement.events = EPOLLIN;
+        evenement.data.u32 = indice;
+        epoll_ctl(serveur->epoll, EPOLL_CTL_ADD, fd, &evenement);
+        serveur->nb_connexions++;
+    }
+}
+
+/**
+ * \fn int ouvrir_ecoute(const struct sockaddr_storage *adresse, socklen_t taille)
+ * \brief Crée la socket d'écoute non bloquante du serveur
+ * \param adresse L'adresse d'écoute
+ * \param taille La taille de l'adresse
+ * \return La socket, ou -1 en cas d'erreur
+ */
+int ouvrir_ecoute(const struct sockaddr_storage *adresse, socklen_t taille) {
+    const int UN = 1;
+    int fd;
+
+    fd = socket(adresse->ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    // une socket Unix laissée par un serveur précédent empêcherait bind
+    if (adresse->ss_family == AF_UNIX)
+        unlink(((const struct sockaddr_un *)adresse)->sun_path);
+    else
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &UN, sizeof(UN));
+
+    if (bind(fd, (const struct sockaddr *)adresse, taille) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * \fn bool mode_serveur(const t_options *options)
+ * \brief Sert des parties indépendantes sur une socket, toutes menées par une seule boucle epoll
+ * \param options Les options de la ligne de commande
+ * \return Vrai si le serveur s'est arrêté normalement, faux s'il n'a pas pu démarrer
+ */
+bool mode_serveur(const t_options *options) {
+    struct epoll_event evenements[NB_EVENEMENTS_EPOLL];
+    struct epoll_event evenement;
+    struct sockaddr_storage adresse;
+    struct sigaction action;
+    socklen_t taille;
+    t_serveur serveur;
+    t_session *session;
+    int nb_evenements, journal;
+    uint32_t indice;
+    bool ouverte, correct = true;
+
+    if (!lire_adresse(options->adresse, &adresse, &taille)) {
+        fprintf(stderr, "Adresse incorrecte : %s\n", options->adresse);
+        return false;
+    }
+
+    serveur.journal = NULL;
+    if (options->fichier_journal != NULL) {
+        journal = ouvrir_ecriture_journal(options->fichier_journal);
+        if (journal < 0)
+            return false;
+        serveur.journal = malloc(sizeof(t_journal));
+        initialiser_journal(serveur.journal, journal);
+    }
+
+    serveur.ecoute = ouvrir_ecoute(&adresse, taille);
+    if (serveur.ecoute < 0) {
+        fprintf(stderr, "Impossible d'écouter sur %s : %s\n", options->adresse, strerror(errno));
+        if (serveur.journal != NULL) {
+            close(serveur.journal->descripteur);
+            free(serveur.journal);
+        }
+        return false;
+    }
+
+    // tous les emplacements sont alloués une fois pour toutes
+    serveur.nb_sessions = options->nb_sessions;
+    serveur.sessions = malloc(serveur.nb_sessions * sizeof(t_session));
+    serveur.libres = malloc(serveur.nb_sessions * sizeof(int));
+    for (int i = 0; i < serveur.nb_sessions; i++) {
+        serveur.sessions[i].fd = -1;
+        serveur.libres[i] = serveur.nb_sessions - 1 - i;
+    }
+    serveur.nb_libres = serveur.nb_sessions;
+    serveur.nb_connexions = 0;
+    serveur.nb_commandes = 0;
+    initialiser_alea(&serveur.alea, options->graine);
+
+    serveur.epoll = epoll_create1(EPOLL_CLOEXEC);
+    evenement.events = EPOLLIN;
+    evenement.data.u32 = ECOUTE_EPOLL;
+    epoll_ctl(serveur.epoll, EPOLL_CTL_ADD, serveur.ecoute, &evenement);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = demander_arret;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    printf("Serveur à l'écoute sur %s, %d sessions au plus\n", options->adresse, serveur.nb_sessions);
+    fflush(stdout);
+
+    while (!arret_demande) {
+        nb_evenements = epoll_wait(serveur.epoll, evenements, NB_EVENEMENTS_EPOLL, -1);
+
+        for (int i = 0; i < nb_evenements; i++) {
+            indice = evenements[i].data.u32;
+            if (indice == ECOUTE_EPOLL) {
+                accepter_clients(&serveur);
+                continue;
+            }
+
+            session = &serveur.sessions[indice];
+            ouverte = (evenements[i].events & (EPOLLERR | EPOLLHUP)) == 0;
+            if (ouverte && (evenements[i].events & EPOLLIN))
+                ouverte = recevoir_session(&serveur, session);
+            if (ouverte)
+                ouverte = envoyer_session(session);
+            if (ouverte && session->fermer_apres_envoi && session->fin_envoi == 0)
+                ouverte = false;
+
+            if (ouverte)
+                surveiller_session(&serveur, indice);
+            else
+                fermer_session(&serveur, indice);
+        }
+    }
+
+    printf("Serveur arrêté : %ld connexions, %ld commandes\n", serveur.nb_connexions, serveur.nb_commandes);
+
+    for (int i = 0; i < serveur.nb_sessions; i++) {
+        if (serveur.sessions[i].fd >= 0)
+            close(serveur.sessions[i].fd);
+    }
+    close(serveur.epoll);
+    close(serveur.ecoute);
+    if (adresse.ss_family == AF_UNIX)
+        unlink(((struct sockaddr_un *)&adresse)->sun_path);
+    free(serveur.sessions);
+    free(serveur.libres);
+
+    if (serveur.journal != NULL) {
+        correct = vider_journal(serveur.journal);
+        if (!correct)
+            fprintf(stderr, "Erreur d'écriture de %s, des parties manquent\n", options->fichier_journal);
+        close(serveur.journal->descripteur);
+        free(serveur.journal);
+    }
+
+    return correct;
+}
+
+/**
+ * \def TAILLE_LECTURE_PROTOCOLE
+ * \brief Taille des lectures de l'entrée standard en mode --stdio, qui contiennent souvent des centaines de commandes
+ */
+#define TAILLE_LECTURE_PROTOCOLE 65536
+
+/**
+ * \fn bool ecrire_reponses(t_session *session)
+ * \brief Ecrit sur la sortie standard les réponses en attente d'une session
+ * \param session La session
+ * \return Vrai si tout est écrit, faux si la sortie est fermée
+ */
+bool ecrire_reponses(t_session *session) {
+    ssize_t ecrits;
+
+    while (session->debut_envoi < session->fin_envoi) {
+        ecrits = write(STDOUT_FILENO, session->envoi + session->debut_envoi, session->fin_envoi - session->debut_envoi);
+        if (ecrits < 0 && errno == EINTR)
+            continue;
+        if (ecrits <= 0)
+            return false;
+        session->debut_envoi += ecrits;
+    }
+
+    session->debut_envoi = 0;
+    session->fin_envoi = 0;
+    return true;
+}
+
+/**
+ * \fn bool mode_protocole(const t_options *options)
+ * \brief Sert les parties du protocole du serveur sur l'entrée et la sortie standard, pour un programme lancé avec des tubes
+ *
+ * Les commandes et les réponses sont celles d'une session du serveur. Un
+ * programme peut envoyer plusieurs commandes sans attendre leurs réponses :
+ * toutes les lignes d'une lecture sont traitées, puis leurs réponses sont
+ * écrites ensemble.
+ * \param options Les options de la ligne de commande
+ * \return Vrai si l'entrée a été lue jusqu'au bout ou jusqu'à quit, faux sinon
+ */
+bool mode_protocole(const t_options *options) {
+    // une commande répond au plus deux lignes : scored puis end
+    const int SEUIL_ENVOI = TAILLE_ENVOI_SESSION - 2 * TAILLE_LIGNE_PROTOCOLE;
+    char *lus = malloc(TAILLE_LECTURE_PROTOCOLE);
+    char *debut, *fin_ligne;
+    t_serveur serveur;
+    t_session *session = calloc(1, sizeof(t_session));
+    size_t longueur = 0;
+    ssize_t recus;
+    int journal;
+    bool correct = true;
+
+    memset(&serveur, 0, sizeof(serveur));
+    initialiser_alea(&serveur.alea, options->graine);
+    if (options->fichier_journal != NULL) {
+        journal = ouvrir_ecriture_journal(options->fichier_journal);
+        if (journal < 0) {
+            free(lus);
+            free(session);
+            return false;
+        }
+        serveur.journal = malloc(sizeof(t_journal));
+        initialiser_journal(serveur.journal, journal);
+    }
+    session->fd = STDIN_FILENO;
+
+    while (correct && !session->fermer_apres_envoi) {
+        recus = read(STDIN_FILENO, lus + longueur, TAILLE_LECTURE_PROTOCOLE - longueur);
+        if (recus < 0 && errno == EINTR)
+            continue;
+        if (recus < 0)
+            correct = false;
+        if (recus <= 0)
+            break;
+        longueur += recus;
+
+        // on exécute les lignes complètes, le reste attend la suite
+        debut = lus;
+        while (!session->fermer_apres_envoi
+                && (fin_ligne = memchr(debut, '\n', lus + longueur - debut)) != NULL) {
+            *fin_ligne = '\0';
+            if (fin_ligne > debut && fin_ligne[-1] == '\r')
+                fin_ligne[-1] = '\0';
+            if (fin_ligne - debut >= TAILLE_LIGNE_PROTOCOLE)
+                repondre_session(session, "err line");
+            else
+                traiter_commande(&serveur, session, debut);
+            debut = fin_ligne + 1;
+
+            if (session->fin_envoi > SEUIL_ENVOI)
+                correct = ecrire_reponses(session);
+        }
+
+        longueur -= debut - lus;
+        memmove(lus, debut, longueur);
+
+        // une ligne qui remplit toute la lecture ne finira jamais
+        if (longueur == TAILLE_LECTURE_PROTOCOLE) {
+            repondre_session(session, "err line");
+            session->fermer_apres_envoi = true;
+        }
+
+        correct = ecrire_reponses(session) && correct;
+    }
+
+    if (serveur.journal != NULL) {
+        if (!vider_journal(serveur.journal)) {
+            fprintf(stderr, "Erreur d'écriture de %s, des parties manquent\n", options->fichier_journal);
+            correct = false;
+        }
+        close(serveur.journal->descripteur);
+        free(serveur.journal);
+    }
+    free(lus);
+    free(session);
+
+    return correct;
+}
+
+/**
+ * \struct t_client_charge
+ * \brief Connexion du générateur de charge, qui joue ses parties contre le serveur
+ */
+typedef struct {
+    int fd;                                     /**< Socket, -1 une fois les parties finies */
+    int parties_restantes;                      /**< Parties encore à jouer */
+    int cases_remplies;                         /**< Cases remplies dans la partie en cours, tous joueurs */
+    double debut_tour;                          /**< Heure d'envoi du roll du tour en cours */
+    t_feuille_compacte feuilles[NB_JOUEURS];    /**< Copie des feuilles de la partie, pour la stratégie */
+    int longueur_lue;                           /**< Octets reçus et pas encore traités */
+    char lue[TAILLE_LIGNE_PROTOCOLE];           /**< Ligne en cours de réception */
+} t_client_charge;
+
+/**
+ * \struct t_charge
+ * \brief Etat et mesures du générateur de charge
+ */
+typedef struct {
+    const t_strategie *strategie;   /**< Stratégie qui joue les parties */
+    t_alea alea;                    /**< Graines des parties et décisions aléatoires */
+    float *latences;                /**< Durée de chaque tour complet, en microsecondes */
+    long nb_tours;                  /**< Nombre de tours mesurés */
+    long nb_parties;                /**< Nombre de parties terminées */
+    long nb_erreurs;                /**< Nombre de réponses err reçues */
+} t_charge;
+
+/**
+ * \fn void envoyer_client(t_client_charge *client, const char format[], ...)
+ * \brief Envoie une ligne de commande au serveur
+ *
+ * Une commande est plus courte que le tampon de la socket, qui est vide
+ * puisque le client attend chaque réponse avant d'envoyer la suivante.
+ * \param client Le client
+ * \param format Le format de la ligne, comme pour printf, sans le retour à la ligne
+ */
+void envoyer_client(t_client_charge *client, const char format[], ...) {
+    char ligne[TAILLE_LIGNE_PROTOCOLE];
+    va_list arguments;
+    int longueur;
+
+    va_start(arguments, format);
+    longueur = vsnprintf(ligne, sizeof(ligne) - 1, format, arguments);
+    va_end(arguments);
+    ligne[longueur++] = '\n';
+
+    send(client->fd, ligne, longueur, MSG_NOSIGNAL);
+}
+
+/**
+ * \fn bool traiter_reponse(t_charge *charge, t_client_charge *client, const char ligne[])
+ * \brief Joue le coup suivant à partir d'une réponse du serveur
+ * \param charge Le générateur de charge
+ * \param client Le client qui a reçu la réponse
+ * \param ligne La réponse, sans le retour à la ligne
+ * \return Faux si le client a fini ses parties ou reçu une erreur, vrai sinon
+ */
+bool traiter_reponse(t_charge *charge, t_client_charge *client, const char ligne[]) {
+    int joueur, lancer, indice, points, total, garde;
+    t_des des;
+
+    if (strcmp(ligne, "ok") == 0) {
+        for (int j = 0; j < NB_JOUEURS; j++)
+            initialiser_feuille_compacte(&client->feuilles[j]);
+        client->cases_remplies = 0;
+        client->debut_tour = horloge();
+        envoyer_client(client, "roll");
+    }
+    else if (sscanf(ligne, "dice %d %d %d %d %d %d %d", &joueur, &lancer,
+            &des[0], &des[1], &des[2], &des[3], &des[4]) == 7) {
+        const t_feuille_compacte *feuille = &client->feuilles[joueur - 1];
+
+        garde = GARDER_TOUT;
+        if (lancer < NB_LANCERS)
+            garde = charge->strategie->choisir_garde(charge->strategie, feuille, NULL, des, NB_LANCERS - lancer, &charge->alea);
+
+        if ((garde & GARDER_TOUT) != GARDER_TOUT)
+            envoyer_client(client, "keep %d", garde & GARDER_TOUT);
+        else
+            envoyer_client(client, "score %d", charge->strategie->choisir_case(charge->strategie, feuille, NULL, des, &charge->alea));
+    }
+    else if (sscanf(ligne, "scored %d %d %d %d", &joueur, &indice, &points, &total) == 4) {
+        ecrire_case(&client->feuilles[joueur - 1], indice, points);
+        charge->latences[charge->nb_tours++] = (horloge() - client->debut_tour) * 1e6;
+
+        client->cases_remplies++;
+        if (client->cases_remplies < NB_JOUEURS * TAILLE_FEUILLE) {
+            client->debut_tour = horloge();
+            envoyer_client(client, "roll");
+        }
+    }
+    else if (strncmp(ligne, "end ", 4) == 0) {
+        charge->nb_parties++;
+        if (--client->parties_restantes == 0)
+            return false;
+        envoyer_client(client, "join %llu", (unsigned long long)alea_suivant(&charge->alea));
+    }
+    else {
+        fprintf(stderr, "Réponse inattendue : %s\n", ligne);
+        charge->nb_erreurs++;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \fn int comparer_latences(const void *a, const void *b)
+ * \brief Compare deux latences pour qsort
+ * \param a La première latence
+ * \param b La seconde latence
+ * \return Négatif, nul ou positif selon l'ordre des latences
+ */
+int comparer_latences(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * \fn bool mode_charge(const t_options *options)
+ * \brief Joue des parties contre un serveur depuis de nombreuses connexions, et mesure débit et latence
+ *
+ * Les connexions sont ouvertes l'une après l'autre pour mesurer le débit de
+ * connexion, puis toutes les parties avancent ensemble dans une boucle epoll.
+ * \param options Les options de la ligne de commande
+ * \return Vrai si toutes les parties ont été jouées, faux sinon
+ */
+bool mode_charge(const t_options *options) {
+    struct epoll_event evenements[NB_EVENEMENTS_EPOLL];
+    struct epoll_event evenement;
+    struct sockaddr_storage adresse;
+    socklen_t taille;
+    t_client_charge *clients, *client;
+    t_charge charge;
+    int epoll, nb_evenements, nb_actifs;
+    double debut, duree_connexion, duree;
+    char *debut_ligne, *fin_ligne;
+    ssize_t recus;
+    bool actif;
+    const int UN = 1;
+
+    if (!lire_adresse(options->adresse, &adresse, &taille)) {
+        fprintf(stderr, "Adresse incorrecte : %s\n", options->adresse);
+        return false;
+    }
+    if (options->strategies[0]->choisir_garde == optimal_garde || options->strategies[0]->choisir_garde == win_garde) {
+        fprintf(stderr, "Le générateur de charge ne prend pas les stratégies à table (optimal, win)\n");
+        return false;
+    }
+
+    charge.strategie = options->strategies[0];
+    initialiser_alea(&charge.alea, options->graine);
+    charge.latences = malloc((long)options->nb_clients * options->nb_parties * NB_JOUEURS * TAILLE_FEUILLE * sizeof(float));
+    charge.nb_tours = 0;
+    charge.nb_parties = 0;
+    charge.nb_erreurs = 0;
+
+    clients = malloc(options->nb_clients * sizeof(t_client_charge));
+    epoll = epoll_create1(EPOLL_CLOEXEC);
+
+    // Etape 1 : ouverture des connexions
+    debut = horloge();
+    nb_actifs = 0;
+    for (int i = 0; i < options->nb_clients; i++) {
+        client = &clients[i];
+        client->fd = socket(adresse.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (client->fd < 0 || connect(client->fd, (struct sockaddr *)&adresse, taille) != 0) {
+            fprintf(stderr, "Connexion %d impossible : %s\n", i + 1, strerror(errno));
+            if (client->fd >= 0)
+                close(client->fd);
+            client->fd = -1;
+            continue;
+        }
+
+        setsockopt(client->fd, IPPROTO_TCP, TCP_NODELAY, &UN, sizeof(UN));
+        fcntl(client->fd, F_SETFL, O_NONBLOCK);
+        client->parties_restantes = options->nb_parties;
+        client->longueur_lue = 0;
+
+        evenement.events = EPOLLIN;
+        evenement.data.u32 = i;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, client->fd, &evenement);
+        nb_actifs++;
+    }
+    duree_connexion = horloge() - debut;
+
+    // Etape 2 : toutes les parties avancent au rythme des réponses
+    debut = horloge();
+    for (int i = 0; i < options->nb_clients; i++) {
+        if (clients[i].fd >= 0)
+            envoyer_client(&clients[i], "join %llu", (unsigned long long)alea_suivant(&charge.alea));
+    }
+
+    while (nb_actifs > 0) {
+        nb_evenements = epoll_wait(epoll, evenements, NB_EVENEMENTS_EPOLL, -1);
+        if (nb_evenements < 0 && errno != EINTR)
+            break;
+
+        for (int i = 0; i < nb_evenements; i++) {
+            client = &clients[evenements[i].data.u32];
+
+            recus = recv(client->fd, client->lue + client->longueur_lue,
+                TAILLE_LIGNE_PROTOCOLE - client->longueur_lue, 0);
+            actif = recus > 0 || (recus < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+            if (recus > 0)
+                client->longueur_lue += recus;
+
+            debut_ligne = client->lue;
+            while (actif && (fin_ligne = memchr(debut_ligne, '\n', client->lue + client->longueur_lue - debut_ligne)) != NULL) {
+                *fin_ligne = '\0';
+                actif = traiter_reponse(&charge, client, debut_ligne);
+                debut_ligne = fin_ligne + 1;
+            }
+            client->longueur_lue -= debut_ligne - client->lue;
+            memmove(client->lue, debut_ligne, client->longueur_lue);
+
+            if (!actif) {
+                close(client->fd);
+                client->fd = -1;
+                nb_actifs--;
+            }
+        }
+    }
+    duree = horloge() - debut;
+    close(epoll);
+
+    printf("Connexions : %d en %.3f s (%.0f connexions/s)\n", options->nb_clients, duree_connexion,
+        options->nb_clients / duree_connexion);
+    printf("Parties : %ld, tours : %ld en %.3f s (%.0f tours/s)\n", charge.nb_parties, charge.nb_tours, duree,
+        charge.nb_tours / duree);
+    if (charge.nb_tours > 0) {
+        qsort(charge.latences, charge.nb_tours, sizeof(float), comparer_latences);
+        printf("Latence d'un tour : médiane %.1f µs, p99 %.1f µs, max %.1f µs\n",
+            charge.latences[charge.nb_tours / 2], charge.latences[charge.nb_tours * 99 / 100],
+            charge.latences[charge.nb_tours - 1]);
+    }
+    if (charge.nb_erreurs > 0)
+        printf("Erreurs : %ld\n", charge.nb_erreurs);
+
+    free(charge.latences);
+    free(clients);
+
+    return charge.nb_erreurs == 0 && charge.nb_parties == (long)options->nb_clients * options->nb_parties;
+}
+
+/**
+ * \def PAUSE_SPECTATEUR
+ * \brief Attente d'un spectateur qui a tout lu avant de relire l'anneau, en microsecondes
+ */
+#define PAUSE_SPECTATEUR 1000
+
+/**
+ * \fn void afficher_evenement(const t_evenement_partie *evenement)
+ * \brief Affiche un évènement de partie sur une ligne
+ * \param evenement L'évènement
+ */
+void afficher_evenement(const t_evenement_partie *evenement) {
+    combi nom_combinaison;
+
+    printf("Partie %llu", (unsigned long long)evenement->partie);
+    switch (evenement->type) {
+        case DIFFUSION_PARTIE:
+            printf(" : début, %d joueurs\n", evenement->nb_joueurs);
+            break;
+        case DIFFUSION_LANCER:
+            printf(", joueur %d, lancer %d :", evenement->joueur + 1, evenement->lancer);
+            for (int i = 0; i < NB_DES; i++)
+                printf(" %d", evenement->des[i]);
+            printf("\n");
+            break;
+        case DIFFUSION_CASE:
+            indice_vers_combi(evenement->indice, nom_combinaison);
+            printf(", joueur %d : %d points en %s (total %d)\n", evenement->joueur + 1, evenement->points,
+                nom_combinaison, evenement->totaux[evenement->joueur]);
+            break;
+        case DIFFUSION_FIN:
+            printf(" : fin,");
+            for (int j = 0; j < evenement->nb_joueurs; j++)
+                printf("%s %d", j > 0 ? " -" : "", evenement->totaux[j]);
+            printf("\n");
+            break;
+        default:
+            printf(" : évènement inconnu %d\n", evenement->type);
+            break;
+    }
+}
+
+/**
+ * \fn bool mode_spectateur(const t_options *options)
+ * \brief Suit les parties d'un producteur, jusqu'à la fin de la diffusion ou SIGINT
+ *
+ * Le spectateur lit à son rythme : s'il prend trop de retard, il le signale
+ * et reprend aux plus anciens évènements encore dans l'anneau.
+ * \param options Les options de la ligne de commande
+ * \return Vrai si la diffusion a pu être suivie, faux sinon
+ */
+bool mode_spectateur(const t_options *options) {
+    t_evenement_partie evenement;
+    t_lecture_diffusion lecture;
+    struct sigaction action;
+    t_diffusion anneau;
+    uint64_t perdus, nb_lus = 0, nb_perdus = 0;
+
+    if (!ouvrir_spectateur(options->nom_diffusion, &anneau))
+        return false;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = demander_arret;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    printf("Spectateur de %s\n", anneau.nom);
+    while (!arret_demande) {
+        lecture = lire_diffusion(&anneau, &evenement, &perdus);
+        if (perdus > 0) {
+            printf("%llu évènements perdus, le spectateur est en retard\n", (unsigned long long)perdus);
+            nb_perdus += perdus;
+        }
+
+        if (lecture == LECTURE_TERMINEE) {
+            printf("La diffusion est terminée\n");
+            break;
+        }
+        else if (lecture == LECTURE_VIDE) {
+            fflush(stdout);
+            usleep(PAUSE_SPECTATEUR);
+        }
+        else {
+            afficher_evenement(&evenement);
+            nb_lus++;
+        }
+    }
+
+    printf("%llu évènements lus, %llu perdus\n", (unsigned long long)nb_lus, (unsigned long long)nb_perdus);
+    fermer_spectateur(&anneau);
+
+    return true;
+}
+
+/**
+ * \def COLONNE_QUESTIONS
+ * \brief Colonne de l'écran où commencent les messages, les dés et les questions, à droite de la feuille de marque
+ */
+#define COLONNE_QUESTIONS (LARGEUR_FEUILLE + 2)
+
+/**
+ * \fn void dessiner_sortie_machine(t_ecran *ecran, const t_machine_partie *machine, const nom noms[], const t_sortie_machine *sortie)
+ * \brief Compose l'image d'une partie : la feuille du joueur, puis à sa droite le message, les dés et l'invite
+ *
+ * Les dés restent à l'écran tant que le joueur peut les relancer ou choisir
+ * sa case, et le curseur attend la réponse à la fin de l'invite.
+ * \param ecran L'écran
+ * \param machine La partie
+ * \param noms Le nom de chaque joueur
+ * \param sortie La réponse à afficher
+ */
+void dessiner_sortie_machine(t_ecran *ecran, const t_machine_partie *machine, const nom noms[], const t_sortie_machine *sortie) {
+    t_feuille_compacte compacte;
+    t_feuille feuille;
+    t_des des;
+    int ligne;
+
+    effacer_ecran(ecran);
+
+    feuille_table(&machine->table, machine->joueur, &compacte);
+    decompacter_feuille(&compacte, feuille);
+    dessiner_feuille_marque(ecran, 0, 0, noms[machine->joueur], feuille);
+
+    ligne = ecrire_ecran(ecran, 0, COLONNE_QUESTIONS, "%s", sortie->message);
+    if (machine->etat == ATTENTE_RELANCE || machine->etat == ATTENTE_GARDE || machine->etat == ATTENTE_CASE) {
+        des_machine(machine, des);
+        ligne = dessiner_des(ecran, ligne, COLONNE_QUESTIONS, des);
+    }
+
+    ecrire_ecran(ecran, ligne, COLONNE_QUESTIONS, "%s", sortie->invite);
+}
+
+/**
+ * \fn void dessiner_fin_partie(t_ecran *ecran, nom noms[], t_feuille feuilles[], int nb_joueurs, const char message[])
+ * \brief Compose l'image de fin de partie : le dernier message, les feuilles deux par deux, puis les totaux
+ * \param ecran L'écran
+ * \param noms Le nom de chaque joueur
+ * \param feuilles La feuille de marque de chaque joueur
+ * \param nb_joueurs Le nombre de joueurs
+ * \param message Le message de la dernière case remplie
+ */
+void dessiner_fin_partie(t_ecran *ecran, nom noms[], t_feuille feuilles[], int nb_joueurs, const char message[]) {
+    int ligne;
+
+    effacer_ecran(ecran);
+    ligne = ecrire_ecran(ecran, 0, 0, "%s", message);
+
+    for (int j = 0; j < nb_joueurs; j++) {
+        dessiner_feuille_marque(ecran, ligne + j / 2 * (HAUTEUR_FEUILLE + 1), j % 2 * COLONNE_QUESTIONS,
+            noms[j], feuilles[j]);
+    }
+    ligne += (nb_joueurs + 1) / 2 * (HAUTEUR_FEUILLE + 1);
+
+    dessiner_gagnant(ecran, ligne, 0, noms, feuilles, nb_joueurs);
+}
+
+/**
+ * \fn bool partie_interactive(int nb_joueurs, const char fichier_journal[])
+ * \brief Joue une partie au clavier, les joueurs se passant le clavier à tour de rôle
+ * \param nb_joueurs Le nombre de joueurs, au plus MAX_JOUEURS
+ * \param fichier_journal Le journal où ajouter la partie terminée, NULL sans journal
+ * \return Vrai si la partie a pu être ajoutée au journal, ou s'il n'y en a pas
+ */
+bool partie_interactive(int nb_joueurs, const char fichier_journal[]) {
+    t_feuille feuilles[MAX_JOUEURS];
+    nom noms[MAX_JOUEURS];
+    t_feuille_compacte compacte;
+    t_machine_partie machine;
+    t_sortie_machine sortie;
+    t_ecran *ecran;
+    char entree[TAILLE_ENTREE];
+    uint64_t mots[MAX_MOTS_PARTIE];
+    int nb_mots = 0, descripteur;
+    t_journal *journal = NULL;
+    bool pris, correct = true;
+
+    // le journal est ouvert avant de jouer, pour ne pas perdre une partie entière
+    if (fichier_journal != NULL) {
+        descripteur = ouvrir_ecriture_journal(fichier_journal);
+        if (descripteur < 0)
+            return false;
+        journal = malloc(sizeof(t_journal));
+        initialiser_journal(journal, descripteur);
+    }
+
+    for (int j = 0; j < nb_joueurs; j++) {
+        do {
+            recuperer_nom_joueur(j + 1, noms[j]);
+            pris = false;
+            for (int k = 0; k < j; k++)
+                pris = pris || strcmp(noms[j], noms[k]) == 0;
+            if (pris) {
+                printf("Nom de joueur déjà pris\n");
+            }
+        } while(pris);
+    }
+
+    // On initialise le générateur avec l'horloge
+    initialiser_machine(&machine, time(NULL), nb_joueurs, &sortie);
+    mots[nb_mots++] = mot_partie(nb_joueurs);
+
+    // chaque ligne entrée fait avancer la partie jusqu'à la dernière case,
+    // chaque réponse étant une image de l'écran envoyée d'un coup
+    ecran = malloc(sizeof(t_ecran));
+    initialiser_ecran(ecran, STDOUT_FILENO);
+    while (machine.etat != PARTIE_TERMINEE) {
+        dessiner_sortie_machine(ecran, &machine, (const nom *)noms, &sortie);
+        rendre_ecran(ecran, false);
+        lire_clavier(entree);
+        avancer_machine(&machine, entree, &sortie);
+        if (sortie.evenements & (EVENEMENT_NOUVEAU_TOUR | EVENEMENT_FIN_PARTIE))
+            mots[nb_mots++] = machine.mot_tour;
+    }
+
+    for (int j = 0; j < nb_joueurs; j++) {
+        feuille_table(&machine.table, j, &compacte);
+        decompacter_feuille(&compacte, feuilles[j]);
+    }
+    dessiner_fin_partie(ecran, noms, feuilles, nb_joueurs, sortie.message);
+    rendre_ecran(ecran, true);
+    free(ecran);
+
+    if (journal != NULL) {
+        journaliser_partie(journal, mots, nb_mots);
+        correct = vider_journal(journal);
+        if (!correct)
+            fprintf(stderr, "Erreur d'écriture de %s\n", fichier_journal);
+        close(journal->descripteur);
+        free(journal);
+    }
+
+    return correct;
+}
+
+/**
+ * \fn int main(int argc, char *argv[])
+ * \brief Fonction principale
+ * \param argc Le nombre d'arguments
+ * \param argv Les arguments de la ligne de commande
+ * \return EXIT_SUCCESS, ou EXIT_FAILURE si les options sont incorrectes
+ */
+#ifndef YAMS_BIBLIOTHEQUE
+int main(int argc, char *argv[]) {
+    t_options options;
+    int code_retour = EXIT_SUCCESS;
+
+    initialiser_tables();
+    initialiser_transitions();
+
+    if (!lire_options(argc, argv, &options)) {
+        code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_SPECTATEUR) {
+        if (!mode_spectateur(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.fichier_compteurs != NULL && !ouvrir_instantanes(options.fichier_compteurs, options.periode_compteurs)) {
+        code_retour = EXIT_FAILURE;
+    }
+    else if (options.nom_diffusion != NULL && !ouvrir_diffusion(options.nom_diffusion)) {
+        code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_SIMULATION) {
+        if (!mode_simulation(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_SOLVEUR) {
+        if (!mode_solveur(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_BENCHMARK) {
+        if (!mode_benchmark(&options, argv[0]))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_SERVEUR) {
+        if (!mode_serveur(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_PROTOCOLE) {
+        if (!mode_protocole(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_CHARGE) {
+        if (!mode_charge(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_TOURNOI) {
+        if (!mode_tournoi(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_JOURNAL) {
+        if (!mode_lecture_journal(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_VERIFICATION) {
+        if (!mode_verification_journal(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_DISTRIBUTION) {
+        if (!mode_distribution(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_FINALE) {
+        if (!mode_construction_finale(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else if (options.mode == MODE_ANALYSE) {
+        if (!mode_analyse_decisions(&options))
+            code_retour = EXIT_FAILURE;
+    }
+    else {
+        if (!partie_interactive(options.nb_joueurs, options.fichier_journal))
+            code_retour = EXIT_FAILURE;
+    }
+    fermer_diffusion();
+    fermer_instantanes();
 
-    return EXIT_SUCCESS;
+    return code_retour;
 }
+#endif
@@ -0,0 +1,73 @@
+/**
+ * \file yams.h
+ * \brief Interface binaire de la bibliothèque d'entraînement (compilée avec -DYAMS_BIBLIOTHEQUE)
+ * \author Enzo MAROS
+ *
+ * Ce fichier est inclus tel quel par source.c : la bibliothèque et ses
+ * appelants partagent donc la même disposition de t_vue_environnement.
+ * Tout changement incompatible de ce fichier augmente VERSION_ABI, que
+ * l'appelant compare à yams_version_abi() avant d'utiliser l'environnement.
+ */
+
+#ifndef YAMS_H
+#define YAMS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \def VERSION_ABI
+ * \brief Version de l'interface binaire de l'environnement, augmentée à chaque changement incompatible
+ */
+#define VERSION_ABI 1
+
+/**
+ * \struct t_vue_environnement
+ * \brief Tableaux d'un environnement, lisibles par l'appelant sans copie
+ *
+ * Chaque tableau est rangé champ par champ (structure de tableaux) : la
+ * valeur de la partie k est à l'indice k, et le dé i ou la case i de la
+ * partie k à l'indice i * nb_parties + k. Les tableaux sont mis à jour en
+ * place à chaque pas. Un nouveau champ ne peut être ajouté qu'à la fin, et
+ * augmente VERSION_ABI.
+ *
+ * Sur une plateforme 64 bits, la structure fait 80 octets : les deux entiers
+ * aux positions 0 et 4, puis les pointeurs tous les 8 octets à partir de 8.
+ */
+typedef struct {
+    int32_t nb_parties;                 /**< Nombre de parties de l'environnement */
+    int32_t nb_actions;                 /**< Nombre d'actions : 32 gardes (0 à 30, 31 inutilisée) puis 13 cases (32 à 44) */
+    const uint8_t *des;                 /**< Les dés de chaque partie, de 1 à 6, dans l'ordre du lancer (5 tableaux) */
+    const uint8_t *lancers_restants;    /**< Les relances restantes du tour, de 0 à 2 */
+    const int8_t *feuilles;             /**< Les points de chaque case, -1 si elle est vide (13 tableaux) */
+    const uint8_t *totaux_sup;          /**< Le total supérieur, sans le bonus */
+    const int16_t *totaux;              /**< Le total, bonus compris */
+    const uint64_t *masques_actions;    /**< Bit a à 1 si l'action a est permise */
+    const float *recompenses;           /**< Les points marqués au dernier pas, bonus compris */
+    const uint8_t *terminees;           /**< 1 si le dernier pas a fini la partie, aussitôt recommencée */
+    const int16_t *scores_finals;       /**< Le total de la dernière partie finie */
+} t_vue_environnement;
+
+/**
+ * \typedef t_environnement
+ * \brief Lot de parties, opaque pour l'appelant qui le lit par yams_vue_environnement
+ */
+typedef struct s_environnement t_environnement;
+
+int yams_version_abi(void);
+t_environnement *yams_creer_environnement(int nb_parties, int nb_fils, uint64_t graine);
+void yams_detruire_environnement(t_environnement *environnement);
+void yams_vue_environnement(const t_environnement *environnement, t_vue_environnement *vue);
+void yams_reinitialiser(t_environnement *environnement);
+int yams_avancer(t_environnement *environnement, const uint8_t actions[]);
+int yams_avancer_plage(t_environnement *environnement, const uint8_t actions[], int debut, int fin);
+void yams_calculer_points(const uint8_t des[], int nb_mains, uint8_t points[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif